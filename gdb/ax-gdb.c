@@ -45,6 +45,7 @@
 #include "valprint.h"
 #include "c-lang.h"
 #include "expop.h"
+#include "extract-store-integer.h"
 
 #include "gdbsupport/format.h"
 
@@ -2465,6 +2466,423 @@ gen_printf (CORE_ADDR scope, struct gdbarch *gdbarch,
   return ax;
 }
 
+/* The deepest stack an expression evaluated by ax_eval_on_host may
+   need.  Breakpoint conditions rarely need more than a handful of
+   slots.  */
+
+#define AX_HOST_STACK_MAX 64
+
+/* Return the size of the operands that follow OP in the bytecode
+   stream, for the bytecodes that ax_eval_on_host handles.  */
+
+static int
+ax_host_operand_size (enum agent_op op)
+{
+  switch (op)
+    {
+    case aop_ext: case aop_zero_ext: case aop_const8: case aop_pick:
+      return 1;
+    case aop_const16: case aop_if_goto: case aop_goto: case aop_reg:
+      return 2;
+    case aop_const32:
+      return 4;
+    case aop_const64:
+      return 8;
+    default:
+      return 0;
+    }
+}
+
+/* See ax-gdb.h.  */
+
+agent_expr_up
+gen_eval_for_host (CORE_ADDR scope, struct expression *expr)
+{
+  agent_expr_up ax;
+
+  try
+    {
+      ax = gen_eval_for_expr (scope, expr);
+      ax_reqs (ax.get ());
+    }
+  catch (const gdb_exception_error &ex)
+    {
+      return nullptr;
+    }
+
+  if (ax->flaw != agent_flaw_none
+      || ax->min_height < 0
+      || ax->max_height > AX_HOST_STACK_MAX)
+    return nullptr;
+
+  struct gdbarch *gdbarch = ax->gdbarch;
+  gdb::byte_vector &buf = ax->buf;
+  size_t i = 0;
+
+  while (i < buf.size ())
+    {
+      size_t next;
+
+      /* Don't look at operands past the end of the expression.  */
+      if (i + ax_host_operand_size ((enum agent_op) buf[i]) >= buf.size ())
+	return nullptr;
+
+      switch (buf[i])
+	{
+	case aop_add: case aop_sub: case aop_mul:
+	case aop_div_signed: case aop_div_unsigned:
+	case aop_rem_signed: case aop_rem_unsigned:
+	case aop_lsh: case aop_rsh_signed: case aop_rsh_unsigned:
+	case aop_log_not: case aop_bit_and: case aop_bit_or:
+	case aop_bit_xor: case aop_bit_not: case aop_equal:
+	case aop_less_signed: case aop_less_unsigned:
+	case aop_ref8: case aop_ref16: case aop_ref32: case aop_ref64:
+	case aop_end: case aop_dup: case aop_pop: case aop_swap:
+	case aop_rot:
+	  next = i + 1;
+	  break;
+
+	case aop_ext: case aop_zero_ext:
+	  if (buf[i + 1] == 0)
+	    return nullptr;
+	  next = i + 2;
+	  break;
+
+	case aop_const8: case aop_pick:
+	  next = i + 2;
+	  break;
+
+	case aop_const16:
+	  next = i + 3;
+	  break;
+
+	case aop_const32:
+	  next = i + 5;
+	  break;
+
+	case aop_const64:
+	  next = i + 9;
+	  break;
+
+	case aop_if_goto:
+	case aop_goto:
+	  /* Only allow forward jumps, within the expression, so that
+	     evaluation always terminates.  */
+	  {
+	    size_t target = (buf[i + 1] << 8) + buf[i + 2];
+
+	    if (target <= i || target >= buf.size ())
+	      return nullptr;
+	  }
+	  next = i + 3;
+	  break;
+
+	case aop_reg:
+	  {
+	    /* The agent speaks in remote register numbers; translate
+	       them back to GDB's own numbering once, here, rather
+	       than on every evaluation.  */
+	    int remote_regnum = (buf[i + 1] << 8) + buf[i + 2];
+	    int regnum;
+
+	    for (regnum = 0; regnum < gdbarch_num_regs (gdbarch); regnum++)
+	      if (gdbarch_remote_register_number (gdbarch, regnum)
+		  == remote_regnum)
+		break;
+
+	    if (regnum == gdbarch_num_regs (gdbarch)
+		|| register_size (gdbarch, regnum) > sizeof (ULONGEST))
+	      return nullptr;
+
+	    buf[i + 1] = (regnum >> 8) & 0xff;
+	    buf[i + 2] = regnum & 0xff;
+	    next = i + 3;
+	  }
+	  break;
+
+	default:
+	  /* Floating point, trace state variables, tracing and
+	     printf bytecodes only make sense to the target agent.  */
+	  return nullptr;
+	}
+
+      i = next;
+    }
+
+  return ax;
+}
+
+/* Read an unsigned integer of SIZE bytes from BUF at offset PC, in
+   the big-endian order used by the bytecode stream.  */
+
+static ULONGEST
+ax_host_read_operand (const gdb::byte_vector &buf, int pc, int size)
+{
+  ULONGEST val = 0;
+
+  for (int i = 0; i < size; i++)
+    val = (val << 8) + buf[pc + i];
+
+  return val;
+}
+
+/* See ax-gdb.h.  */
+
+bool
+ax_eval_on_host (const struct agent_expr *ax, struct regcache *regcache,
+		 ULONGEST *result)
+{
+  struct gdbarch *gdbarch = ax->gdbarch;
+  enum bfd_endian byte_order = gdbarch_byte_order (gdbarch);
+  const gdb::byte_vector &buf = ax->buf;
+  ULONGEST stack[AX_HOST_STACK_MAX + 1];
+  int sp = 0;
+  int pc = 0;
+  gdb_byte bytes[sizeof (ULONGEST)];
+
+  if (regcache->arch () != gdbarch)
+    return false;
+
+  /* The bytecode was checked by gen_eval_for_host: every opcode is
+     known and the stack never underflows or grows past
+     AX_HOST_STACK_MAX.  Still, don't read past the end of the
+     expression, whatever its jumps say.  Anything that would make the
+     regular evaluator throw an error, or a malformed expression,
+     makes us give up instead, so that the caller can let the regular
+     evaluator deal with it.  */
+  while (true)
+    {
+      if ((size_t) pc >= buf.size ())
+	return false;
+
+      enum agent_op op = (enum agent_op) buf[pc++];
+      if ((size_t) (pc + ax_host_operand_size (op)) > buf.size ())
+	return false;
+
+      switch (op)
+	{
+	case aop_add:
+	  sp--;
+	  stack[sp - 1] += stack[sp];
+	  break;
+
+	case aop_sub:
+	  sp--;
+	  stack[sp - 1] -= stack[sp];
+	  break;
+
+	case aop_mul:
+	  sp--;
+	  stack[sp - 1] *= stack[sp];
+	  break;
+
+	case aop_div_signed:
+	case aop_rem_signed:
+	  {
+	    LONGEST b = stack[--sp];
+	    LONGEST a = stack[sp - 1];
+
+	    if (b == 0
+		|| (b == -1 && a == std::numeric_limits<LONGEST>::min ()))
+	      return false;
+	    stack[sp - 1] = op == aop_div_signed ? a / b : a % b;
+	  }
+	  break;
+
+	case aop_div_unsigned:
+	case aop_rem_unsigned:
+	  {
+	    ULONGEST b = stack[--sp];
+	    ULONGEST a = stack[sp - 1];
+
+	    if (b == 0)
+	      return false;
+	    stack[sp - 1] = op == aop_div_unsigned ? a / b : a % b;
+	  }
+	  break;
+
+	case aop_lsh:
+	case aop_rsh_signed:
+	case aop_rsh_unsigned:
+	  {
+	    ULONGEST count = stack[--sp];
+
+	    if (count >= HOST_CHAR_BIT * sizeof (ULONGEST))
+	      return false;
+	    if (op == aop_lsh)
+	      stack[sp - 1] <<= count;
+	    else if (op == aop_rsh_signed)
+	      stack[sp - 1] = (LONGEST) stack[sp - 1] >> count;
+	    else
+	      stack[sp - 1] >>= count;
+	  }
+	  break;
+
+	case aop_log_not:
+	  stack[sp - 1] = !stack[sp - 1];
+	  break;
+
+	case aop_bit_and:
+	  sp--;
+	  stack[sp - 1] &= stack[sp];
+	  break;
+
+	case aop_bit_or:
+	  sp--;
+	  stack[sp - 1] |= stack[sp];
+	  break;
+
+	case aop_bit_xor:
+	  sp--;
+	  stack[sp - 1] ^= stack[sp];
+	  break;
+
+	case aop_bit_not:
+	  stack[sp - 1] = ~stack[sp - 1];
+	  break;
+
+	case aop_equal:
+	  sp--;
+	  stack[sp - 1] = stack[sp - 1] == stack[sp];
+	  break;
+
+	case aop_less_signed:
+	  sp--;
+	  stack[sp - 1] = (LONGEST) stack[sp - 1] < (LONGEST) stack[sp];
+	  break;
+
+	case aop_less_unsigned:
+	  sp--;
+	  stack[sp - 1] = stack[sp - 1] < stack[sp];
+	  break;
+
+	case aop_ext:
+	case aop_zero_ext:
+	  {
+	    int n = buf[pc++];
+
+	    if (n < HOST_CHAR_BIT * sizeof (ULONGEST))
+	      {
+		ULONGEST mask = ((ULONGEST) 1 << n) - 1;
+
+		stack[sp - 1] &= mask;
+		if (op == aop_ext)
+		  {
+		    ULONGEST sign = (ULONGEST) 1 << (n - 1);
+
+		    stack[sp - 1] = (stack[sp - 1] ^ sign) - sign;
+		  }
+	      }
+	  }
+	  break;
+
+	case aop_ref8:
+	case aop_ref16:
+	case aop_ref32:
+	case aop_ref64:
+	  {
+	    int size = 1 << (op - aop_ref8);
+
+	    if (target_read_memory (stack[sp - 1], bytes, size) != 0)
+	      return false;
+	    stack[sp - 1] = extract_unsigned_integer (bytes, size,
+						      byte_order);
+	  }
+	  break;
+
+	case aop_if_goto:
+	case aop_goto:
+	  {
+	    size_t target = ax_host_read_operand (buf, pc, 2);
+
+	    /* Only forward jumps are valid.  */
+	    if (target < (size_t) pc || target >= buf.size ())
+	      return false;
+	    if (op == aop_goto || stack[--sp] != 0)
+	      pc = target;
+	    else
+	      pc += 2;
+	  }
+	  break;
+
+	case aop_const8:
+	  stack[sp++] = ax_host_read_operand (buf, pc, 1);
+	  pc += 1;
+	  break;
+
+	case aop_const16:
+	  stack[sp++] = ax_host_read_operand (buf, pc, 2);
+	  pc += 2;
+	  break;
+
+	case aop_const32:
+	  stack[sp++] = ax_host_read_operand (buf, pc, 4);
+	  pc += 4;
+	  break;
+
+	case aop_const64:
+	  stack[sp++] = ax_host_read_operand (buf, pc, 8);
+	  pc += 8;
+	  break;
+
+	case aop_reg:
+	  {
+	    int regnum = ax_host_read_operand (buf, pc, 2);
+	    int size = register_size (gdbarch, regnum);
+
+	    pc += 2;
+	    if (regcache->raw_read (regnum, bytes) != REG_VALID)
+	      return false;
+	    stack[sp++] = extract_unsigned_integer (bytes, size, byte_order);
+	  }
+	  break;
+
+	case aop_dup:
+	  stack[sp] = stack[sp - 1];
+	  sp++;
+	  break;
+
+	case aop_pop:
+	  sp--;
+	  break;
+
+	case aop_pick:
+	  {
+	    int depth = buf[pc++];
+
+	    if (depth >= sp)
+	      return false;
+	    stack[sp] = stack[sp - 1 - depth];
+	    sp++;
+	  }
+	  break;
+
+	case aop_swap:
+	  std::swap (stack[sp - 1], stack[sp - 2]);
+	  break;
+
+	case aop_rot:
+	  {
+	    ULONGEST tem = stack[sp - 1];
+
+	    stack[sp - 1] = stack[sp - 2];
+	    stack[sp - 2] = stack[sp - 3];
+	    stack[sp - 3] = tem;
+	  }
+	  break;
+
+	case aop_end:
+	  if (sp == 0)
+	    return false;
+	  *result = stack[sp - 1];
+	  return true;
+
+	default:
+	  return false;
+	}
+    }
+}
+
 static void
 agent_eval_command_one (const char *exp, int eval, CORE_ADDR pc)
 {
@@ -114,6 +114,26 @@ extern agent_expr_up gen_trace_for_return_address (CORE_ADDR,
 
 extern agent_expr_up gen_eval_for_expr (CORE_ADDR, struct expression *);
 
+/* Like gen_eval_for_expr, but return bytecode meant to be evaluated
+   by GDB itself with ax_eval_on_host.  Register references are
+   translated to GDB's register numbers and the bytecode is checked
+   to be safe to interpret without further checks.  Return NULL if
+   EXPR cannot be compiled, or needs bytecodes only the target agent
+   implements (floating point, trace state variables, ...).  */
+
+extern agent_expr_up gen_eval_for_host (CORE_ADDR scope,
+					struct expression *expr);
+
+/* Evaluate AX, as returned by gen_eval_for_host, against the
+   registers in REGCACHE and the current inferior's memory, and store
+   the value left on the stack in *RESULT.  Return false if the
+   evaluation hit something only the regular expression evaluator
+   can handle or report properly, e.g. unreadable memory or a
+   division by zero.  */
+
+extern bool ax_eval_on_host (const struct agent_expr *ax,
+			     struct regcache *regcache, ULONGEST *result);
+
 extern void gen_expr (struct expression *exp, union exp_element **pc,
 		      struct agent_expr *ax, struct axs_value *value);
 
@@ -141,6 +141,7 @@ static bool breakpoint_location_address_range_overlap (struct bp_location *,
 
 static int remove_breakpoint (struct bp_location *);
 static int remove_breakpoint_1 (struct bp_location *, enum remove_bp_reason);
+static int remove_bp_location_batch (std::vector<bp_location *> &);
 
 static enum print_stop_action print_bp_stop_message (bpstat *bs);
 
@@ -263,11 +264,14 @@ breakpoint_location_address_str (const bp_location *bl)
   return str;
 }
 
-static void update_global_location_list (enum ugll_insert_mode);
+static void update_global_location_list (enum ugll_insert_mode,
+					 bool changed_only = false);
 
-static void update_global_location_list_nothrow (enum ugll_insert_mode);
+static void update_global_location_list_nothrow (enum ugll_insert_mode,
+						 bool changed_only = false);
 
-static void insert_breakpoint_locations (void);
+static void insert_breakpoint_locations
+  (gdb::array_view<bp_location *const> locs);
 
 static void trace_pass_command (const char *, int);
 
@@ -576,6 +580,21 @@ show_always_inserted_mode (struct ui_file *file, int from_tty,
 	      value);
 }
 
+/* If true, breakpoint conditions are compiled to agent expression
+   bytecode the first time they are evaluated at a location, and the
+   bytecode is interpreted on later hits instead of evaluating the
+   condition expression.  */
+static bool breakpoint_condition_bytecode = true;
+
+static void
+show_breakpoint_condition_bytecode (struct ui_file *file, int from_tty,
+				    struct cmd_list_element *c,
+				    const char *value)
+{
+  gdb_printf (file, _("Evaluation of breakpoint conditions "
+		      "from bytecode is %s.\n"), value);
+}
+
 /* True if breakpoint debug output is enabled.  */
 static bool debug_breakpoint = false;
 
@@ -727,11 +746,48 @@ all_tracepoints ()
 
 static std::vector<bp_location *> bp_locations;
 
+/* Locations added to, and taken off, breakpoints since the last
+   update_global_location_list call, which applies these changes to
+   BP_LOCATIONS.  Keeping track of them spares that function from
+   rebuilding the whole list from all breakpoints each time.  */
+
+static std::vector<bp_location *> bp_locations_added;
+static std::vector<bp_location *> bp_locations_unlinked;
+
+/* While non-zero, install_breakpoint does not update the global
+   location list when it can avoid it, and sets
+   GLOBAL_LOCATION_LIST_UPDATE_PENDING instead.  See
+   scoped_defer_global_location_list_update.  */
+
+static int defer_global_location_list_update;
+
+/* Whether BP_LOCATIONS is out of date because an update was
+   deferred.  It then misses the locations of new breakpoints.  */
+
+static bool global_location_list_update_pending;
+
+/* Whether an update that may insert locations was deferred.  This
+   stays set when the list is brought up to date without inserting
+   anything, until an update that may insert runs.  */
+
+static bool global_location_list_insert_pending;
+
+/* Bring BP_LOCATIONS up to date if an update was deferred, without
+   inserting anything.  */
+
+static void
+flush_global_location_list_update ()
+{
+  if (global_location_list_update_pending)
+    update_global_location_list_nothrow (UGLL_DONT_INSERT, true);
+}
+
 /* See breakpoint.h.  */
 
 const std::vector<bp_location *> &
 all_bp_locations ()
 {
+  flush_global_location_list_update ();
   return bp_locations;
 }
 
@@ -743,6 +799,8 @@ struct bp_locations_at_addr_range
 
   bp_locations_at_addr_range (CORE_ADDR addr)
   {
+    flush_global_location_list_update ();
+
     struct compare
     {
       bool operator() (const bp_location *loc, CORE_ADDR addr_) const
@@ -870,6 +928,25 @@ scoped_rbreak_breakpoints::~scoped_rbreak_breakpoints ()
   prev_breakpoint_count = rbreak_start_breakpoint_count;
 }
 
+/* See breakpoint.h.  */
+
+scoped_defer_global_location_list_update::
+  scoped_defer_global_location_list_update ()
+{
+  ++defer_global_location_list_update;
+}
+
+/* See breakpoint.h.  */
+
+scoped_defer_global_location_list_update::
+  ~scoped_defer_global_location_list_update ()
+{
+  if (--defer_global_location_list_update == 0
+      && (global_location_list_update_pending
+	  || global_location_list_insert_pending))
+    update_global_location_list_nothrow (UGLL_MAY_INSERT);
+}
+
 /* Used in run_command to zero the hit count when a new run starts.  */
 
 void
@@ -1027,6 +1104,16 @@ show_condition_evaluation_mode (struct ui_file *file, int from_tty,
 		value);
 }
 
+/* Forget the bytecode compiled from LOC's condition, after the
+   condition changed.  */
+
+static void
+clear_location_host_condition (bp_location *loc)
+{
+  loc->cond_host_bytecode.reset ();
+  loc->cond_host_bytecode_valid = false;
+}
+
 /* Parse COND_STRING in the context of LOC and set as the condition
    expression of LOC.  BP_NUM is the number of LOC's owner, LOC_NUM is
    the number of LOC within its owner.  In case of parsing error, mark
@@ -1046,6 +1133,7 @@ set_breakpoint_location_condition (const char *cond_string, bp_location *loc,
       else
 	{
 	  loc->cond = std::move (new_exp);
+	  clear_location_host_condition (loc);
 	  if (loc->disabled_by_cond && loc->enabled)
 	    gdb_printf (_("Breakpoint %d's condition is now valid at "
 			  "location %d, enabling.\n"),
@@ -1102,6 +1190,7 @@ set_breakpoint_condition (struct breakpoint *b, const char *exp,
 	  for (bp_location &loc : b->locations ())
 	    {
 	      loc.cond.reset ();
+	      clear_location_host_condition (&loc);
 	      if (loc.disabled_by_cond && loc.enabled)
 		gdb_printf (_("Breakpoint %d's condition is now valid at "
 			      "location %d, enabling.\n"),
@@ -2818,28 +2907,12 @@ rethrow_on_target_close_error (const gdb_exception &e)
   throw;
 }
 
-/* Insert a low-level "breakpoint" of some type.  BL is the breakpoint
-   location.  Any error messages are printed to TMP_ERROR_STREAM; and
-   DISABLED_BREAKS, and HW_BREAKPOINT_ERROR are used to report problems.
-   Returns 0 for success, 1 if the bp_location type is not supported or
-   -1 for failure.
+/* Fill in the target info of the breakpoint location BL, which is
+   about to be inserted.  */
 
-   NOTE drow/2003-09-09: This routine could be broken down to an
-   object-style method for each breakpoint or catchpoint type.  */
-static int
-insert_bp_location (struct bp_location *bl,
-		    struct ui_file *tmp_error_stream,
-		    int *disabled_breaks,
-		    int *hw_breakpoint_error,
-		    int *hw_bp_error_explained_already)
+static void
+init_bp_location_target_info (struct bp_location *bl)
 {
-  gdb_exception bp_excpt;
-
-  if (!should_be_inserted (bl) || (bl->inserted && !bl->needs_update))
-    return 0;
-
-  breakpoint_debug_printf ("%s", breakpoint_location_address_str (bl).c_str ());
-
   /* Note we don't initialize bl->target_info, as that wipes out
      the breakpoint location's shadow_contents if the breakpoint
      is still inserted at that location.  This in turn breaks
@@ -2865,6 +2938,65 @@ insert_bp_location (struct bp_location *bl,
       /* Reset the modification marker.  */
       bl->needs_update = 0;
     }
+}
+
+/* Return true if the breakpoint location BL, whose target info is
+   filled in, is a plain software breakpoint: one that
+   insert_bp_location and remove_breakpoint_1 would just hand to the
+   target, and that may therefore be inserted or removed along with
+   others by target_insert_breakpoint_batch and
+   target_remove_breakpoint_batch.  */
+
+static bool
+bp_location_batchable_p (const bp_location *bl)
+{
+  if (bl->loc_type != bp_loc_software_breakpoint
+      || bl->probe.prob != nullptr
+      || !bl->target_info.conditions.empty ()
+      || !bl->target_info.tcommands.empty ())
+    return false;
+
+  if (overlay_debugging != ovly_off
+      && bl->section != nullptr
+      && section_is_overlay (bl->section))
+    return false;
+
+  /* Leave insert_bp_location to explain why it can't insert a
+     software breakpoint at a read-only address.  */
+  if (!automatic_hardware_breakpoints)
+    {
+      mem_region *mr = lookup_mem_region (bl->address);
+
+      if (mr != nullptr && mr->attrib.mode != MEM_RW)
+	return false;
+    }
+
+  return true;
+}
+
+/* Insert a low-level "breakpoint" of some type.  BL is the breakpoint
+   location.  Any error messages are printed to TMP_ERROR_STREAM; and
+   DISABLED_BREAKS, and HW_BREAKPOINT_ERROR are used to report problems.
+   Returns 0 for success, 1 if the bp_location type is not supported or
+   -1 for failure.
+
+   NOTE drow/2003-09-09: This routine could be broken down to an
+   object-style method for each breakpoint or catchpoint type.  */
+static int
+insert_bp_location (struct bp_location *bl,
+		    struct ui_file *tmp_error_stream,
+		    int *disabled_breaks,
+		    int *hw_breakpoint_error,
+		    int *hw_bp_error_explained_already)
+{
+  gdb_exception bp_excpt;
+
+  if (!should_be_inserted (bl) || (bl->inserted && !bl->needs_update))
+    return 0;
+
+  breakpoint_debug_printf ("%s", breakpoint_location_address_str (bl).c_str ());
+
+  init_bp_location_target_info (bl);
 
   /* If "set breakpoint auto-hw" is "on" and a software breakpoint was
      set at a read-only address, then a breakpoint location will have
@@ -3189,10 +3321,10 @@ insert_breakpoints (void)
 
 /* This is used when we need to synch breakpoint conditions between GDB and the
    target.  It is the case with deleting and disabling of breakpoints when using
-   always-inserted mode.  */
+   always-inserted mode.  Only the locations in LOCS are looked at.  */
 
 static void
-update_inserted_breakpoint_locations (void)
+update_inserted_breakpoint_locations (gdb::array_view<bp_location *const> locs)
 {
   int error_flag = 0;
   int val = 0;
@@ -3208,7 +3340,7 @@ update_inserted_breakpoint_locations (void)
 
   scoped_restore_current_pspace_and_thread restore_pspace_thread;
 
-  for (bp_location *bl : all_bp_locations ())
+  for (bp_location *bl : locs)
     {
       /* We only want to update software breakpoints and hardware
 	 breakpoints.  */
@@ -3244,10 +3376,77 @@ update_inserted_breakpoint_locations (void)
     }
 }
 
-/* Used when starting or continuing the program.  */
+/* Insert the software breakpoint locations in BATCH, which belong to
+   the current program space and share an architecture, and for which
+   bp_location_batchable_p holds.  The target inserts as many as it can
+   at once; the others go through insert_bp_location, whose arguments
+   and return value are as for this function.  Clears BATCH.  */
+
+static int
+insert_bp_location_batch (std::vector<bp_location *> &batch,
+			  struct ui_file *tmp_error_stream,
+			  int *disabled_breaks,
+			  int *hw_breakpoint_error,
+			  int *hw_bp_error_explained_already)
+{
+  if (batch.empty ())
+    return 0;
+
+  int done = 0;
+
+  try
+    {
+      std::vector<bp_target_info *> bps;
+
+      for (bp_location *bl : batch)
+	{
+	  CORE_ADDR addr = bl->target_info.reqstd_address;
+
+	  /* As code_breakpoint::insert_location.  */
+	  bl->target_info.kind = breakpoint_kind (bl, &addr);
+	  bl->target_info.placed_address = addr;
+	  bps.push_back (&bl->target_info);
+	}
+
+      done = target_insert_breakpoint_batch (batch.front ()->gdbarch, bps);
+    }
+  catch (const gdb_exception_error &e)
+    {
+      rethrow_on_target_close_error (e);
+    }
+
+  int val = 0;
+
+  for (int i = 0; i < batch.size (); i++)
+    {
+      bp_location *bl = batch[i];
+
+      if (i < done)
+	{
+	  breakpoint_debug_printf ("%s",
+				   breakpoint_location_address_str (bl).c_str ());
+	  bl->inserted = 1;
+	}
+      else
+	{
+	  int bl_val = insert_bp_location (bl, tmp_error_stream,
+					   disabled_breaks,
+					   hw_breakpoint_error,
+					   hw_bp_error_explained_already);
+	  if (bl_val)
+	    val = bl_val;
+	}
+    }
+
+  batch.clear ();
+  return val;
+}
+
+/* Used when starting or continuing the program.  Insert the locations
+   in LOCS that should be.  */
 
 static void
-insert_breakpoint_locations (void)
+insert_breakpoint_locations (gdb::array_view<bp_location *const> locs)
 {
   int error_flag = 0;
   int val = 0;
@@ -3263,7 +3462,16 @@ insert_breakpoint_locations (void)
 
   scoped_restore_current_pspace_and_thread restore_pspace_thread;
 
-  for (bp_location *bl : all_bp_locations ())
+  /* The program space switched to for the previous location.  Looking
+     for a thread to switch to is not free, and most of the time all
+     locations belong to the same program space.  */
+  program_space *switched_pspace = nullptr;
+
+  /* Plain software breakpoints not inserted yet, which the target may
+     insert at once.  A library load can bring thousands of them.  */
+  std::vector<bp_location *> batch;
+
+  for (bp_location *bl : locs)
     {
       if (!should_be_inserted (bl) || (bl->inserted && !bl->needs_update))
 	continue;
@@ -3281,7 +3489,19 @@ insert_breakpoint_locations (void)
 	  && !valid_global_inferior_id (bl->owner->inferior))
 	continue;
 
-      switch_to_program_space_and_thread (bl->pspace);
+      if (bl->pspace != switched_pspace
+	  || current_program_space != switched_pspace)
+	{
+	  val = insert_bp_location_batch (batch, &tmp_error_stream,
+					  &disabled_breaks,
+					  &hw_breakpoint_error,
+					  &hw_bp_error_explained_already);
+	  if (val)
+	    error_flag = val;
+
+	  switch_to_program_space_and_thread (bl->pspace);
+	  switched_pspace = bl->pspace;
+	}
 
       /* For targets that support global breakpoints, there's no need
 	 to select an inferior to insert breakpoint to.  In fact, even
@@ -3291,21 +3511,57 @@ insert_breakpoint_locations (void)
 	  && (inferior_ptid == null_ptid || !target_has_execution ()))
 	continue;
 
+      if (!bl->inserted && bl->loc_type == bp_loc_software_breakpoint)
+	{
+	  init_bp_location_target_info (bl);
+
+	  if (bp_location_batchable_p (bl))
+	    {
+	      if (!batch.empty () && batch.front ()->gdbarch != bl->gdbarch)
+		{
+		  val = insert_bp_location_batch (batch, &tmp_error_stream,
+						  &disabled_breaks,
+						  &hw_breakpoint_error,
+						  &hw_bp_error_explained_already);
+		  if (val)
+		    error_flag = val;
+		}
+
+	      batch.push_back (bl);
+	      continue;
+	    }
+	}
+
       val = insert_bp_location (bl, &tmp_error_stream, &disabled_breaks,
 				    &hw_breakpoint_error, &hw_bp_error_explained_already);
       if (val)
 	error_flag = val;
     }
 
+  val = insert_bp_location_batch (batch, &tmp_error_stream, &disabled_breaks,
+				  &hw_breakpoint_error,
+				  &hw_bp_error_explained_already);
+  if (val)
+    error_flag = val;
+
   /* If we failed to insert all locations of a watchpoint, remove
-     them, as half-inserted watchpoint is of limited use.  */
-  for (breakpoint &bpt : all_breakpoints ())
-    {
+     them, as half-inserted watchpoint is of limited use.  Only the
+     watchpoints with locations in LOCS need checking.  */
+  std::vector<breakpoint *> watchpoints;
+  for (bp_location *bl : locs)
+    if (is_hardware_watchpoint (bl->owner))
+      watchpoints.push_back (bl->owner);
+  std::sort (watchpoints.begin (), watchpoints.end (),
+	     [] (const breakpoint *a, const breakpoint *b)
+	       { return a->number < b->number; });
+  watchpoints.erase (std::unique (watchpoints.begin (), watchpoints.end ()),
+		     watchpoints.end ());
+
+  for (breakpoint *w : watchpoints)
+    {
+      breakpoint &bpt = *w;
       bool some_failed = false;
 
-      if (!is_hardware_watchpoint (&bpt))
-	continue;
-
       if (!breakpoint_enabled (&bpt))
 	continue;
 
@@ -3356,9 +3612,28 @@ remove_breakpoints (void)
 {
   int val = 0;
 
+  /* Plain software breakpoints, which the target may remove at
+     once.  */
+  std::vector<bp_location *> batch;
+
   for (bp_location *bl : all_bp_locations ())
     if (bl->inserted && !is_tracepoint (bl->owner))
-      val |= remove_breakpoint (bl);
+      {
+	if (bl->shlib_disabled || !bp_location_batchable_p (bl))
+	  {
+	    val |= remove_breakpoint (bl);
+	    continue;
+	  }
+
+	if (!batch.empty ()
+	    && (batch.front ()->pspace != bl->pspace
+		|| batch.front ()->gdbarch != bl->gdbarch))
+	  val |= remove_bp_location_batch (batch);
+
+	batch.push_back (bl);
+      }
+
+  val |= remove_bp_location_batch (batch);
 
   return val;
 }
@@ -4202,6 +4477,60 @@ remove_breakpoint_1 (struct bp_location *bl, enum remove_bp_reason reason)
   return 0;
 }
 
+/* Remove the inserted software breakpoint locations in BATCH, which
+   belong to the same program space and share an architecture, and for
+   which bp_location_batchable_p holds.  The target removes as many as
+   it can at once; the others go through remove_breakpoint_1.  Clears
+   BATCH.  Returns like remove_breakpoint.  */
+
+static int
+remove_bp_location_batch (std::vector<bp_location *> &batch)
+{
+  if (batch.empty ())
+    return 0;
+
+  scoped_restore_current_pspace_and_thread restore_pspace_thread;
+
+  switch_to_program_space_and_thread (batch.front ()->pspace);
+
+  int done = 0;
+
+  try
+    {
+      std::vector<bp_target_info *> bps;
+
+      for (bp_location *bl : batch)
+	bps.push_back (&bl->target_info);
+
+      done = target_remove_breakpoint_batch (batch.front ()->gdbarch, bps,
+					     REMOVE_BREAKPOINT);
+    }
+  catch (const gdb_exception_error &e)
+    {
+      rethrow_on_target_close_error (e);
+    }
+
+  int val = 0;
+
+  for (int i = 0; i < batch.size (); i++)
+    {
+      bp_location *bl = batch[i];
+
+      if (i < done)
+	{
+	  breakpoint_debug_printf ("%s due to %s",
+				   breakpoint_location_address_str (bl).c_str (),
+				   remove_bp_reason_str (REMOVE_BREAKPOINT));
+	  bl->inserted = 0;
+	}
+      else
+	val |= remove_breakpoint_1 (bl, REMOVE_BREAKPOINT);
+    }
+
+  batch.clear ();
+  return val;
+}
+
 static int
 remove_breakpoint (struct bp_location *bl)
 {
@@ -5108,6 +5437,44 @@ breakpoint_cond_eval (expression *exp)
   return value_true (exp->evaluate ());
 }
 
+/* Try to evaluate the condition of location BL, hit by THREAD, by
+   interpreting its compiled bytecode, compiling the condition first
+   if this is the first hit since it was set.  This avoids creating
+   and freeing values for every hit of a frequently hit conditional
+   breakpoint.  On success, store the result in *RESULT and return
+   true.  Return false if the condition has to be evaluated with
+   breakpoint_cond_eval instead.  */
+
+static bool
+breakpoint_cond_eval_bytecode (bp_location *bl, thread_info *thread,
+			       bool *result)
+{
+  if (!breakpoint_condition_bytecode)
+    return false;
+
+  if (!bl->cond_host_bytecode_valid)
+    {
+      bl->cond_host_bytecode = gen_eval_for_host (bl->address,
+						  bl->cond.get ());
+      bl->cond_host_bytecode_valid = true;
+      breakpoint_debug_printf ("condition at %s %s be compiled",
+			       paddress (bl->gdbarch, bl->address),
+			       (bl->cond_host_bytecode != nullptr
+				? "could" : "could not"));
+    }
+
+  if (bl->cond_host_bytecode == nullptr)
+    return false;
+
+  ULONGEST value;
+  if (!ax_eval_on_host (bl->cond_host_bytecode.get (),
+			get_thread_regcache (thread), &value))
+    return false;
+
+  *result = value != 0;
+  return true;
+}
+
 /* Allocate a new bpstat.  Link it to the FIFO list by BS_LINK_POINTER.  */
 
 bpstat::bpstat (struct bp_location *bl, bpstat ***bs_link_pointer)
@@ -5561,7 +5928,7 @@ bpstat_check_breakpoint_conditions (bpstat *bs, thread_info *thread)
 {
   INFRUN_SCOPED_DEBUG_ENTER_EXIT;
 
-  const struct bp_location *bl;
+  struct bp_location *bl;
   struct breakpoint *b;
   /* Assume stop.  */
   bool condition_result = true;
@@ -5670,7 +6037,10 @@ bpstat_check_breakpoint_conditions (bpstat *bs, thread_info *thread)
 	    {
 	      scoped_restore reset_in_cond_eval
 		= make_scoped_restore (&thread->control.in_cond_eval, true);
-	      condition_result = breakpoint_cond_eval (cond);
+	      if (w != nullptr
+		  || !breakpoint_cond_eval_bytecode (bl, thread,
+						     &condition_result))
+		condition_result = breakpoint_cond_eval (cond);
 	    }
 	  catch (const gdb_exception_error &ex)
 	    {
@@ -8168,7 +8538,18 @@ install_breakpoint (int internal, std::unique_ptr<breakpoint> &&arg, int update_
   notify_breakpoint_created (b);
 
   if (update_gll)
-    update_global_location_list (UGLL_MAY_INSERT);
+    {
+      /* Only defer the update if it wouldn't insert anything right
+	 away anyway.  */
+      if (defer_global_location_list_update > 0
+	  && !breakpoints_should_be_inserted_now ())
+	{
+	  global_location_list_update_pending = true;
+	  global_location_list_insert_pending = true;
+	}
+      else
+	update_global_location_list (UGLL_MAY_INSERT, true);
+    }
 
   return b;
 }
@@ -11213,14 +11594,13 @@ bp_location_is_less_than (const bp_location *a, const bp_location *b)
   /* Sort by type in order to make duplicate determination easier.
      See update_global_location_list.  This is kept in sync with
      breakpoint_locations_match.  */
-  if (a->loc_type < b->loc_type)
-    return true;
+  if (a->loc_type != b->loc_type)
+    return a->loc_type < b->loc_type;
 
   /* Likewise, for range-breakpoints, sort by length.  */
   if (a->loc_type == bp_loc_hardware_breakpoint
-      && b->loc_type == bp_loc_hardware_breakpoint
-      && a->length < b->length)
-    return true;
+      && a->length != b->length)
+    return a->length < b->length;
 
   /* Make the internal GDB representation stable across GDB runs
      where A and B memory inside GDB can differ.  Breakpoint locations of
@@ -11232,17 +11612,136 @@ bp_location_is_less_than (const bp_location *a, const bp_location *b)
   return a < b;
 }
 
-/* Set bp_locations_placed_address_before_address_max and
-   bp_locations_shadow_len_after_address_max according to the current
-   content of the bp_locations array.  */
+/* Return the range of BP_LOCATIONS holding the locations at ADDR.  */
+
+static std::pair<std::vector<bp_location *>::iterator,
+		 std::vector<bp_location *>::iterator>
+bp_locations_range_at (CORE_ADDR addr)
+{
+  auto first
+    = std::lower_bound (bp_locations.begin (), bp_locations.end (), addr,
+			[] (const bp_location *loc, CORE_ADDR addr_)
+			  { return loc->address < addr_; });
+  auto last
+    = std::upper_bound (first, bp_locations.end (), addr,
+			[] (CORE_ADDR addr_, const bp_location *loc)
+			  { return addr_ < loc->address; });
+
+  return { first, last };
+}
+
+/* Above this many locations added or removed at once, merging them
+   with BP_LOCATIONS in one pass is cheaper than moving its tail around
+   for each of them.  */
+
+#define BP_LOCATIONS_MERGE_THRESHOLD 16
+
+/* Apply the changes recorded in BP_LOCATIONS_ADDED and
+   BP_LOCATIONS_UNLINKED to BP_LOCATIONS, keeping it sorted.  Append
+   the locations put in BP_LOCATIONS to ADDED, and the ones taken out of
+   it to REMOVED; the caller is responsible for the latter.  Locations
+   taken off their breakpoint before ever being put in BP_LOCATIONS are
+   released right away.  */
 
 static void
-bp_locations_target_extensions_update (void)
+apply_bp_location_changes (std::vector<bp_location *> &added,
+			   std::vector<bp_location *> &removed)
 {
-  bp_locations_placed_address_before_address_max = 0;
-  bp_locations_shadow_len_after_address_max = 0;
+  std::vector<bp_location *> new_locations = std::move (bp_locations_added);
+  bp_locations_added.clear ();
+  std::vector<bp_location *> unlinked = std::move (bp_locations_unlinked);
+  bp_locations_unlinked.clear ();
 
-  for (bp_location *bl : all_bp_locations ())
+  for (bp_location *loc : new_locations)
+    {
+      if (loc->unlinked || loc->in_global_list)
+	continue;
+
+      /* See if we need to "upgrade" a software breakpoint to a
+	 hardware breakpoint.  Do this before deciding whether
+	 locations are duplicates.  Also do this before sorting because
+	 sorting order depends on location type.  */
+      if (!loc->inserted && should_be_inserted (loc))
+	handle_automatic_hardware_breakpoints (loc);
+
+      loc->in_global_list = true;
+      added.push_back (loc);
+    }
+
+  if (added.size () > BP_LOCATIONS_MERGE_THRESHOLD)
+    {
+      std::sort (added.begin (), added.end (), bp_location_is_less_than);
+
+      size_t old_size = bp_locations.size ();
+      bp_locations.insert (bp_locations.end (), added.begin (), added.end ());
+      std::inplace_merge (bp_locations.begin (),
+			  bp_locations.begin () + old_size,
+			  bp_locations.end (), bp_location_is_less_than);
+    }
+  else
+    for (bp_location *loc : added)
+      {
+	auto range = bp_locations_range_at (loc->address);
+	bp_locations.insert (std::upper_bound (range.first, range.second,
+					       loc, bp_location_is_less_than),
+			     loc);
+      }
+
+  for (bp_location *loc : unlinked)
+    {
+      if (loc->in_global_list)
+	{
+	  loc->in_global_list = false;
+	  removed.push_back (loc);
+	}
+      else
+	{
+	  loc->owner = NULL;
+	  decref_bp_location (&loc);
+	}
+    }
+
+  if (removed.size () > BP_LOCATIONS_MERGE_THRESHOLD)
+    bp_locations.erase (std::remove_if (bp_locations.begin (),
+					bp_locations.end (),
+					[] (const bp_location *loc)
+					  { return !loc->in_global_list; }),
+			bp_locations.end ());
+  else
+    for (bp_location *loc : removed)
+      {
+	/* The sort keys other than the address can change between two
+	   updates, so look for LOC among all the locations at its
+	   address.  */
+	auto range = bp_locations_range_at (loc->address);
+	auto it = std::find (range.first, range.second, loc);
+
+	gdb_assert (it != range.second);
+	bp_locations.erase (it);
+      }
+}
+
+/* Whether a change to LOC can be applied to the global location list by
+   only looking at the locations at LOC's address.  Watchpoints,
+   tracepoints and the like need the full update.  */
+
+static bool
+bp_location_change_is_local (const bp_location *loc)
+{
+  return ((loc->loc_type == bp_loc_software_breakpoint
+	   || loc->loc_type == bp_loc_hardware_breakpoint)
+	  && !is_tracepoint (loc->owner));
+}
+
+/* Raise bp_locations_placed_address_before_address_max and
+   bp_locations_shadow_len_after_address_max as needed to cover the
+   locations in LOCS.  */
+
+static void
+bp_locations_target_extensions_extend
+  (gdb::array_view<bp_location *const> locs)
+{
+  for (bp_location *bl : locs)
     {
       CORE_ADDR start, end, addr;
 
@@ -11266,6 +11765,19 @@ bp_locations_target_extensions_update (void)
     }
 }
 
+/* Set bp_locations_placed_address_before_address_max and
+   bp_locations_shadow_len_after_address_max according to the current
+   content of the bp_locations array.  */
+
+static void
+bp_locations_target_extensions_update (void)
+{
+  bp_locations_placed_address_before_address_max = 0;
+  bp_locations_shadow_len_after_address_max = 0;
+
+  bp_locations_target_extensions_extend (bp_locations);
+}
+
 /* Download tracepoint locations if they haven't been.  */
 
 static void
@@ -11389,291 +11901,239 @@ force_breakpoint_reinsertion (struct bp_location *bl)
     }
 }
 
-/* Called whether new breakpoints are created, or existing breakpoints
-   deleted, to update the global location list and recompute which
-   locations are duplicate of which.
-
-   The INSERT_MODE flag determines whether locations may not, may, or
-   shall be inserted now.  See 'enum ugll_insert_mode' for more
-   info.  */
+/* Handle OLD_LOC, a location that was in BP_LOCATIONS before the update
+   in progress.  FOUND_OBJECT tells whether it still is.  If not, OLD_LOC
+   is removed from the target if need be, and released.  LAST_ADDR and
+   LAST_PSPACE_NUM record the last location address and program space
+   marked for a condition update, across calls.  */
 
 static void
-update_global_location_list (enum ugll_insert_mode insert_mode)
+update_old_bp_location (bp_location *old_loc, bool found_object,
+			CORE_ADDR &last_addr, int &last_pspace_num)
 {
-  /* Last breakpoint location address that was marked for update.  */
-  CORE_ADDR last_addr = 0;
-  /* Last breakpoint location program space that was marked for update.  */
-  int last_pspace_num = -1;
+  /* Tells if the location should remain inserted in the target.  */
+  bool keep_in_target = false;
+  bool removed = false;
 
-  breakpoint_debug_printf ("insert_mode = %s",
-			   ugll_insert_mode_text (insert_mode));
-
-  /* Used in the duplicates detection below.  When iterating over all
-     bp_locations, points to the first bp_location of a given address.
-     Breakpoints and watchpoints of different types are never
-     duplicates of each other.  Keep one pointer for each type of
-     breakpoint/watchpoint, so we only need to loop over all locations
-     once.  */
-  struct bp_location *bp_loc_first;  /* breakpoint */
-  struct bp_location *wp_loc_first;  /* hardware watchpoint */
-  struct bp_location *awp_loc_first; /* access watchpoint */
-  struct bp_location *rwp_loc_first; /* read watchpoint */
+  /* The first location at OLD_LOC's address.  */
+  size_t loc_i = (bp_locations_range_at (old_loc->address).first
+		  - bp_locations.begin ());
 
-  /* Saved former bp_locations array which we compare against the newly
-     built bp_locations from the current state of ALL_BREAKPOINTS.  */
-  std::vector<bp_location *> old_locations = std::move (bp_locations);
-  bp_locations.clear ();
-
-  for (breakpoint &b : all_breakpoints ())
-    for (bp_location &loc : b.locations ())
-      bp_locations.push_back (&loc);
-
-  /* See if we need to "upgrade" a software breakpoint to a hardware
-     breakpoint.  Do this before deciding whether locations are
-     duplicates.  Also do this before sorting because sorting order
-     depends on location type.  */
-  for (bp_location *loc : bp_locations)
-    if (!loc->inserted && should_be_inserted (loc))
-	handle_automatic_hardware_breakpoints (loc);
-
-  std::sort (bp_locations.begin (), bp_locations.end (),
-	     bp_location_is_less_than);
-
-  bp_locations_target_extensions_update ();
-
-  /* Identify bp_location instances that are no longer present in the
-     new list, and therefore should be freed.  Note that it's not
-     necessary that those locations should be removed from inferior --
-     if there's another location at the same address (previously
-     marked as duplicate), we don't need to remove/insert the
-     location.
-     
-     LOCP is kept in sync with OLD_LOCP, each pointing to the current
-     and former bp_location array state respectively.  */
-
-  size_t loc_i = 0;
-  for (bp_location *old_loc : old_locations)
-    {
-      /* Tells if 'old_loc' is found among the new locations.  If
-	 not, we have to free it.  */
-      bool found_object = false;
-      /* Tells if the location should remain inserted in the target.  */
-      bool keep_in_target = false;
-      bool removed = false;
-
-      /* Skip LOCP entries which will definitely never be needed.
-	 Stop either at or being the one matching OLD_LOC.  */
-      while (loc_i < bp_locations.size ()
-	     && bp_locations[loc_i]->address < old_loc->address)
-	loc_i++;
-
-      for (size_t loc2_i = loc_i;
-	   (loc2_i < bp_locations.size ()
-	    && bp_locations[loc2_i]->address == old_loc->address);
-	   loc2_i++)
-	{
-	  /* Check if this is a new/duplicated location or a duplicated
-	     location that had its condition modified.  If so, we want to send
-	     its condition to the target if evaluation of conditions is taking
-	     place there.  */
-	  if (bp_locations[loc2_i]->condition_changed == condition_modified
-	      && (last_addr != old_loc->address
-		  || last_pspace_num != old_loc->pspace->num))
-	    {
-	      force_breakpoint_reinsertion (bp_locations[loc2_i]);
-	      last_pspace_num = old_loc->pspace->num;
-	    }
-
-	  if (bp_locations[loc2_i] == old_loc)
-	    found_object = true;
+  for (size_t loc2_i = loc_i;
+       (loc2_i < bp_locations.size ()
+	&& bp_locations[loc2_i]->address == old_loc->address);
+       loc2_i++)
+    {
+      /* Check if this is a new/duplicated location or a duplicated
+	 location that had its condition modified.  If so, we want to send
+	 its condition to the target if evaluation of conditions is taking
+	 place there.  */
+      if (bp_locations[loc2_i]->condition_changed == condition_modified
+	  && (last_addr != old_loc->address
+	      || last_pspace_num != old_loc->pspace->num))
+	{
+	  force_breakpoint_reinsertion (bp_locations[loc2_i]);
+	  last_pspace_num = old_loc->pspace->num;
 	}
+    }
+
+  /* We have already handled this address, update it so that we don't
+     have to go through updates again.  */
+  last_addr = old_loc->address;
 
-      /* We have already handled this address, update it so that we don't
-	 have to go through updates again.  */
-      last_addr = old_loc->address;
+  /* Target-side condition evaluation: Handle deleted locations.  */
+  if (!found_object)
+    force_breakpoint_reinsertion (old_loc);
 
-      /* Target-side condition evaluation: Handle deleted locations.  */
-      if (!found_object)
-	force_breakpoint_reinsertion (old_loc);
+  /* If this location is no longer present, and inserted, look if
+     there's maybe a new location at the same address.  If so,
+     mark that one inserted, and don't remove this one.  This is
+     needed so that we don't have a time window where a breakpoint
+     at certain location is not inserted.  */
 
-      /* If this location is no longer present, and inserted, look if
-	 there's maybe a new location at the same address.  If so,
-	 mark that one inserted, and don't remove this one.  This is
-	 needed so that we don't have a time window where a breakpoint
-	 at certain location is not inserted.  */
+  if (old_loc->inserted)
+    {
+      /* If the location is inserted now, we might have to remove
+	 it.  */
 
-      if (old_loc->inserted)
+      if (found_object && should_be_inserted (old_loc))
 	{
-	  /* If the location is inserted now, we might have to remove
-	     it.  */
+	  /* The location is still present in the location list,
+	     and still should be inserted.  Don't do anything.  */
+	  keep_in_target = true;
+	}
+      else
+	{
+	  /* This location still exists, but it won't be kept in the
+	     target since it may have been disabled.  We proceed to
+	     remove its target-side condition.  */
 
-	  if (found_object && should_be_inserted (old_loc))
-	    {
-	      /* The location is still present in the location list,
-		 and still should be inserted.  Don't do anything.  */
-	      keep_in_target = true;
-	    }
-	  else
+	  /* The location is either no longer present, or got
+	     disabled.  See if there's another location at the
+	     same address, in which case we don't need to remove
+	     this one from the target.  */
+
+	  /* OLD_LOC comes from existing struct breakpoint.  */
+	  if (bl_address_is_meaningful (old_loc))
 	    {
-	      /* This location still exists, but it won't be kept in the
-		 target since it may have been disabled.  We proceed to
-		 remove its target-side condition.  */
+	      for (size_t loc2_i = loc_i;
+		   (loc2_i < bp_locations.size ()
+		    && bp_locations[loc2_i]->address == old_loc->address);
+		   loc2_i++)
+		{
+		  bp_location *loc2 = bp_locations[loc2_i];
 
-	      /* The location is either no longer present, or got
-		 disabled.  See if there's another location at the
-		 same address, in which case we don't need to remove
-		 this one from the target.  */
+		  if (loc2 == old_loc)
+		    continue;
 
-	      /* OLD_LOC comes from existing struct breakpoint.  */
-	      if (bl_address_is_meaningful (old_loc))
-		{
-		  for (size_t loc2_i = loc_i;
-		       (loc2_i < bp_locations.size ()
-			&& bp_locations[loc2_i]->address == old_loc->address);
-		       loc2_i++)
+		  if (breakpoint_locations_match (loc2, old_loc))
 		    {
-		      bp_location *loc2 = bp_locations[loc2_i];
-
-		      if (loc2 == old_loc)
-			continue;
+		      /* Read watchpoint locations are switched to
+			 access watchpoints, if the former are not
+			 supported, but the latter are.  */
+		      if (is_hardware_watchpoint (old_loc->owner))
+			{
+			  gdb_assert (is_hardware_watchpoint (loc2->owner));
+			  loc2->watchpoint_type = old_loc->watchpoint_type;
+			}
 
-		      if (breakpoint_locations_match (loc2, old_loc))
+		      /* loc2 is a duplicated location. We need to check
+			 if it should be inserted in case it will be
+			 unduplicated.  */
+		      if (unduplicated_should_be_inserted (loc2))
 			{
-			  /* Read watchpoint locations are switched to
-			     access watchpoints, if the former are not
-			     supported, but the latter are.  */
-			  if (is_hardware_watchpoint (old_loc->owner))
-			    {
-			      gdb_assert (is_hardware_watchpoint (loc2->owner));
-			      loc2->watchpoint_type = old_loc->watchpoint_type;
-			    }
-
-			  /* loc2 is a duplicated location. We need to check
-			     if it should be inserted in case it will be
-			     unduplicated.  */
-			  if (unduplicated_should_be_inserted (loc2))
-			    {
-			      swap_insertion (old_loc, loc2);
-			      keep_in_target = true;
-			      break;
-			    }
+			  swap_insertion (old_loc, loc2);
+			  keep_in_target = true;
+			  break;
 			}
 		    }
 		}
 	    }
-
-	  if (!keep_in_target)
-	    {
-	      if (remove_breakpoint (old_loc))
-		{
-		  /* This is just about all we can do.  We could keep
-		     this location on the global list, and try to
-		     remove it next time, but there's no particular
-		     reason why we will succeed next time.
-		     
-		     Note that at this point, old_loc->owner is still
-		     valid, as delete_breakpoint frees the breakpoint
-		     only after calling us.  */
-		  warning (_("error removing breakpoint %d at %s"),
-			   old_loc->owner->number,
-			   paddress (old_loc->gdbarch, old_loc->address));
-		}
-	      removed = true;
-	    }
 	}
 
-      if (!found_object)
+      if (!keep_in_target)
 	{
-	  if (removed && target_is_non_stop_p ()
-	      && need_moribund_for_location_type (old_loc))
+	  if (remove_breakpoint (old_loc))
 	    {
-	      /* This location was removed from the target.  In
-		 non-stop mode, a race condition is possible where
-		 we've removed a breakpoint, but stop events for that
-		 breakpoint are already queued and will arrive later.
-		 We apply an heuristic to be able to distinguish such
-		 SIGTRAPs from other random SIGTRAPs: we keep this
-		 breakpoint location for a bit, and will retire it
-		 after we see some number of events.  The theory here
-		 is that reporting of events should, "on the average",
-		 be fair, so after a while we'll see events from all
-		 threads that have anything of interest, and no longer
-		 need to keep this breakpoint location around.  We
-		 don't hold locations forever so to reduce chances of
-		 mistaking a non-breakpoint SIGTRAP for a breakpoint
-		 SIGTRAP.
-
-		 The heuristic failing can be disastrous on
-		 decr_pc_after_break targets.
-
-		 On decr_pc_after_break targets, like e.g., x86-linux,
-		 if we fail to recognize a late breakpoint SIGTRAP,
-		 because events_till_retirement has reached 0 too
-		 soon, we'll fail to do the PC adjustment, and report
-		 a random SIGTRAP to the user.  When the user resumes
-		 the inferior, it will most likely immediately crash
-		 with SIGILL/SIGBUS/SIGSEGV, or worse, get silently
-		 corrupted, because of being resumed e.g., in the
-		 middle of a multi-byte instruction, or skipped a
-		 one-byte instruction.  This was actually seen happen
-		 on native x86-linux, and should be less rare on
-		 targets that do not support new thread events, like
-		 remote, due to the heuristic depending on
-		 thread_count.
-
-		 Mistaking a random SIGTRAP for a breakpoint trap
-		 causes similar symptoms (PC adjustment applied when
-		 it shouldn't), but then again, playing with SIGTRAPs
-		 behind the debugger's back is asking for trouble.
-
-		 Since hardware watchpoint traps are always
-		 distinguishable from other traps, so we don't need to
-		 apply keep hardware watchpoint moribund locations
-		 around.  We simply always ignore hardware watchpoint
-		 traps we can no longer explain.  */
-
-	      process_stratum_target *proc_target = nullptr;
-	      for (inferior *inf : all_inferiors ())
-		if (inf->pspace == old_loc->pspace)
-		  {
-		    proc_target = inf->process_target ();
-		    break;
-		  }
-	      if (proc_target != nullptr)
-		old_loc->events_till_retirement
-		  = 3 * (thread_count (proc_target) + 1);
-	      else
-		old_loc->events_till_retirement = 1;
-	      old_loc->owner = NULL;
-
-	      moribund_locations.push_back (old_loc);
+	      /* This is just about all we can do.  We could keep
+		 this location on the global list, and try to
+		 remove it next time, but there's no particular
+		 reason why we will succeed next time.
+
+		 Note that at this point, old_loc->owner is still
+		 valid, as delete_breakpoint frees the breakpoint
+		 only after calling us.  */
+	      warning (_("error removing breakpoint %d at %s"),
+		       old_loc->owner->number,
+		       paddress (old_loc->gdbarch, old_loc->address));
 	    }
+	  removed = true;
+	}
+    }
+
+  if (!found_object)
+    {
+      if (removed && target_is_non_stop_p ()
+	  && need_moribund_for_location_type (old_loc))
+	{
+	  /* This location was removed from the target.  In
+	     non-stop mode, a race condition is possible where
+	     we've removed a breakpoint, but stop events for that
+	     breakpoint are already queued and will arrive later.
+	     We apply an heuristic to be able to distinguish such
+	     SIGTRAPs from other random SIGTRAPs: we keep this
+	     breakpoint location for a bit, and will retire it
+	     after we see some number of events.  The theory here
+	     is that reporting of events should, "on the average",
+	     be fair, so after a while we'll see events from all
+	     threads that have anything of interest, and no longer
+	     need to keep this breakpoint location around.  We
+	     don't hold locations forever so to reduce chances of
+	     mistaking a non-breakpoint SIGTRAP for a breakpoint
+	     SIGTRAP.
+
+	     The heuristic failing can be disastrous on
+	     decr_pc_after_break targets.
+
+	     On decr_pc_after_break targets, like e.g., x86-linux,
+	     if we fail to recognize a late breakpoint SIGTRAP,
+	     because events_till_retirement has reached 0 too
+	     soon, we'll fail to do the PC adjustment, and report
+	     a random SIGTRAP to the user.  When the user resumes
+	     the inferior, it will most likely immediately crash
+	     with SIGILL/SIGBUS/SIGSEGV, or worse, get silently
+	     corrupted, because of being resumed e.g., in the
+	     middle of a multi-byte instruction, or skipped a
+	     one-byte instruction.  This was actually seen happen
+	     on native x86-linux, and should be less rare on
+	     targets that do not support new thread events, like
+	     remote, due to the heuristic depending on
+	     thread_count.
+
+	     Mistaking a random SIGTRAP for a breakpoint trap
+	     causes similar symptoms (PC adjustment applied when
+	     it shouldn't), but then again, playing with SIGTRAPs
+	     behind the debugger's back is asking for trouble.
+
+	     Since hardware watchpoint traps are always
+	     distinguishable from other traps, so we don't need to
+	     apply keep hardware watchpoint moribund locations
+	     around.  We simply always ignore hardware watchpoint
+	     traps we can no longer explain.  */
+
+	  process_stratum_target *proc_target = nullptr;
+	  for (inferior *inf : all_inferiors ())
+	    if (inf->pspace == old_loc->pspace)
+	      {
+		proc_target = inf->process_target ();
+		break;
+	      }
+	  if (proc_target != nullptr)
+	    old_loc->events_till_retirement
+	      = 3 * (thread_count (proc_target) + 1);
 	  else
-	    {
-	      old_loc->owner = NULL;
-	      decref_bp_location (&old_loc);
-	    }
+	    old_loc->events_till_retirement = 1;
+	  old_loc->owner = NULL;
+
+	  moribund_locations.push_back (old_loc);
+	}
+      else
+	{
+	  old_loc->owner = NULL;
+	  decref_bp_location (&old_loc);
 	}
     }
+}
 
-  /* Rescan breakpoints at the same address and section, marking the
-     first one as "first" and any others as "duplicates".  This is so
-     that the bpt instruction is only inserted once.  If we have a
-     permanent breakpoint at the same place as BPT, make that one the
-     official one, and the rest as duplicates.  Permanent breakpoints
-     are sorted first for the same address.
+/* Rescan breakpoints at the same address and section, marking the
+   first one as "first" and any others as "duplicates".  This is so
+   that the bpt instruction is only inserted once.  If we have a
+   permanent breakpoint at the same place as BPT, make that one the
+   official one, and the rest as duplicates.  Permanent breakpoints
+   are sorted first for the same address.
 
-     Do the same for hardware watchpoints, but also considering the
-     watchpoint's type (regular/access/read) and length.  */
+   Do the same for hardware watchpoints, but also considering the
+   watchpoint's type (regular/access/read) and length.
 
-  bp_loc_first = NULL;
-  wp_loc_first = NULL;
-  awp_loc_first = NULL;
-  rwp_loc_first = NULL;
+   LOCS is a sorted sequence of locations of BP_LOCATIONS, holding all
+   the locations at each of the addresses it covers.  */
 
-  for (bp_location *loc : all_bp_locations ())
+static void
+mark_duplicate_bp_locations (gdb::array_view<bp_location *const> locs)
+{
+  /* When iterating over LOCS, points to the first bp_location of a
+     given address.  Breakpoints and watchpoints of different types
+     are never duplicates of each other.  Keep one pointer for each
+     type of breakpoint/watchpoint, so we only need to loop over all
+     locations once.  */
+  struct bp_location *bp_loc_first = NULL;  /* breakpoint */
+  struct bp_location *wp_loc_first = NULL;  /* hardware watchpoint */
+  struct bp_location *awp_loc_first = NULL; /* access watchpoint */
+  struct bp_location *rwp_loc_first = NULL; /* read watchpoint */
+
+  for (bp_location *loc : locs)
     {
-      /* ALL_BP_LOCATIONS bp_location has LOC->OWNER always
+      /* LOCS come from BP_LOCATIONS, which has LOC->OWNER always
 	 non-NULL.  */
       struct bp_location **loc_first_p;
       breakpoint *b = loc->owner;
@@ -11726,11 +12186,147 @@ update_global_location_list (enum ugll_insert_mode insert_mode)
       /* Clear the condition modification flag.  */
       loc->condition_changed = condition_unchanged;
     }
+}
+
+/* Called whether new breakpoints are created, or existing breakpoints
+   deleted, to update the global location list and recompute which
+   locations are duplicate of which.
+
+   The INSERT_MODE flag determines whether locations may not, may, or
+   shall be inserted now.  See 'enum ugll_insert_mode' for more
+   info.
+
+   If CHANGED_ONLY is true, only the locations at the addresses of the
+   locations added or removed since the last update are looked at, as
+   long as those are all plain breakpoint locations.  Use this when
+   nothing else changed, e.g., when creating or deleting a
+   breakpoint.  */
+
+static void
+update_global_location_list (enum ugll_insert_mode insert_mode,
+			     bool changed_only)
+{
+  /* Last breakpoint location address that was marked for update.  */
+  CORE_ADDR last_addr = 0;
+  /* Last breakpoint location program space that was marked for update.  */
+  int last_pspace_num = -1;
+
+  breakpoint_debug_printf ("insert_mode = %s",
+			   ugll_insert_mode_text (insert_mode));
+
+  global_location_list_update_pending = false;
+
+  /* The locations put in, and taken out of, BP_LOCATIONS.  */
+  std::vector<bp_location *> added_locations;
+  std::vector<bp_location *> removed_locations;
+  apply_bp_location_changes (added_locations, removed_locations);
+
+  if (changed_only)
+    {
+      for (bp_location *loc : added_locations)
+	if (!bp_location_change_is_local (loc))
+	  changed_only = false;
+      for (bp_location *loc : removed_locations)
+	if (!bp_location_change_is_local (loc))
+	  changed_only = false;
+    }
+
+  /* An update limited to some addresses does not insert the locations
+     of breakpoints whose update was deferred.  */
+  if (insert_mode != UGLL_DONT_INSERT && !changed_only)
+    global_location_list_insert_pending = false;
+
+  /* The locations to look at: either all of them, or those at the
+     addresses of the changed locations.  */
+  std::vector<bp_location *> touched_locations;
+  gdb::array_view<bp_location *const> locs;
+
+  if (changed_only)
+    {
+      std::vector<CORE_ADDR> addresses;
+      for (bp_location *loc : added_locations)
+	addresses.push_back (loc->address);
+      for (bp_location *loc : removed_locations)
+	addresses.push_back (loc->address);
+      std::sort (addresses.begin (), addresses.end ());
+      addresses.erase (std::unique (addresses.begin (), addresses.end ()),
+		       addresses.end ());
+
+      for (CORE_ADDR addr : addresses)
+	{
+	  auto range = bp_locations_range_at (addr);
+
+	  /* The sort keys other than the address can change between
+	     two updates.  */
+	  if (!std::is_sorted (range.first, range.second,
+			       bp_location_is_less_than))
+	    std::sort (range.first, range.second, bp_location_is_less_than);
+
+	  touched_locations.insert (touched_locations.end (),
+				    range.first, range.second);
+	}
+
+      locs = touched_locations;
+    }
+  else
+    {
+      /* See if we need to "upgrade" a software breakpoint to a
+	 hardware breakpoint, as for the added locations in
+	 apply_bp_location_changes.  */
+      bool type_changed = false;
+      for (bp_location *loc : bp_locations)
+	if (!loc->inserted && should_be_inserted (loc))
+	  {
+	    enum bp_loc_type type = loc->loc_type;
+
+	    handle_automatic_hardware_breakpoints (loc);
+	    if (loc->loc_type != type)
+	      type_changed = true;
+	  }
+
+      if (type_changed
+	  || !std::is_sorted (bp_locations.begin (), bp_locations.end (),
+			      bp_location_is_less_than))
+	std::sort (bp_locations.begin (), bp_locations.end (),
+		   bp_location_is_less_than);
+
+      locs = bp_locations;
+    }
+
+  /* Locations get inserted below, and their shadows must be accounted
+     for, even if that fails.  Locations taken out of the list can only
+     make the limits larger than needed, which is harmless, so they are
+     only recomputed when looking at all locations.  */
+  SCOPE_EXIT
+    {
+      if (changed_only)
+	bp_locations_target_extensions_extend (touched_locations);
+      else
+	bp_locations_target_extensions_update ();
+    };
+
+  /* Handle the locations that were in the list already, and the ones
+     no longer present, which should therefore be freed.  Note that
+     it's not necessary that those locations should be removed from
+     inferior -- if there's another location at the same address
+     (previously marked as duplicate), we don't need to remove/insert
+     the location.  */
+
+  std::sort (added_locations.begin (), added_locations.end ());
+  for (bp_location *loc : locs)
+    if (!std::binary_search (added_locations.begin (),
+			     added_locations.end (), loc))
+      update_old_bp_location (loc, true, last_addr, last_pspace_num);
+
+  for (bp_location *loc : removed_locations)
+    update_old_bp_location (loc, false, last_addr, last_pspace_num);
+
+  mark_duplicate_bp_locations (locs);
 
   if (insert_mode == UGLL_INSERT || breakpoints_should_be_inserted_now ())
     {
       if (insert_mode != UGLL_DONT_INSERT)
-	insert_breakpoint_locations ();
+	insert_breakpoint_locations (locs);
       else
 	{
 	  /* Even though the caller told us to not insert new
@@ -11739,11 +12335,12 @@ update_global_location_list (enum ugll_insert_mode insert_mode)
 	     if the target is evaluating breakpoint conditions.  We
 	     only update conditions for locations that are marked
 	     "needs_update".  */
-	  update_inserted_breakpoint_locations ();
+	  update_inserted_breakpoint_locations (locs);
 	}
     }
 
-  if (insert_mode != UGLL_DONT_INSERT)
+  /* Tracepoint locations never take the CHANGED_ONLY path.  */
+  if (insert_mode != UGLL_DONT_INSERT && !changed_only)
     download_tracepoint_locations ();
 }
 
@@ -11763,12 +12360,13 @@ breakpoint_retire_moribund (void)
 }
 
 static void
-update_global_location_list_nothrow (enum ugll_insert_mode insert_mode)
+update_global_location_list_nothrow (enum ugll_insert_mode insert_mode,
+				     bool changed_only)
 {
 
   try
     {
-      update_global_location_list (insert_mode);
+      update_global_location_list (insert_mode, changed_only);
     }
   catch (const gdb_exception_error &e)
     {
@@ -11897,6 +12495,19 @@ breakpoint::add_location (bp_location &loc)
 				  const bp_location &right)
 				{ return left.address < right.address; });
   m_locations.insert (ub, loc);
+  bp_locations_added.push_back (&loc);
+}
+
+/* Record that LOC was taken off its owner's location list, for the
+   next update_global_location_list.  */
+
+static void
+note_location_unlinked (bp_location &loc)
+{
+  gdb_assert (!loc.unlinked);
+
+  loc.unlinked = true;
+  bp_locations_unlinked.push_back (&loc);
 }
 
 /* See breakpoint.h.  */
@@ -11908,6 +12519,18 @@ breakpoint::unadd_location (bp_location &loc)
   gdb_assert (loc.is_linked ());
 
   m_locations.erase (m_locations.iterator_to (loc));
+  note_location_unlinked (loc);
+}
+
+/* See breakpoint.h.  */
+
+void
+breakpoint::clear_locations ()
+{
+  for (bp_location &loc : m_locations)
+    note_location_unlinked (loc);
+
+  m_locations.clear ();
 }
 
 #define internal_error_pure_virtual_called() \
@@ -12661,9 +13284,11 @@ delete_breakpoint (struct breakpoint *bpt)
      self-contained, but it's not the case now.
 
      Clear the location linked list first, otherwise, the intrusive_list
-     destructor accesses the locations after they are freed.  */
+     destructor accesses the locations after they are freed.  Only
+     the locations of BPT changed, so the update need not look at the
+     others.  */
   bpt->clear_locations ();
-  update_global_location_list (UGLL_DONT_INSERT);
+  update_global_location_list (UGLL_DONT_INSERT, true);
 
   /* On the chance that someone will soon try again to delete this
      same bp, we mark it as deleted before freeing its storage.  */
@@ -12944,7 +13569,12 @@ bp_location_list
 breakpoint::steal_locations (program_space *pspace)
 {
   if (pspace == NULL)
-    return std::move (m_locations);
+    {
+      for (bp_location &loc : m_locations)
+	note_location_unlinked (loc);
+
+      return std::move (m_locations);
+    }
 
   bp_location_list ret;
 
@@ -12955,6 +13585,7 @@ breakpoint::steal_locations (program_space *pspace)
 	  bp_location &loc = *it;
 	  it = m_locations.erase (it);
 	  ret.push_back (loc);
+	  note_location_unlinked (loc);
 	}
       else
 	++it;
@@ -13232,6 +13863,10 @@ breakpoint_re_set_one (breakpoint *b)
 void
 breakpoint_re_set (void)
 {
+  /* Deleting the master breakpoints below and creating them anew would
+     otherwise update the global location list for each of them.  */
+  scoped_defer_global_location_list_update defer_update;
+
   {
     scoped_restore_current_language save_language;
     scoped_restore save_input_radix = make_scoped_restore (&input_radix);
@@ -15168,6 +15803,22 @@ When on, breakpoint location specific debugging is enabled."),
 			   show_debug_breakpoint,
 			   &setdebuglist, &showdebuglist);
 
+  add_setshow_boolean_cmd ("breakpoint-condition-bytecode",
+			   class_maintenance,
+			   &breakpoint_condition_bytecode, _("\
+Set whether breakpoint conditions are evaluated from bytecode."), _("\
+Show whether breakpoint conditions are evaluated from bytecode."), _("\
+When on (the default), GDB compiles the condition of each breakpoint\n\
+location to agent expression bytecode the first time the location is\n\
+hit, and interprets that bytecode on later hits, which is much faster\n\
+than evaluating the condition expression.  Conditions that cannot be\n\
+compiled, or whose bytecode cannot be fully evaluated by GDB, are\n\
+evaluated as usual."),
+			   NULL,
+			   show_breakpoint_condition_bytecode,
+			   &maintenance_set_cmdlist,
+			   &maintenance_show_cmdlist);
+
   add_setshow_enum_cmd ("condition-evaluation", class_breakpoint,
 			condition_evaluation_enums,
 			&condition_evaluation_mode_1, _("\
@@ -356,6 +356,14 @@ class bp_location : public refcounted_object, public intrusive_list_node<bp_loca
      condition evaluation.  */
   agent_expr_up cond_bytecode;
 
+  /* COND compiled once into bytecode that GDB can evaluate itself
+     when the location is hit, without going through the full
+     expression evaluator; see gen_eval_for_host.  Only meaningful if
+     COND_HOST_BYTECODE_VALID is set; a NULL pointer then means COND
+     could not be compiled.  */
+  agent_expr_up cond_host_bytecode;
+  bool cond_host_bytecode_valid = false;
+
   /* Signals that the condition has changed since the last time
      we updated the global location list.  This means the condition
      needs to be sent to the target again.  This is used together
@@ -483,6 +491,14 @@ class bp_location : public refcounted_object, public intrusive_list_node<bp_loca
      it becomes 0 this location is retired.  */
   int events_till_retirement = 0;
 
+  /* True if this location is in the global location list.  */
+  bool in_global_list = false;
+
+  /* True if this location was taken off its owner's location list.
+     The next update_global_location_list then removes it from the
+     global location list, if it is there, and frees it.  */
+  bool unlinked = false;
+
   /* Line number which was used to place this location.
 
      Breakpoint placed into a comment keeps it's user specified line number
@@ -647,8 +663,7 @@ struct breakpoint : public intrusive_list_node<breakpoint>
   void unadd_location (bp_location &loc);
 
   /* Clear the location list of this breakpoint.  */
-  void clear_locations ()
-  { m_locations.clear (); }
+  void clear_locations ();
 
   /* Split all locations of this breakpoint that are bound to PSPACE out of its
      location list to a separate list and return that list.  If
@@ -1931,8 +1946,27 @@ extern bool is_tracepoint (const struct breakpoint *b);
 /* Return a vector of all static tracepoints defined at ADDR.  */
 extern std::vector<breakpoint *> static_tracepoints_here (CORE_ADDR addr);
 
+/* While an instance of this class exists, creating breakpoints does
+   not update the global location list each time, as long as no
+   location needs to be inserted right away.  The list is brought up
+   to date when something needs it, and with the locations inserted,
+   when the last instance is destroyed.  Use this where many
+   breakpoints are created in a row.  */
+
+class scoped_defer_global_location_list_update
+{
+public:
+
+  scoped_defer_global_location_list_update ();
+  ~scoped_defer_global_location_list_update ();
+
+  DISABLE_COPY_AND_ASSIGN (scoped_defer_global_location_list_update);
+};
+
 /* Create an instance of this to start registering breakpoint numbers
-   for a later "commands" command.  */
+   for a later "commands" command.  While it exists, the global
+   location list updates are deferred, see
+   scoped_defer_global_location_list_update.  */
 
 class scoped_rbreak_breakpoints
 {
@@ -1942,6 +1976,10 @@ class scoped_rbreak_breakpoints
   ~scoped_rbreak_breakpoints ();
 
   DISABLE_COPY_AND_ASSIGN (scoped_rbreak_breakpoints);
+
+private:
+
+  scoped_defer_global_location_list_update m_defer;
 };
 
 /* Breakpoint linked list iterator.  */
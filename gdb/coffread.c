@@ -2151,6 +2151,7 @@ static const struct sym_fns coff_sym_fns =
   default_symfile_relocate,	/* sym_relocate: Relocate a debug
 				   section.  */
   NULL,				/* sym_probe_fns */
+  NULL,				/* sym_read_ahead */
 };
 
 void _initialize_coffread ();
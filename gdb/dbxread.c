@@ -3234,6 +3234,7 @@ static const struct sym_fns aout_sym_fns =
   NULL,
   default_symfile_relocate,	/* Relocate a debug section.  */
   NULL,				/* sym_probe_fns */
+  NULL,				/* sym_read_ahead */
 };
 
 void _initialize_dbxread ();
@@ -24,6 +24,8 @@
 #include "inferior.h"
 #include "splay-tree.h"
 #include "gdbarch.h"
+#include "extract-store-integer.h"
+#include "gdbsupport/byte-vector.h"
 
 /* Commands with a prefix of `{set,show} dcache'.  */
 static struct cmd_list_element *dcache_set_list = NULL;
@@ -82,6 +84,24 @@ static unsigned dcache_size = DCACHE_DEFAULT_SIZE;
 #define DCACHE_DEFAULT_LINE_SIZE 64
 static unsigned dcache_line_size = DCACHE_DEFAULT_LINE_SIZE;
 
+/* The maximum number of lines read ahead of a miss.  The cache starts
+   reading ahead when it sees misses on consecutive lines, e.g., while
+   unwinding the stack or dumping an array, and doubles the readahead
+   window on each further consecutive miss, up to this limit.  Zero
+   disables readahead.  */
+#define DCACHE_DEFAULT_READAHEAD 16
+static unsigned dcache_readahead = DCACHE_DEFAULT_READAHEAD;
+
+/* Whether to prefetch the lines that pointer-sized words of a freshly
+   read line point to.  This helps when walking linked structures, but
+   is a waste when the line doesn't hold pointers, so it is off by
+   default.  */
+static bool dcache_prefetch_pointers = false;
+
+/* The maximum number of lines prefetched by following the pointers
+   found in one line.  */
+#define DCACHE_MAX_POINTEES 4
+
 /* Each cache block holds LINE_SIZE bytes of data
    starting at a multiple-of-LINE_SIZE address.  */
 
@@ -97,6 +117,7 @@ struct dcache_block
 
   CORE_ADDR addr;		/* address of data */
   int refs;			/* # hits */
+  bool prefetched;		/* read ahead, and not used yet */
   gdb_byte data[1];		/* line_size bytes at given address */
 };
 
@@ -119,6 +140,19 @@ struct dcache_struct
   /* The process target of last inferior to use the cache or
      nullptr.  */
   process_stratum_target *proc_target;
+
+  /* Readahead state: the address following the last line read on a
+     miss, and the number of lines to read ahead on the next miss.  */
+  CORE_ADDR next_miss;
+  unsigned readahead;
+
+  /* Statistics, for "maint print dcache-statistics".  Lookups served
+     from the cache, lookups that had to read from the target, lines
+     read speculatively, and how many of those were used later.  */
+  unsigned long hits;
+  unsigned long misses;
+  unsigned long prefetched;
+  unsigned long prefetch_hits;
 };
 
 typedef void (block_func) (struct dcache_block *block, void *param);
@@ -253,6 +287,8 @@ dcache_invalidate (DCACHE *dcache)
   dcache->size = 0;
   dcache->ptid = null_ptid;
   dcache->proc_target = nullptr;
+  dcache->next_miss = 0;
+  dcache->readahead = 0;
 
   if (dcache->line_size != dcache_line_size)
     {
@@ -380,6 +416,7 @@ dcache_alloc (DCACHE *dcache, CORE_ADDR addr)
 
   db->addr = MASK (dcache, addr);
   db->refs = 0;
+  db->prefetched = false;
 
   /* Put DB at the end of the list, it's the newest.  */
   append_block (&dcache->oldest, db);
@@ -390,26 +427,192 @@ dcache_alloc (DCACHE *dcache, CORE_ADDR addr)
   return db;
 }
 
-/* Using the data cache DCACHE, store in *PTR the contents of the byte at
-   address ADDR in the remote machine.  
+/* Return the number of lines to read ahead of a miss on the line at
+   LINE, and update the readahead state of DCACHE.  OBJECT is the kind
+   of memory being read.  */
 
-   Returns 1 for success, 0 for error.  */
+static unsigned
+dcache_readahead_lines (DCACHE *dcache, CORE_ADDR line,
+			enum target_object object)
+{
+  if (dcache_readahead == 0)
+    dcache->readahead = 0;
+  else if (line == dcache->next_miss)
+    {
+      /* Sequential access; widen the window.  */
+      dcache->readahead = std::min (std::max (dcache->readahead * 2, 1u),
+				    dcache_readahead);
+    }
+  else if (object == TARGET_OBJECT_STACK_MEMORY)
+    {
+      /* Unwinding walks the stack towards higher addresses, so start
+	 stack reads with a wide window right away.  */
+      dcache->readahead = std::max (dcache_readahead / 2, 1u);
+    }
+  else
+    dcache->readahead = 0;
 
-static int
-dcache_peek_byte (DCACHE *dcache, CORE_ADDR addr, gdb_byte *ptr)
+  return dcache->readahead;
+}
+
+/* Prefetch the lines that the pointer-sized words of DB point to,
+   allocating at most MAX_LINES new lines, with a single batched read.
+   Lines that can't be read are dropped.  */
+
+static void
+dcache_prefetch_pointees (DCACHE *dcache, struct dcache_block *db,
+			  size_t max_lines)
 {
-  struct dcache_block *db = dcache_hit (dcache, addr);
+  struct gdbarch *arch = current_inferior ()->arch ();
+  int ptr_size = gdbarch_ptr_bit (arch) / TARGET_CHAR_BIT;
+  enum bfd_endian byte_order = gdbarch_byte_order (arch);
+
+  max_lines = std::min<size_t> (max_lines, DCACHE_MAX_POINTEES);
+
+  std::vector<CORE_ADDR> lines;
+  for (int off = 0;
+       off + ptr_size <= dcache->line_size && lines.size () < max_lines;
+       off += ptr_size)
+    {
+      CORE_ADDR ptr = extract_unsigned_integer (db->data + off, ptr_size,
+						byte_order);
+      CORE_ADDR line = MASK (dcache, ptr);
+
+      if (ptr == 0
+	  || line == db->addr
+	  || std::find (lines.begin (), lines.end (), line) != lines.end ()
+	  || splay_tree_lookup (dcache->tree, (splay_tree_key) line) != NULL)
+	continue;
+
+      /* Only speculate on plain memory, or on memory explicitly marked
+	 cacheable; reading e.g. device registers may have side
+	 effects.  */
+      struct mem_region *region = lookup_mem_region (line);
+      if (region->number != 0 && !region->attrib.cache)
+	continue;
+
+      lines.push_back (line);
+    }
+
+  if (lines.empty ())
+    return;
+
+  std::vector<memory_read_request> requests;
+  requests.reserve (lines.size ());
+  for (CORE_ADDR line : lines)
+    {
+      struct dcache_block *pointee = dcache_alloc (dcache, line);
 
-  if (!db)
+      requests.emplace_back (line, line + dcache->line_size, pointee->data);
+    }
+
+  target_read_raw_memory_batch (requests);
+
+  for (const memory_read_request &req : requests)
+    if (req.done)
+      {
+	struct dcache_block *pointee
+	  = (struct dcache_block *) splay_tree_lookup
+	      (dcache->tree, (splay_tree_key) req.begin)->value;
+
+	pointee->prefetched = true;
+	dcache->prefetched++;
+      }
+    else
+      dcache_invalidate_line (dcache, req.begin);
+}
+
+/* Handle a miss on the line containing ADDR, for a read that extends
+   up to (but not including) END.  Read the missing lines of the rest
+   of the request and the lines the readahead window covers with a
+   single read from OPS.  Return the block for ADDR's line, or NULL if
+   it could not be read.  */
+
+static struct dcache_block *
+dcache_miss (struct target_ops *ops, DCACHE *dcache, CORE_ADDR addr,
+	     CORE_ADDR end, enum target_object object)
+{
+  CORE_ADDR line = MASK (dcache, addr);
+  CORE_ADDR line_size = dcache->line_size;
+  unsigned ahead = dcache_readahead_lines (dcache, line, object);
+
+  dcache->misses++;
+
+  /* Count the lines the request still needs, then the readahead ones.
+     Stop at the first line that is cached already, and don't read
+     more lines than the cache holds, or the first ones read would be
+     evicted by the last.  Also stay within LINE's memory region, so
+     that we never touch memory with different attributes.  */
+  struct mem_region *region = lookup_mem_region (line);
+  unsigned demand = 1;
+  unsigned count = 1;
+  for (CORE_ADDR next = line + line_size;
+       next > line && count < dcache_size;
+       next += line_size)
     {
-      db = dcache_alloc (dcache, addr);
+      if (next >= end && count >= demand + ahead)
+	break;
+      if (region->hi != 0
+	  && (next >= region->hi || region->hi - next < line_size))
+	break;
+      if (splay_tree_lookup (dcache->tree, (splay_tree_key) next) != NULL)
+	break;
+
+      if (next < end)
+	demand++;
+      count++;
+    }
+
+  struct dcache_block *db = NULL;
 
+  if (count > 1)
+    {
+      gdb::byte_vector buf (count * line_size);
+      LONGEST got = target_read (ops, TARGET_OBJECT_RAW_MEMORY, NULL,
+				 buf.data (), line, buf.size ());
+
+      /* Shrink the window if it ran off the end of readable memory.  */
+      if (got < (LONGEST) buf.size ())
+	dcache->readahead /= 2;
+
+      for (unsigned i = 0; i < count && got >= (LONGEST) ((i + 1) * line_size);
+	   i++)
+	{
+	  struct dcache_block *b = dcache_alloc (dcache, line + i * line_size);
+
+	  memcpy (b->data, buf.data () + i * line_size, line_size);
+	  if (i == 0)
+	    db = b;
+	  else if (i >= demand)
+	    {
+	      b->prefetched = true;
+	      dcache->prefetched++;
+	    }
+	}
+    }
+
+  dcache->next_miss = line + count * line_size;
+
+  if (db == NULL)
+    {
+      /* Fall back to reading the line alone, piecewise by memory
+	 region.  */
+      db = dcache_alloc (dcache, line);
       if (!dcache_read_line (dcache, db))
-	 return 0;
+	{
+	  /* Discard the line so we don't have a partially read one.  */
+	  dcache_invalidate_line (dcache, line);
+	  return NULL;
+	}
     }
 
-  *ptr = db->data[XFORM (dcache, addr)];
-  return 1;
+  /* Lines are evicted in allocation order, and DB is the oldest of the
+     COUNT lines allocated above.  Allocate few enough pointee lines
+     that DB is still cached when we return it.  */
+  if (dcache_prefetch_pointers && count + 1 < dcache_size)
+    dcache_prefetch_pointees (dcache, db, dcache_size - 1 - count);
+
+  return db;
 }
 
 /* Write the byte at PTR into ADDR in the data cache.
@@ -458,6 +661,12 @@ dcache_init (void)
   dcache->line_size = dcache_line_size;
   dcache->ptid = null_ptid;
   dcache->proc_target = nullptr;
+  dcache->next_miss = 0;
+  dcache->readahead = 0;
+  dcache->hits = 0;
+  dcache->misses = 0;
+  dcache->prefetched = 0;
+  dcache->prefetch_hits = 0;
 
   return dcache;
 }
@@ -465,11 +674,13 @@ dcache_init (void)
 
 /* Read LEN bytes from dcache memory at MEMADDR, transferring to
    debugger address MYADDR.  If the data is presently cached, this
-   fills the cache.  Arguments/return are like the target_xfer_partial
-   interface.  */
+   fills the cache.  OBJECT is the kind of memory being read, which
+   steers readahead.  Other arguments and the return value are like
+   the target_xfer_partial interface.  */
 
 enum target_xfer_status
 dcache_read_memory_partial (struct target_ops *ops, DCACHE *dcache,
+			    enum target_object object,
 			    CORE_ADDR memaddr, gdb_byte *myaddr,
 			    ULONGEST len, ULONGEST *xfered_len)
 {
@@ -486,15 +697,33 @@ dcache_read_memory_partial (struct target_ops *ops, DCACHE *dcache,
       dcache->proc_target = proc_target;
     }
 
-  for (i = 0; i < len; i++)
+  i = 0;
+  while (i < len)
     {
-      if (!dcache_peek_byte (dcache, memaddr + i, myaddr + i))
+      CORE_ADDR addr = memaddr + i;
+      struct dcache_block *db = dcache_hit (dcache, addr);
+
+      if (db != NULL)
+	{
+	  dcache->hits++;
+	  if (db->prefetched)
+	    {
+	      db->prefetched = false;
+	      dcache->prefetch_hits++;
+	    }
+	}
+      else
 	{
-	  /* That failed.  Discard its cache line so we don't have a
-	     partially read line.  */
-	  dcache_invalidate_line (dcache, memaddr + i);
-	  break;
+	  db = dcache_miss (ops, dcache, addr, memaddr + len, object);
+	  if (db == NULL)
+	    break;
 	}
+
+      ULONGEST offset = XFORM (dcache, addr);
+      ULONGEST n = std::min (len - i, (ULONGEST) dcache->line_size - offset);
+
+      memcpy (myaddr + i, db->data + offset, n);
+      i += n;
     }
 
   if (i == 0)
@@ -542,6 +771,35 @@ dcache_update (DCACHE *dcache, enum target_xfer_status status,
       }
 }
 
+/* See dcache.h.  */
+
+void
+dcache_prime (DCACHE *dcache, process_stratum_target *proc_target,
+	      ptid_t ptid, CORE_ADDR memaddr, const gdb_byte *myaddr,
+	      ULONGEST len)
+{
+  if (proc_target != dcache->proc_target || ptid != dcache->ptid)
+    {
+      dcache_invalidate (dcache);
+      dcache->ptid = ptid;
+      dcache->proc_target = proc_target;
+    }
+
+  /* Only whole lines can be cached.  */
+  CORE_ADDR line = MASK (dcache, memaddr + dcache->line_size - 1);
+  for (; line >= memaddr && line - memaddr + dcache->line_size <= len;
+       line += dcache->line_size)
+    {
+      if (splay_tree_lookup (dcache->tree, (splay_tree_key) line) != nullptr)
+	continue;
+
+      struct dcache_block *db = dcache_alloc (dcache, line);
+      memcpy (db->data, myaddr + (line - memaddr), dcache->line_size);
+      db->prefetched = true;
+      dcache->prefetched++;
+    }
+}
+
 /* Print DCACHE line INDEX.  */
 
 static void
@@ -653,6 +911,28 @@ info_dcache_command (const char *exp, int tty)
   dcache_info_1 (target_dcache_get (current_program_space->aspace), exp);
 }
 
+/* The "maint print dcache-statistics" command.  */
+
+static void
+maintenance_print_dcache_statistics (const char *args, int from_tty)
+{
+  DCACHE *dcache = target_dcache_get (current_program_space->aspace);
+
+  if (dcache == NULL)
+    {
+      gdb_printf (_("No data cache available.\n"));
+      return;
+    }
+
+  gdb_printf (_("Dcache statistics:\n"));
+  gdb_printf (_("  lines:          %d of %u\n"), dcache->size, dcache_size);
+  gdb_printf (_("  hits:           %lu\n"), dcache->hits);
+  gdb_printf (_("  misses:         %lu\n"), dcache->misses);
+  gdb_printf (_("  prefetched:     %lu\n"), dcache->prefetched);
+  gdb_printf (_("  prefetch hits:  %lu\n"), dcache->prefetch_hits);
+  gdb_printf (_("  readahead:      %u lines\n"), dcache->readahead);
+}
+
 static void
 set_dcache_size (const char *args, int from_tty,
 		 struct cmd_list_element *c)
@@ -726,4 +1006,30 @@ Show number of dcache lines."),
 			     set_dcache_size,
 			     NULL,
 			     &dcache_set_list, &dcache_show_list);
+  add_setshow_zuinteger_cmd ("readahead", class_obscure,
+			     &dcache_readahead, _("\
+Set the maximum number of dcache lines read ahead of a miss."), _("\
+Show the maximum number of dcache lines read ahead of a miss."), _("\
+When the dcache sees misses on consecutive lines, it starts reading the\n\
+following lines along with the missing one, doubling the number of lines\n\
+read ahead on each further consecutive miss up to this limit.\n\
+Zero disables readahead."),
+			     NULL,
+			     NULL,
+			     &dcache_set_list, &dcache_show_list);
+  add_setshow_boolean_cmd ("prefetch-pointers", class_obscure,
+			   &dcache_prefetch_pointers, _("\
+Set whether the dcache prefetches the targets of pointers it reads."), _("\
+Show whether the dcache prefetches the targets of pointers it reads."), _("\
+When on, each line read into the dcache is scanned for pointer-sized\n\
+words, and the lines they point to are read along with it.  This speeds\n\
+up walking linked data structures over slow connections."),
+			   NULL,
+			   NULL,
+			   &dcache_set_list, &dcache_show_list);
+
+  add_cmd ("dcache-statistics", class_maintenance,
+	   maintenance_print_dcache_statistics,
+	   _("Print dcache hit, miss and prefetch statistics."),
+	   &maintenanceprintlist);
 }
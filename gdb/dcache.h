@@ -45,6 +45,7 @@ struct dcache_deleter
 
 enum target_xfer_status
   dcache_read_memory_partial (struct target_ops *ops, DCACHE *dcache,
+			      enum target_object object,
 			      CORE_ADDR memaddr, gdb_byte *myaddr,
 			      ULONGEST len, ULONGEST *xfered_len);
 
@@ -52,4 +53,13 @@ void dcache_update (DCACHE *dcache, enum target_xfer_status status,
 		    CORE_ADDR memaddr, const gdb_byte *myaddr,
 		    ULONGEST len);
 
+/* Fill the lines of DCACHE that are wholly within the LEN bytes at
+   MEMADDR with MYADDR, the contents of that memory as seen by thread
+   PTID of PROC_TARGET.  This lets a target seed the cache with memory
+   it got for free, e.g., along with a stop event.  */
+
+void dcache_prime (DCACHE *dcache, process_stratum_target *proc_target,
+		   ptid_t ptid, CORE_ADDR memaddr, const gdb_byte *myaddr,
+		   ULONGEST len);
+
 #endif /* DCACHE_H */
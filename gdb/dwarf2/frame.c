@@ -41,6 +41,11 @@
 #include "dwarf2/loc.h"
 #include "dwarf2/frame-tailcall.h"
 #include "gdbsupport/gdb_binary_search.h"
+#include "gdbsupport/scope-exit.h"
+#include "gdbsupport/thread-pool.h"
+#include "gdb_bfd.h"
+#include "observable.h"
+#include "run-on-main-thread.h"
 #if GDB_SELF_TEST
 #include "gdbsupport/selftest.h"
 #include "selftest-arch.h"
@@ -138,6 +143,30 @@ struct dwarf2_fde
 
 typedef std::vector<dwarf2_fde *> dwarf2_fde_table;
 
+/* The outcome of running the CFA program of an FDE up to a given
+   address, as needed by dwarf2_frame_cache.  It only depends on the
+   CFI, so it stays valid for as long as the CFI itself, across
+   inferior stops and frame cache flushes.  */
+
+struct dwarf2_frame_row
+{
+  /* The register and CFA rules.  PREV is always NULL.  */
+  dwarf2_frame_state_reg_info regs;
+
+  /* See dwarf2_frame_state.  */
+  bool armcc_cfa_offsets_reversed;
+
+  /* Whether the CFA is SP-relative at the function's entry point, and
+     the offset if so; see dwarf2_tailcall_sniffer_first.  */
+  bool entry_cfa_sp_offset_p;
+  LONGEST entry_cfa_sp_offset;
+};
+
+/* Unwind rows, keyed by the unrelocated address they describe.  */
+typedef std::unordered_map<unrelocated_addr,
+			   std::unique_ptr<dwarf2_frame_row>>
+  dwarf2_frame_row_table;
+
 /* A minimal decoding of DWARF2 compilation units.  We only decode
    what's needed to get to the call frame information.  */
 
@@ -148,6 +177,24 @@ struct comp_unit
   {
   }
 
+  ~comp_unit ()
+  {
+    /* The builder task uses this object.  */
+    if (building_fde_table)
+      fde_table_builder.wait ();
+  }
+
+  DISABLE_COPY_AND_ASSIGN (comp_unit);
+
+  /* Wait for FDE_TABLE to be complete, if it is being built in the
+     background, and report what went wrong while building it.  Must
+     be called on the main thread before looking at FDE_TABLE.  */
+  void wait_for_fde_table ();
+
+  /* Return the FDE covering SEEK_PC, or NULL.  */
+  struct dwarf2_fde *find_fde (struct gdbarch *gdbarch,
+			       unrelocated_addr seek_pc);
+
   /* Keep the bfd convenient.  */
   bfd *abfd;
 
@@ -169,6 +216,33 @@ struct comp_unit
   /* The FDE table.  */
   dwarf2_fde_table fde_table;
 
+  /* Set while FDE_TABLE is being built by FDE_TABLE_BUILDER, in a
+     worker thread.  Complaints and warnings issued meanwhile are
+     saved in BUILD_COMPLAINTS and BUILD_WARNINGS, to be emitted on
+     the main thread.  */
+  bool building_fde_table = false;
+  gdb::future<void> fde_table_builder;
+  complaint_collection build_complaints;
+  std::vector<std::string> build_warnings;
+
+  /* If not NULL, the FDEs of .eh_frame are not in FDE_TABLE.  They are
+     instead found through this binary search table of .eh_frame_hdr,
+     which holds EH_FRAME_HDR_COUNT pairs of initial location and FDE
+     address, both relative to EH_FRAME_HDR_VMA.  Only the FDEs that
+     lookups actually hit are decoded; they are kept in EH_FRAME_FDES,
+     keyed by offset in .eh_frame, with NULL for entries that couldn't
+     be decoded.  Their CIEs are kept in CIE_TABLE.  */
+  const gdb_byte *eh_frame_hdr_table = nullptr;
+  size_t eh_frame_hdr_count = 0;
+  bfd_vma eh_frame_hdr_vma = 0;
+  std::unordered_map<ULONGEST, dwarf2_fde *> eh_frame_fdes;
+  dwarf2_cie_table cie_table;
+
+  /* Unwind rows of the return addresses seen so far.  Stepping in a
+     deep stack unwinds the same outer frames over and over; this lets
+     dwarf2_frame_cache skip interpreting their CFA programs again.  */
+  dwarf2_frame_row_table rows;
+
   /* Hold data used by this module.  */
   auto_obstack obstack;
 };
@@ -176,6 +250,8 @@ struct comp_unit
 static struct dwarf2_fde *dwarf2_frame_find_fde
   (CORE_ADDR *pc, dwarf2_per_objfile **out_per_objfile);
 
+static comp_unit *find_comp_unit (struct objfile *objfile);
+
 static int dwarf2_frame_adjust_regnum (struct gdbarch *gdbarch, int regnum,
 				       int eh_frame_p);
 
@@ -935,47 +1011,90 @@ dwarf2_frame_cache (const frame_info_ptr &this_frame, void **this_cache)
 
   cache->addr_size = fde->cie->addr_size;
 
-  /* Check for "quirks" - known bugs in producers.  */
-  dwarf2_frame_find_quirks (&fs, fde);
+  LONGEST entry_cfa_sp_offset;
+  int entry_cfa_sp_offset_p = 0;
 
-  /* First decode all the insns in the CIE.  */
-  execute_cfa_program (fde, fde->cie->initial_instructions,
-		       fde->cie->end, gdbarch,
-		       get_frame_address_in_block (this_frame), &fs,
-		       text_offset);
+  /* Only remember the rows of frames that called into their inner
+     frame.  Their addresses are return addresses, of which there are
+     few, while the innermost frame's pc changes on every step.  */
+  CORE_ADDR block_addr = get_frame_address_in_block (this_frame);
+  dwarf2_frame_row_table *rows = nullptr;
+  if (block_addr != get_frame_pc (this_frame))
+    rows = &find_comp_unit (cache->per_objfile->objfile)->rows;
+  unrelocated_addr row_addr = (unrelocated_addr) (block_addr - text_offset);
 
-  /* Save the initialized register set.  */
-  fs.initial = fs.regs;
+  const dwarf2_frame_row *row = nullptr;
+  if (rows != nullptr)
+    {
+      auto it = rows->find (row_addr);
+      if (it != rows->end ())
+	row = it->second.get ();
+    }
 
-  /* Fetching the entry pc for THIS_FRAME won't necessarily result
-     in an address that's within the range of FDE locations.  This
-     is due to the possibility of the function occupying non-contiguous
-     ranges.  */
-  LONGEST entry_cfa_sp_offset;
-  int entry_cfa_sp_offset_p = 0;
-  if (get_frame_func_if_available (this_frame, &entry_pc)
-      && fde->initial_location <= (unrelocated_addr) (entry_pc - text_offset)
-      && (unrelocated_addr) (entry_pc - text_offset) < fde->end_addr ())
+  if (row != nullptr)
     {
-      /* Decode the insns in the FDE up to the entry PC.  */
-      instr = execute_cfa_program (fde, fde->instructions, fde->end, gdbarch,
-				   entry_pc, &fs, text_offset);
+      fs.regs = row->regs;
+      fs.armcc_cfa_offsets_reversed = row->armcc_cfa_offsets_reversed;
+      entry_cfa_sp_offset_p = row->entry_cfa_sp_offset_p;
+      entry_cfa_sp_offset = row->entry_cfa_sp_offset;
+    }
+  else
+    {
+      /* Check for "quirks" - known bugs in producers.  */
+      dwarf2_frame_find_quirks (&fs, fde);
+
+      /* First decode all the insns in the CIE.  */
+      execute_cfa_program (fde, fde->cie->initial_instructions,
+			   fde->cie->end, gdbarch, block_addr, &fs,
+			   text_offset);
+
+      /* Save the initialized register set.  */
+      fs.initial = fs.regs;
+
+      /* Fetching the entry pc for THIS_FRAME won't necessarily result
+	 in an address that's within the range of FDE locations.  This
+	 is due to the possibility of the function occupying
+	 non-contiguous ranges.  */
+      bool entry_pc_p = get_frame_func_if_available (this_frame, &entry_pc);
+      if (entry_pc_p
+	  && fde->initial_location <= (unrelocated_addr) (entry_pc - text_offset)
+	  && (unrelocated_addr) (entry_pc - text_offset) < fde->end_addr ())
+	{
+	  /* Decode the insns in the FDE up to the entry PC.  */
+	  instr = execute_cfa_program (fde, fde->instructions, fde->end,
+				       gdbarch, entry_pc, &fs, text_offset);
+
+	  if (fs.regs.cfa_how == CFA_REG_OFFSET
+	      && (dwarf_reg_to_regnum (gdbarch, fs.regs.cfa_reg)
+		  == gdbarch_sp_regnum (gdbarch)))
+	    {
+	      entry_cfa_sp_offset = fs.regs.cfa_offset;
+	      entry_cfa_sp_offset_p = 1;
+	    }
+	}
+      else
+	instr = fde->instructions;
 
-      if (fs.regs.cfa_how == CFA_REG_OFFSET
-	  && (dwarf_reg_to_regnum (gdbarch, fs.regs.cfa_reg)
-	      == gdbarch_sp_regnum (gdbarch)))
+      /* Then decode the insns in the FDE up to our target PC.  */
+      execute_cfa_program (fde, instr, fde->end, gdbarch, block_addr, &fs,
+			   text_offset);
+
+      /* The entry pc is unknown when e.g. looking at a traceframe
+	 that lacks the registers needed; don't remember what was
+	 computed without it.  */
+      if (rows != nullptr && entry_pc_p)
 	{
-	  entry_cfa_sp_offset = fs.regs.cfa_offset;
-	  entry_cfa_sp_offset_p = 1;
+	  std::unique_ptr<dwarf2_frame_row> new_row (new dwarf2_frame_row);
+
+	  new_row->regs = fs.regs;
+	  new_row->regs.prev = nullptr;
+	  new_row->armcc_cfa_offsets_reversed = fs.armcc_cfa_offsets_reversed;
+	  new_row->entry_cfa_sp_offset_p = entry_cfa_sp_offset_p;
+	  new_row->entry_cfa_sp_offset
+	    = entry_cfa_sp_offset_p ? entry_cfa_sp_offset : 0;
+	  rows->emplace (row_addr, std::move (new_row));
 	}
     }
-  else
-    instr = fde->instructions;
-
-  /* Then decode the insns in the FDE up to our target PC.  */
-  execute_cfa_program (fde, instr, fde->end, gdbarch,
-		       get_frame_address_in_block (this_frame), &fs,
-		       text_offset);
 
   try
     {
@@ -1596,16 +1715,23 @@ bsearch_fde_cmp (const dwarf2_fde *fde, unrelocated_addr seek_pc)
   return 1;
 }
 
-/* Find an existing comp_unit for an objfile, if any.  */
+/* Find an existing comp_unit for an objfile, if any.  If its FDE
+   table is being built in the background, wait for it.  */
 
 static comp_unit *
 find_comp_unit (struct objfile *objfile)
 {
   bfd *abfd = objfile->obfd.get ();
+  comp_unit *unit;
+
   if (gdb_bfd_requires_relocations (abfd))
-    return dwarf2_frame_objfile_data.get (objfile);
+    unit = dwarf2_frame_objfile_data.get (objfile);
+  else
+    unit = dwarf2_frame_bfd_data.get (abfd);
 
-  return dwarf2_frame_bfd_data.get (abfd);
+  if (unit != nullptr)
+    unit->wait_for_fde_table ();
+  return unit;
 }
 
 /* Store the comp_unit on OBJFILE, or the corresponding BFD, as
@@ -1621,6 +1747,116 @@ set_comp_unit (struct objfile *objfile, struct comp_unit *unit)
   return dwarf2_frame_bfd_data.set (abfd, unit);
 }
 
+#define DW64_CIE_ID 0xffffffffffffffffULL
+
+/* Defines the type of eh_frames that are expected to be decoded: CIE, FDE
+   or any of them.  */
+
+enum eh_frame_type
+{
+  EH_CIE_TYPE_ID = 1 << 0,
+  EH_FDE_TYPE_ID = 1 << 1,
+  EH_CIE_OR_FDE_TYPE_ID = EH_CIE_TYPE_ID | EH_FDE_TYPE_ID
+};
+
+static const gdb_byte *decode_frame_entry (struct gdbarch *gdbarch,
+					   struct comp_unit *unit,
+					   const gdb_byte *start,
+					   int eh_frame_p,
+					   dwarf2_cie_table &cie_table,
+					   dwarf2_fde_table *fde_table,
+					   enum eh_frame_type entry_type);
+
+/* See struct comp_unit.  */
+
+void
+comp_unit::wait_for_fde_table ()
+{
+  gdb_assert (is_main_thread ());
+
+  if (!building_fde_table)
+    return;
+
+  fde_table_builder.get ();
+  building_fde_table = false;
+
+  re_emit_complaints (build_complaints);
+  build_complaints.clear ();
+  for (const std::string &msg : build_warnings)
+    warning ("%s", msg.c_str ());
+  build_warnings.clear ();
+}
+
+/* See struct comp_unit.  */
+
+struct dwarf2_fde *
+comp_unit::find_fde (struct gdbarch *gdbarch, unrelocated_addr seek_pc)
+{
+  if (!fde_table.empty () && seek_pc >= fde_table[0]->initial_location)
+    {
+      auto it = gdb::binary_search (fde_table.begin (), fde_table.end (),
+				    seek_pc, bsearch_fde_cmp);
+      if (it != fde_table.end ())
+	return *it;
+    }
+
+  if (eh_frame_hdr_table == nullptr)
+    return nullptr;
+
+  /* Find the last entry starting at or below SEEK_PC.  */
+  auto entry_addr = [this] (size_t i, int which)
+    {
+      const gdb_byte *p = eh_frame_hdr_table + i * 8 + which * 4;
+      return (ULONGEST) (eh_frame_hdr_vma + bfd_get_signed_32 (abfd, p));
+    };
+
+  size_t lo = 0, hi = eh_frame_hdr_count;
+  while (lo < hi)
+    {
+      size_t mid = lo + (hi - lo) / 2;
+      if (entry_addr (mid, 0) <= (ULONGEST) seek_pc)
+	lo = mid + 1;
+      else
+	hi = mid;
+    }
+  if (lo == 0)
+    return nullptr;
+
+  ULONGEST fde_offset
+    = entry_addr (lo - 1, 1) - bfd_section_vma (dwarf_frame_section);
+  if (fde_offset >= dwarf_frame_size)
+    return nullptr;
+
+  auto inserted = eh_frame_fdes.emplace (fde_offset, nullptr);
+  if (inserted.second)
+    {
+      dwarf2_fde_table found;
+
+      try
+	{
+	  decode_frame_entry (gdbarch, this, dwarf_frame_buffer + fde_offset,
+			      1, cie_table, &found, EH_FDE_TYPE_ID);
+	}
+      catch (const gdb_exception_error &e)
+	{
+	  complaint (_("Invalid FDE at offset %s of %s:%s: %s"),
+		     pulongest (fde_offset), bfd_get_filename (abfd),
+		     bfd_section_name (dwarf_frame_section), e.what ());
+	}
+
+      if (found.size () == 1)
+	inserted.first->second = found[0];
+    }
+
+  struct dwarf2_fde *fde = inserted.first->second;
+  if (fde != nullptr
+      && fde->initial_location <= seek_pc
+      && seek_pc < fde->end_addr ())
+    return fde;
+
+  return nullptr;
+}
+
 /* Find the FDE for *PC.  Return a pointer to the FDE, and store the
    initial location associated with it into *PC.  */
 
@@ -1642,27 +1878,18 @@ dwarf2_frame_find_fde (CORE_ADDR *pc, dwarf2_per_objfile **out_per_objfile)
 	}
       gdb_assert (unit != NULL);
 
-      dwarf2_fde_table *fde_table = &unit->fde_table;
-      if (fde_table->empty ())
-	continue;
-
       gdb_assert (!objfile->section_offsets.empty ());
       offset = objfile->text_section_offset ();
 
-      gdb_assert (!fde_table->empty ());
       unrelocated_addr seek_pc = (unrelocated_addr) (*pc - offset);
-      if (seek_pc < (*fde_table)[0]->initial_location)
-	continue;
-
-      auto it = gdb::binary_search (fde_table->begin (), fde_table->end (),
-				    seek_pc, bsearch_fde_cmp);
-      if (it != fde_table->end ())
+      struct dwarf2_fde *fde = unit->find_fde (objfile->arch (), seek_pc);
+      if (fde != nullptr)
 	{
-	  *pc = (CORE_ADDR) (*it)->initial_location + offset;
+	  *pc = (CORE_ADDR) fde->initial_location + offset;
 	  if (out_per_objfile != nullptr)
 	    *out_per_objfile = get_dwarf2_per_objfile (objfile);
 
-	  return *it;
+	  return fde;
 	}
     }
   return NULL;
@@ -1679,25 +1906,6 @@ add_fde (dwarf2_fde_table *fde_table, struct dwarf2_fde *fde)
   fde_table->push_back (fde);
 }
 
-#define DW64_CIE_ID 0xffffffffffffffffULL
-
-/* Defines the type of eh_frames that are expected to be decoded: CIE, FDE
-   or any of them.  */
-
-enum eh_frame_type
-{
-  EH_CIE_TYPE_ID = 1 << 0,
-  EH_FDE_TYPE_ID = 1 << 1,
-  EH_CIE_OR_FDE_TYPE_ID = EH_CIE_TYPE_ID | EH_FDE_TYPE_ID
-};
-
-static const gdb_byte *decode_frame_entry (struct gdbarch *gdbarch,
-					   struct comp_unit *unit,
-					   const gdb_byte *start,
-					   int eh_frame_p,
-					   dwarf2_cie_table &cie_table,
-					   dwarf2_fde_table *fde_table,
-					   enum eh_frame_type entry_type);
 
 /* Decode the next CIE or FDE, entry_type specifies the expected type.
    Return NULL if invalid input, otherwise the next byte to be processed.  */
@@ -2120,87 +2328,120 @@ fde_is_less_than (const dwarf2_fde *aa, const dwarf2_fde *bb)
   return aa->initial_location < bb->initial_location;
 }
 
-void
-dwarf2_build_frame_info (struct objfile *objfile)
-{
-  const gdb_byte *frame_ptr;
-  dwarf2_cie_table cie_table;
-  dwarf2_fde_table fde_table;
+/* A frame section, as returned by dwarf2_get_section_info.  */
 
-  struct gdbarch *gdbarch = objfile->arch ();
+struct frame_section
+{
+  asection *section = nullptr;
+  const gdb_byte *buffer = nullptr;
+  bfd_size_type size = 0;
+};
 
-  /* Build a minimal decoding of the DWARF2 compilation unit.  */
-  auto unit = std::make_unique<comp_unit> (objfile);
+/* Make UNIT look up the FDEs of .eh_frame, which UNIT's section fields
+   must describe, through the binary search table in .eh_frame_hdr.
+   Return false if UNIT's BFD has no such table, or one GDB doesn't
+   understand.  This must be called on the main thread.  */
 
-  if (objfile->separate_debug_objfile_backlink == NULL)
-    {
-      /* Do not read .eh_frame from separate file as they must be also
-	 present in the main file.  */
-      dwarf2_get_section_info (objfile, DWARF2_EH_FRAME,
-			       &unit->dwarf_frame_section,
-			       &unit->dwarf_frame_buffer,
-			       &unit->dwarf_frame_size);
-      if (unit->dwarf_frame_size)
-	{
-	  asection *got, *txt;
+static bool
+use_eh_frame_hdr (comp_unit *unit)
+{
+  asection *hdr = bfd_get_section_by_name (unit->abfd, ".eh_frame_hdr");
+  if (hdr == nullptr)
+    return false;
+
+  bfd_size_type size;
+  const gdb_byte *buf = gdb_bfd_map_section (hdr, &size);
+
+  /* The header holds a version number, the encodings of the pointer
+     to .eh_frame, of the number of table entries and of the table
+     entries, then the pointer and number themselves.  Only accept
+     the encodings that the GNU linkers and LLD emit.  */
+  if (buf == nullptr || size < 12
+      || buf[0] != 1
+      || buf[1] != (DW_EH_PE_pcrel | DW_EH_PE_sdata4)
+      || buf[2] != DW_EH_PE_udata4
+      || buf[3] != (DW_EH_PE_datarel | DW_EH_PE_sdata4))
+    return false;
+
+  bfd_vma hdr_vma = bfd_section_vma (hdr);
+  bfd_vma eh_frame_ptr = hdr_vma + 4 + bfd_get_signed_32 (unit->abfd, buf + 4);
+  ULONGEST count = bfd_get_32 (unit->abfd, buf + 8);
+
+  if (eh_frame_ptr != bfd_section_vma (unit->dwarf_frame_section)
+      || count > (size - 12) / 8)
+    return false;
+
+  unit->eh_frame_hdr_table = buf + 12;
+  unit->eh_frame_hdr_count = count;
+  unit->eh_frame_hdr_vma = hdr_vma;
+  return true;
+}
 
-	  /* FIXME: kettenis/20030602: This is the DW_EH_PE_datarel base
-	     that is used for the i386/amd64 target, which currently is
-	     the only target in GCC that supports/uses the
-	     DW_EH_PE_datarel encoding.  */
-	  got = bfd_get_section_by_name (unit->abfd, ".got");
-	  if (got)
-	    unit->dbase = got->vma;
+/* Decode all the CIEs and FDEs of EH_FRAME and DEBUG_FRAME into UNIT's
+   FDE table, and prepare it for lookups.  OBJFILE_NAME is used in the
+   messages appended to WARNINGS.  This only touches UNIT, so it can
+   run in a worker thread.  */
 
-	  /* GCC emits the DW_EH_PE_textrel encoding type on sh and ia64
-	     so far.  */
-	  txt = bfd_get_section_by_name (unit->abfd, ".text");
-	  if (txt)
-	    unit->tbase = txt->vma;
+static void
+build_fde_table (struct gdbarch *gdbarch, comp_unit *unit,
+		 const char *objfile_name, const frame_section &eh_frame,
+		 const frame_section &debug_frame,
+		 std::vector<std::string> &warnings)
+{
+  const gdb_byte *frame_ptr;
+  dwarf2_cie_table cie_table;
+  dwarf2_fde_table fde_table;
 
-	  try
-	    {
-	      frame_ptr = unit->dwarf_frame_buffer;
-	      while (frame_ptr < unit->dwarf_frame_buffer + unit->dwarf_frame_size)
-		frame_ptr = decode_frame_entry (gdbarch, unit.get (),
-						frame_ptr, 1,
-						cie_table, &fde_table,
-						EH_CIE_OR_FDE_TYPE_ID);
-	    }
+  if (eh_frame.size != 0)
+    {
+      unit->dwarf_frame_section = eh_frame.section;
+      unit->dwarf_frame_buffer = eh_frame.buffer;
+      unit->dwarf_frame_size = eh_frame.size;
 
-	  catch (const gdb_exception_error &e)
-	    {
-	      warning (_("skipping .eh_frame info of %s: %s"),
-		       objfile_name (objfile), e.what ());
+      try
+	{
+	  frame_ptr = unit->dwarf_frame_buffer;
+	  while (frame_ptr < unit->dwarf_frame_buffer + unit->dwarf_frame_size)
+	    frame_ptr = decode_frame_entry (gdbarch, unit,
+					    frame_ptr, 1,
+					    cie_table, &fde_table,
+					    EH_CIE_OR_FDE_TYPE_ID);
+	}
 
-	      fde_table.clear ();
-	      /* The cie_table is discarded below.  */
-	    }
+      catch (const gdb_exception_error &e)
+	{
+	  warnings.push_back (string_printf (_("skipping .eh_frame info of "
+					       "%s: %s"),
+					     objfile_name, e.what ()));
 
-	  cie_table.clear ();
+	  fde_table.clear ();
+	  /* The cie_table is discarded below.  */
 	}
+
+      cie_table.clear ();
     }
 
-  dwarf2_get_section_info (objfile, DWARF2_DEBUG_FRAME,
-			   &unit->dwarf_frame_section,
-			   &unit->dwarf_frame_buffer,
-			   &unit->dwarf_frame_size);
-  if (unit->dwarf_frame_size)
+  if (debug_frame.size != 0)
     {
+      unit->dwarf_frame_section = debug_frame.section;
+      unit->dwarf_frame_buffer = debug_frame.buffer;
+      unit->dwarf_frame_size = debug_frame.size;
+
       size_t num_old_fde_entries = fde_table.size ();
 
       try
 	{
 	  frame_ptr = unit->dwarf_frame_buffer;
 	  while (frame_ptr < unit->dwarf_frame_buffer + unit->dwarf_frame_size)
-	    frame_ptr = decode_frame_entry (gdbarch, unit.get (), frame_ptr, 0,
+	    frame_ptr = decode_frame_entry (gdbarch, unit, frame_ptr, 0,
 					    cie_table, &fde_table,
 					    EH_CIE_OR_FDE_TYPE_ID);
 	}
       catch (const gdb_exception_error &e)
 	{
-	  warning (_("skipping .debug_frame info of %s: %s"),
-		   objfile_name (objfile), e.what ());
+	  warnings.push_back (string_printf (_("skipping .debug_frame info "
+					       "of %s: %s"),
+					     objfile_name, e.what ()));
 
 	  fde_table.resize (num_old_fde_entries);
 	}
@@ -2251,8 +2492,126 @@ dwarf2_build_frame_info (struct objfile *objfile)
       fde_prev = fde;
     }
   unit->fde_table.shrink_to_fit ();
+}
+
+/* Create the comp_unit of OBJFILE.  If OBJFILE has both a .eh_frame
+   section with a usable .eh_frame_hdr and no .debug_frame, nothing is
+   decoded up front.  Otherwise, the FDE table is built; in a worker
+   thread if BACKGROUND is true, in which case find_comp_unit waits
+   for it.  */
+
+static void
+start_building_frame_info (struct objfile *objfile, bool background)
+{
+  frame_section eh_frame, debug_frame;
+  struct gdbarch *gdbarch = objfile->arch ();
+
+  /* Build a minimal decoding of the DWARF2 compilation unit.  */
+  auto unit = std::make_unique<comp_unit> (objfile);
+
+  /* Map the sections on the main thread; the builder only decodes
+     them.  */
+  if (objfile->separate_debug_objfile_backlink == NULL)
+    {
+      /* Do not read .eh_frame from separate file as they must be also
+	 present in the main file.  */
+      dwarf2_get_section_info (objfile, DWARF2_EH_FRAME,
+			       &eh_frame.section, &eh_frame.buffer,
+			       &eh_frame.size);
+      if (eh_frame.size)
+	{
+	  asection *got, *txt;
+
+	  /* FIXME: kettenis/20030602: This is the DW_EH_PE_datarel base
+	     that is used for the i386/amd64 target, which currently is
+	     the only target in GCC that supports/uses the
+	     DW_EH_PE_datarel encoding.  */
+	  got = bfd_get_section_by_name (unit->abfd, ".got");
+	  if (got)
+	    unit->dbase = got->vma;
+
+	  /* GCC emits the DW_EH_PE_textrel encoding type on sh and ia64
+	     so far.  */
+	  txt = bfd_get_section_by_name (unit->abfd, ".text");
+	  if (txt)
+	    unit->tbase = txt->vma;
+	}
+    }
+
+  dwarf2_get_section_info (objfile, DWARF2_DEBUG_FRAME,
+			   &debug_frame.section, &debug_frame.buffer,
+			   &debug_frame.size);
 
-  set_comp_unit (objfile, unit.release ());
+  if (eh_frame.size != 0 && debug_frame.size == 0
+      && !gdb_bfd_requires_relocations (unit->abfd))
+    {
+      unit->dwarf_frame_section = eh_frame.section;
+      unit->dwarf_frame_buffer = eh_frame.buffer;
+      unit->dwarf_frame_size = eh_frame.size;
+
+      if (use_eh_frame_hdr (unit.get ()))
+	{
+	  set_comp_unit (objfile, unit.release ());
+	  return;
+	}
+    }
+
+  if (!background)
+    {
+      std::vector<std::string> warnings;
+
+      build_fde_table (gdbarch, unit.get (), objfile_name (objfile),
+		       eh_frame, debug_frame, warnings);
+      for (const std::string &msg : warnings)
+	warning ("%s", msg.c_str ());
+
+      set_comp_unit (objfile, unit.release ());
+      return;
+    }
+
+  comp_unit *u = unit.release ();
+  set_comp_unit (objfile, u);
+
+  std::string name = objfile_name (objfile);
+  u->building_fde_table = true;
+  u->fde_table_builder
+    = gdb::thread_pool::g_thread_pool->post_task ([=] ()
+      {
+	SCOPE_EXIT { bfd_thread_cleanup (); };
+
+	/* Ensure that complaints are handled correctly.  */
+	complaint_interceptor complaint_handler;
+
+	build_fde_table (gdbarch, u, name.c_str (), eh_frame, debug_frame,
+			 u->build_warnings);
+	u->build_complaints = complaint_handler.release ();
+      });
+}
+
+void
+dwarf2_build_frame_info (struct objfile *objfile)
+{
+  start_building_frame_info (objfile, false);
+}
+
+/* The new_objfile observer.  Start building OBJFILE's FDE table in the
+   background, so that it is likely to be ready by the time the first
+   unwind needs it.  */
+
+static void
+dwarf2_frame_new_objfile (struct objfile *objfile)
+{
+  if (objfile->obfd == nullptr)
+    return;
+
+  bfd *abfd = objfile->obfd.get ();
+  comp_unit *unit = (gdb_bfd_requires_relocations (abfd)
+		     ? dwarf2_frame_objfile_data.get (objfile)
+		     : dwarf2_frame_bfd_data.get (abfd));
+  if (unit != nullptr)
+    return;
+
+  start_building_frame_info (objfile, true);
 }
 
 /* Handle 'maintenance show dwarf unwinders'.  */
@@ -2283,6 +2642,9 @@ architecture that doesn't support them will have no effect."),
 			   &set_dwarf_cmdlist,
 			   &show_dwarf_cmdlist);
 
+  gdb::observers::new_objfile.attach (dwarf2_frame_new_objfile,
+				      "dwarf2-frame");
+
 #if GDB_SELF_TEST
   selftests::register_test_foreach_arch ("execute_cfa_program",
 					 selftests::execute_cfa_program_test);
@@ -30,6 +30,8 @@
 #include "dwarf2/dwz.h"
 #include "objfiles.h"
 #include "gdbsupport/selftest.h"
+#include "gdbsupport/version.h"
+#include <algorithm>
 #include <string>
 #include <stdlib.h>
 #include "run-on-main-thread.h"
@@ -185,6 +187,233 @@ index_cache_store_context::store () const
     }
 }
 
+/* Suffix of the demangled-name cache files.  */
+
+#define DEMANGLE_CACHE_SUFFIX ".gdb-demangle"
+
+/* Version of the demangled-name cache file format.  Bump this whenever
+   the format, or the way names are demangled, changes.  */
+
+#define DEMANGLE_CACHE_VERSION 2
+
+/* Header of a demangled-name cache file.  It is followed by N_ENTRIES
+   demangled_name_cache_record objects, sorted by hash, and then by
+   STRINGS_SIZE bytes of NUL-terminated strings.  */
+
+struct demangled_name_cache_header
+{
+  char magic[8];
+  uint32_t version;
+  /* demangler_version of the GDB that wrote the file.  */
+  uint32_t demangler_version;
+  /* Value of nr_languages in the GDB that wrote the file, since the
+     records store raw language enumerators.  */
+  uint32_t nr_languages;
+  uint32_t n_entries;
+  uint32_t strings_size;
+};
+
+static const char demangle_cache_magic[8] = "GDBDMGL";
+
+/* Return a key identifying the demanglers.  They are built along with
+   GDB, so a file written by another version of GDB may hold names
+   that this one would demangle differently.  */
+
+static uint32_t
+demangler_version ()
+{
+  return fast_hash (version, strlen (version));
+}
+
+/* See index-cache.h.  */
+
+demangled_name_cache::demangled_name_cache
+  (std::unique_ptr<index_cache_resource> resource,
+   gdb::array_view<const gdb_byte> contents)
+  : m_resource (std::move (resource))
+{
+  const demangled_name_cache_header *header
+    = (const demangled_name_cache_header *) contents.data ();
+  const gdb_byte *records = contents.data () + sizeof (*header);
+
+  m_entries = gdb::array_view<const demangled_name_cache_record>
+    ((const demangled_name_cache_record *) records, header->n_entries);
+  m_strings = gdb::array_view<const char>
+    ((const char *) (records
+		     + header->n_entries
+		       * sizeof (demangled_name_cache_record)),
+     header->strings_size);
+}
+
+/* See index-cache.h.  */
+
+bool
+demangled_name_cache::lookup (const char *mangled, hashval_t hash,
+			      enum language *language,
+			      const char **demangled) const
+{
+  auto iter
+    = std::lower_bound (m_entries.begin (), m_entries.end (), hash,
+			[] (const demangled_name_cache_record &record,
+			    hashval_t value)
+			{
+			  return record.hash < value;
+			});
+
+  for (; iter != m_entries.end () && iter->hash == hash; ++iter)
+    {
+      if (strcmp (&m_strings[iter->mangled], mangled) != 0)
+	continue;
+
+      *language = (enum language) iter->language;
+      *demangled = (iter->demangled == UINT32_MAX
+		    ? nullptr
+		    : &m_strings[iter->demangled]);
+      return true;
+    }
+
+  return false;
+}
+
+/* Return true if CONTENTS is a well-formed demangled-name cache file,
+   so that lookups into it can't go out of bounds.  */
+
+static bool
+demangled_name_cache_valid_p (gdb::array_view<const gdb_byte> contents)
+{
+  const demangled_name_cache_header *header
+    = (const demangled_name_cache_header *) contents.data ();
+
+  if (contents.size () < sizeof (*header)
+      || memcmp (header->magic, demangle_cache_magic,
+		 sizeof (header->magic)) != 0
+      || header->version != DEMANGLE_CACHE_VERSION
+      || header->demangler_version != demangler_version ()
+      || header->nr_languages != nr_languages)
+    return false;
+
+  size_t records_size = ((size_t) header->n_entries
+			 * sizeof (demangled_name_cache_record));
+  if (contents.size () - sizeof (*header) < records_size
+      || (contents.size () - sizeof (*header) - records_size
+	  != header->strings_size))
+    return false;
+
+  const char *strings
+    = (const char *) (contents.data () + sizeof (*header) + records_size);
+  if (header->strings_size == 0 || strings[header->strings_size - 1] != '\0')
+    return false;
+
+  const demangled_name_cache_record *records
+    = (const demangled_name_cache_record *) (contents.data ()
+					      + sizeof (*header));
+  for (uint32_t i = 0; i < header->n_entries; ++i)
+    {
+      if (records[i].mangled >= header->strings_size
+	  || (records[i].demangled != UINT32_MAX
+	      && records[i].demangled >= header->strings_size)
+	  || records[i].language >= nr_languages
+	  || (i > 0 && records[i - 1].hash > records[i].hash))
+	return false;
+    }
+
+  return true;
+}
+
+/* See index-cache.h.  */
+
+void
+index_cache::store_demangled_names
+  (const bfd_build_id *build_id,
+   std::vector<demangled_name_cache_entry> entries)
+{
+  if (!enabled () || m_dir.empty ())
+    return;
+
+  std::sort (entries.begin (), entries.end (),
+	     [] (const demangled_name_cache_entry &a,
+		 const demangled_name_cache_entry &b)
+	     {
+	       if (a.hash != b.hash)
+		 return a.hash < b.hash;
+	       return strcmp (a.mangled, b.mangled) < 0;
+	     });
+  entries.erase (std::unique (entries.begin (), entries.end (),
+			      [] (const demangled_name_cache_entry &a,
+				  const demangled_name_cache_entry &b)
+			      {
+				return (a.hash == b.hash
+					&& strcmp (a.mangled, b.mangled) == 0);
+			      }),
+		 entries.end ());
+
+  std::vector<demangled_name_cache_record> records;
+  records.reserve (entries.size ());
+  std::string strings;
+
+  for (const demangled_name_cache_entry &entry : entries)
+    {
+      demangled_name_cache_record record;
+      record.hash = entry.hash;
+      record.language = entry.language;
+      record.mangled = strings.size ();
+      strings.append (entry.mangled, strlen (entry.mangled) + 1);
+      if (entry.demangled == nullptr)
+	record.demangled = UINT32_MAX;
+      else
+	{
+	  record.demangled = strings.size ();
+	  strings.append (entry.demangled, strlen (entry.demangled) + 1);
+	}
+      records.push_back (record);
+    }
+
+  /* Offsets are 32-bit; give up on absurdly large symbol tables.  */
+  if (strings.empty () || strings.size () >= UINT32_MAX)
+    return;
+
+  demangled_name_cache_header header {};
+  memcpy (header.magic, demangle_cache_magic, sizeof (header.magic));
+  header.version = DEMANGLE_CACHE_VERSION;
+  header.demangler_version = demangler_version ();
+  header.nr_languages = nr_languages;
+  header.n_entries = records.size ();
+  header.strings_size = strings.size ();
+
+  std::string build_id_str = build_id_to_string (build_id);
+
+  try
+    {
+      index_cache_debug ("writing demangled names for build id %s",
+			 build_id_str.c_str ());
+
+      if (!mkdir_recursive (m_dir.c_str ()))
+	error (_("could not make cache directory: %s"),
+	       safe_strerror (errno));
+
+      index_wip_file wip (m_dir.c_str (), build_id_str.c_str (),
+			  DEMANGLE_CACHE_SUFFIX);
+
+      FILE *file = wip.out_file.get ();
+      if (fwrite (&header, sizeof (header), 1, file) != 1
+	  || fwrite (records.data (), sizeof (demangled_name_cache_record),
+		     records.size (), file) != records.size ()
+	  || fwrite (strings.data (), 1, strings.size (), file)
+	     != strings.size ())
+	error (_("couldn't write demangled-name cache"));
+
+      if (fflush (file) != 0)
+	error (_("couldn't flush demangled-name cache"));
+
+      wip.finalize ();
+    }
+  catch (const gdb_exception_error &except)
+    {
+      index_cache_debug ("couldn't store demangled names for build id %s: %s",
+			 build_id_str.c_str (), except.what ());
+    }
+}
+
 #if HAVE_SYS_MMAN_H
 
 /* Hold the resources for an mmapped index file.  */
@@ -244,6 +473,46 @@ index_cache::lookup_gdb_index (const bfd_build_id *build_id,
   return {};
 }
 
+/* See index-cache.h.  */
+
+std::unique_ptr<demangled_name_cache>
+index_cache::lookup_demangled_names (const bfd_build_id *build_id)
+{
+  if (!enabled () || m_dir.empty ())
+    return nullptr;
+
+  std::string filename = make_index_filename (build_id,
+					      DEMANGLE_CACHE_SUFFIX);
+
+  try
+    {
+      index_cache_debug ("trying to read %s", filename.c_str ());
+
+      std::unique_ptr<index_cache_resource_mmap> mmap_resource
+	(new index_cache_resource_mmap (filename.c_str ()));
+      gdb::array_view<const gdb_byte> contents
+	((const gdb_byte *) mmap_resource->mapping.get (),
+	 mmap_resource->mapping.size ());
+
+      if (!demangled_name_cache_valid_p (contents))
+	{
+	  index_cache_debug ("ignoring invalid demangled-name cache %s",
+			     filename.c_str ());
+	  return nullptr;
+	}
+
+      return std::make_unique<demangled_name_cache>
+	(std::move (mmap_resource), contents);
+    }
+  catch (const gdb_exception_error &except)
+    {
+      index_cache_debug ("couldn't read %s: %s",
+			 filename.c_str (), except.what ());
+    }
+
+  return nullptr;
+}
+
 #else /* !HAVE_SYS_MMAN_H */
 
 /* See dwarf-index-cache.h.  This is a no-op on unsupported systems.  */
@@ -255,6 +524,14 @@ index_cache::lookup_gdb_index (const bfd_build_id *build_id,
   return {};
 }
 
+/* See index-cache.h.  This is a no-op on unsupported systems.  */
+
+std::unique_ptr<demangled_name_cache>
+index_cache::lookup_demangled_names (const bfd_build_id *build_id)
+{
+  return nullptr;
+}
+
 #endif
 
 /* See dwarf-index-cache.h.  */
@@ -62,6 +62,65 @@ struct index_cache_store_context
   std::optional<std::string> m_dwz_build_id_str;
 };
 
+/* One entry of a demangled-name cache file, as passed to
+   index_cache::store_demangled_names.  */
+
+struct demangled_name_cache_entry
+{
+  /* The linkage name of the symbol.  */
+  const char *mangled;
+
+  /* The fast_hash of MANGLED.  */
+  hashval_t hash;
+
+  /* The language that was found for MANGLED.  */
+  enum language language;
+
+  /* The demangled form of MANGLED, or nullptr if it does not
+     demangle.  */
+  const char *demangled;
+};
+
+/* The on-disk form of a demangled_name_cache_entry.  MANGLED and
+   DEMANGLED are offsets into the string pool that follows the records;
+   DEMANGLED is UINT32_MAX when the name does not demangle.  The file is
+   in host byte order, as it is only meant to be read back by the host
+   that wrote it.  */
+
+struct demangled_name_cache_record
+{
+  uint32_t hash;
+  uint32_t mangled;
+  uint32_t demangled;
+  uint32_t language;
+};
+
+/* The demangled names of the minimal symbols of one objfile, as loaded
+   from the cache.  This is read-only and may be used by several threads
+   at once.  */
+
+class demangled_name_cache
+{
+public:
+  demangled_name_cache (std::unique_ptr<index_cache_resource> resource,
+			gdb::array_view<const gdb_byte> contents);
+
+  /* Look up MANGLED, whose fast_hash is HASH.  On success, set *LANGUAGE
+     and *DEMANGLED (nullptr if MANGLED does not demangle) and return
+     true.  The returned string is valid for the lifetime of this
+     object.  */
+  bool lookup (const char *mangled, hashval_t hash,
+	       enum language *language, const char **demangled) const;
+
+private:
+  /* The mapped file.  */
+  std::unique_ptr<index_cache_resource> m_resource;
+
+  /* The entries, sorted by hash, and the string pool they refer to.  */
+  gdb::array_view<const demangled_name_cache_record> m_entries;
+  gdb::array_view<const char> m_strings;
+};
+
 /* Class to manage the access to the DWARF index cache.  */
 
 class index_cache
@@ -93,6 +152,17 @@ class index_cache
   lookup_gdb_index (const bfd_build_id *build_id,
 		    std::unique_ptr<index_cache_resource> *resource);
 
+  /* Look for a demangled-name cache file matching BUILD_ID.  Return
+     nullptr if there is none, or if it is not valid.  */
+  std::unique_ptr<demangled_name_cache>
+  lookup_demangled_names (const bfd_build_id *build_id);
+
+  /* Write the demangled-name cache file for BUILD_ID, holding ENTRIES.
+     Errors are not reported, since the cache is only an
+     optimization.  */
+  void store_demangled_names (const bfd_build_id *build_id,
+			      std::vector<demangled_name_cache_entry> entries);
+
   /* Return the number of cache hits.  */
   unsigned int n_hits () const
   { return m_n_hits; }
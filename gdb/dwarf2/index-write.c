@@ -1476,67 +1476,50 @@ write_debug_names (dwarf2_per_bfd *per_bfd, cooked_index *table,
   assert_file_size (out_file, expected_bytes);
 }
 
-/* This represents an index file being written (work-in-progress).
-
-   The data is initially written to a temporary file.  When the finalize method
-   is called, the file is closed and moved to its final location.
-
-   On failure (if this object is being destroyed with having called finalize),
-   the temporary file is closed and deleted.  */
+/* See dwarf-index-write.h.  */
 
-struct index_wip_file
+index_wip_file::index_wip_file (const char *dir, const char *basename,
+				const char *suffix)
 {
-  index_wip_file (const char *dir, const char *basename,
-		  const char *suffix)
-  {
-    /* Validate DIR is a valid directory.  */
-    struct stat buf;
-    if (stat (dir, &buf) == -1)
-      perror_with_name (string_printf (_("`%s'"), dir).c_str ());
-    if ((buf.st_mode & S_IFDIR) != S_IFDIR)
-      error (_("`%s': Is not a directory."), dir);
+  /* Validate DIR is a valid directory.  */
+  struct stat buf;
+  if (stat (dir, &buf) == -1)
+    perror_with_name (string_printf (_("`%s'"), dir).c_str ());
+  if ((buf.st_mode & S_IFDIR) != S_IFDIR)
+    error (_("`%s': Is not a directory."), dir);
 
-    filename = (std::string (dir) + SLASH_STRING + basename
-		+ suffix);
+  filename = (std::string (dir) + SLASH_STRING + basename
+	      + suffix);
 
-    filename_temp = make_temp_filename (filename);
+  filename_temp = make_temp_filename (filename);
 
-    scoped_fd out_file_fd = gdb_mkostemp_cloexec (filename_temp.data (),
-						  O_BINARY);
-    if (out_file_fd.get () == -1)
-      perror_with_name (string_printf (_("couldn't open `%s'"),
-				       filename_temp.data ()).c_str ());
+  scoped_fd out_file_fd = gdb_mkostemp_cloexec (filename_temp.data (),
+						O_BINARY);
+  if (out_file_fd.get () == -1)
+    perror_with_name (string_printf (_("couldn't open `%s'"),
+				     filename_temp.data ()).c_str ());
 
-    out_file = out_file_fd.to_file ("wb");
+  out_file = out_file_fd.to_file ("wb");
 
-    if (out_file == nullptr)
-      error (_("Can't open `%s' for writing"), filename_temp.data ());
-
-    unlink_file.emplace (filename_temp.data ());
-  }
-
-  void finalize ()
-  {
-    /* We want to keep the file.  */
-    unlink_file->keep ();
+  if (out_file == nullptr)
+    error (_("Can't open `%s' for writing"), filename_temp.data ());
 
-    /* Close and move the str file in place.  */
-    unlink_file.reset ();
-    if (rename (filename_temp.data (), filename.c_str ()) != 0)
-      perror_with_name (("rename"));
-  }
+  unlink_file.emplace (filename_temp.data ());
+}
 
-  std::string filename;
-  gdb::char_vector filename_temp;
+/* See dwarf-index-write.h.  */
 
-  /* Order matters here; we want FILE to be closed before
-     FILENAME_TEMP is unlinked, because on MS-Windows one cannot
-     delete a file that is still open.  So, we wrap the unlinker in an
-     optional and emplace it once we know the file name.  */
-  std::optional<gdb::unlinker> unlink_file;
+void
+index_wip_file::finalize ()
+{
+  /* We want to keep the file.  */
+  unlink_file->keep ();
 
-  gdb_file_up out_file;
-};
+  /* Close and move the str file in place.  */
+  unlink_file.reset ();
+  if (rename (filename_temp.data (), filename.c_str ()) != 0)
+    perror_with_name (("rename"));
+}
 
 /* See dwarf-index-write.h.  */
 
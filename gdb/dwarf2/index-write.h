@@ -22,6 +22,9 @@
 
 #include "dwarf2/read.h"
 #include "dwarf2/public.h"
+#include "gdbsupport/filestuff.h"
+#include "gdbsupport/gdb_unlinker.h"
+#include "gdbsupport/pathstuff.h"
 
 /* Create index files for OBJFILE in the directory DIR.
 
@@ -36,4 +39,34 @@ extern void write_dwarf_index
   (dwarf2_per_bfd *per_bfd, const char *dir, const char *basename,
    const char *dwz_basename, dw_index_kind index_kind);
 
+/* This represents an index file being written (work-in-progress).
+
+   The data is initially written to a temporary file.  When the finalize method
+   is called, the file is closed and moved to its final location.
+
+   On failure (if this object is being destroyed with having called finalize),
+   the temporary file is closed and deleted.  */
+
+struct index_wip_file
+{
+  /* Create a temporary file that will become DIR/BASENAME SUFFIX once
+     finalized.  Throw an exception on failure.  */
+  index_wip_file (const char *dir, const char *basename,
+		  const char *suffix);
+
+  /* Close the temporary file and move it to its final location.  */
+  void finalize ();
+
+  std::string filename;
+  gdb::char_vector filename_temp;
+
+  /* Order matters here; we want FILE to be closed before
+     FILENAME_TEMP is unlinked, because on MS-Windows one cannot
+     delete a file that is still open.  So, we wrap the unlinker in an
+     optional and emplace it once we know the file name.  */
+  std::optional<gdb::unlinker> unlink_file;
+
+  gdb_file_up out_file;
+};
+
 #endif /* DWARF_INDEX_WRITE_H */
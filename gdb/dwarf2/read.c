@@ -96,6 +96,8 @@
 #include "gdbsupport/thread-pool.h"
 #include "run-on-main-thread.h"
 #include "dwarf2/parent-map.h"
+#include "frame.h"
+#include "observable.h"
 
 /* When == 1, print basic high level tracing messages.
    When > 1, be more verbose.
@@ -377,6 +379,10 @@ struct dwo_file
   /* Table of TUs in the file.
      Each element is a struct dwo_unit.  */
   htab_up tus;
+
+  /* Storage for the dwo_unit objects of CUS and TUS.  This is not the
+     per-BFD obstack because DWO files are read in worker threads.  */
+  auto_obstack obstack;
 };
 
 /* These sections are what may appear in a DWP file.  */
@@ -607,6 +613,15 @@ class cutu_reader : public die_reader_specs
      for dummy CUs.  */
   void keep ();
 
+  /* Release the new CU, transferring ownership to the caller instead
+     of putting it on the chain.  This cannot be done for dummy
+     CUs.  */
+  std::unique_ptr<dwarf2_cu> release_cu ()
+  {
+    gdb_assert (!dummy_p);
+    return std::move (m_new_cu);
+  }
+
   /* Release the abbrev table, transferring ownership to the
      caller.  */
   abbrev_table_up release_abbrev_table ()
@@ -750,6 +765,21 @@ show_dwarf_synchronous (struct ui_file *file, int from_tty,
 	      value);
 }
 
+/* The number of frames, counting from the innermost one, whose CUs
+   are read in the background when the inferior stops.  Zero disables
+   prefetching.  */
+static unsigned int dwarf_prefetch_frames = 0;
+
+/* "Show" callback for "maint set dwarf prefetch-frames".  */
+static void
+show_dwarf_prefetch_frames (struct ui_file *file, int from_tty,
+			    struct cmd_list_element *c, const char *value)
+{
+  gdb_printf (file, _("The number of frames whose DWARF compilation "
+		      "units are prefetched is %s.\n"),
+	      value);
+}
+
 /* local function prototypes */
 
 static void dwarf2_find_base_address (struct die_info *die,
@@ -1064,6 +1094,8 @@ static void load_full_comp_unit (dwarf2_per_cu_data *per_cu,
 				 bool skip_partial,
 				 enum language pretend_language);
 
+static void read_comp_unit_dies (cutu_reader *reader);
+
 static void process_full_comp_unit (dwarf2_cu *cu,
 				    enum language pretend_language);
 
@@ -3427,7 +3459,7 @@ create_debug_type_hash_table (dwarf2_per_objfile *per_objfile,
       if (types_htab == NULL)
 	types_htab = allocate_dwo_unit_table ();
 
-      dwo_tu = OBSTACK_ZALLOC (&per_objfile->per_bfd->obstack, dwo_unit);
+      dwo_tu = OBSTACK_ZALLOC (&dwo_file->obstack, dwo_unit);
       dwo_tu->dwo_file = dwo_file;
       dwo_tu->signature = header.signature;
       dwo_tu->type_offset_in_tu = header.type_cu_offset_in_tu;
@@ -3888,13 +3920,6 @@ lookup_dwo_id (struct dwarf2_cu *cu, struct die_info* comp_unit_die)
 static struct dwo_unit *
 lookup_dwo_unit (dwarf2_cu *cu, die_info *comp_unit_die, const char *dwo_name)
 {
-#if CXX_STD_THREAD
-  /* We need a lock here to handle the DWO hash table.  */
-  static std::mutex dwo_lock;
-
-  std::lock_guard<std::mutex> guard (dwo_lock);
-#endif
-
   dwarf2_per_cu_data *per_cu = cu->per_cu;
   struct dwo_unit *dwo_unit;
   const char *comp_dir;
@@ -4714,29 +4739,24 @@ print_tu_stats (dwarf2_per_objfile *per_objfile)
 			   tu_stats->nr_all_type_units_reallocs);
 }
 
-struct skeleton_data
-{
-  dwarf2_per_objfile *per_objfile;
-  cooked_index_storage *storage;
-};
-
 /* Traversal function for process_skeletonless_type_unit.
-   Read a TU in a DWO file and build partial symbols for it.  */
+   Create the signatured_type of a TU in a DWO file, if it isn't known
+   yet.  It is read in later, see process_skeletonless_type_units.  */
 
 static int
 process_skeletonless_type_unit (void **slot, void *info)
 {
   struct dwo_unit *dwo_unit = (struct dwo_unit *) *slot;
-  skeleton_data *data = (skeleton_data *) info;
+  dwarf2_per_objfile *per_objfile = (dwarf2_per_objfile *) info;
 
-  /* If this TU doesn't exist in the global table, add it and read it in.  */
+  /* If this TU doesn't exist in the global table, add it.  */
 
-  if (data->per_objfile->per_bfd->signatured_types == NULL)
-    data->per_objfile->per_bfd->signatured_types
+  if (per_objfile->per_bfd->signatured_types == NULL)
+    per_objfile->per_bfd->signatured_types
       = allocate_signatured_type_table ();
 
   signatured_type find_entry (dwo_unit->signature);
-  slot = htab_find_slot (data->per_objfile->per_bfd->signatured_types.get (),
+  slot = htab_find_slot (per_objfile->per_bfd->signatured_types.get (),
 			 &find_entry, INSERT);
   /* If we've already seen this type there's nothing to do.  What's happening
      is we're doing our own version of comdat-folding here.  */
@@ -4746,15 +4766,10 @@ process_skeletonless_type_unit (void **slot, void *info)
   /* This does the job that create_all_units would have done for
      this TU.  */
   signatured_type *entry
-    = add_type_unit (data->per_objfile, dwo_unit->signature, slot);
-  fill_in_sig_entry_from_dwo_entry (data->per_objfile, entry, dwo_unit);
+    = add_type_unit (per_objfile, dwo_unit->signature, slot);
+  fill_in_sig_entry_from_dwo_entry (per_objfile, entry, dwo_unit);
   *slot = entry;
 
-  /* This does the job that build_type_psymtabs would have done.  */
-  cutu_reader reader (entry, data->per_objfile, nullptr, nullptr, false);
-  if (!reader.dummy_p)
-    build_type_psymtabs_reader (&reader, data->storage);
-
   return 1;
 }
 
@@ -4774,13 +4789,18 @@ process_dwo_file_for_skeletonless_type_units (void **slot, void *info)
 
 /* Scan all TUs of DWO files, verifying we've processed them.
    This is needed in case a TU was emitted without its skeleton.
-   Note: This can't be done until we know what all the DWO files are.  */
+   Note: This can't be done until we know what all the DWO files are.
+
+   The TUs that weren't seen yet are appended to the per-BFD list of
+   units; the caller is responsible for building partial symbols for
+   them, which is the expensive part and can be done in parallel.  */
 
 static void
-process_skeletonless_type_units (dwarf2_per_objfile *per_objfile,
-				 cooked_index_storage *storage)
+process_skeletonless_type_units (dwarf2_per_objfile *per_objfile)
 {
-  skeleton_data data { per_objfile, storage };
+#if CXX_STD_THREAD
+  std::lock_guard<std::mutex> guard (per_objfile->per_bfd->dwo_lock);
+#endif
 
   /* Skeletonless TUs in DWP files without .gdb_index is not supported yet.  */
   if (get_dwp_file (per_objfile) == NULL
@@ -4788,7 +4808,7 @@ process_skeletonless_type_units (dwarf2_per_objfile *per_objfile,
     {
       htab_traverse_noresize (per_objfile->per_bfd->dwo_files.get (),
 			      process_dwo_file_for_skeletonless_type_units,
-			      &data);
+			      per_objfile);
     }
 }
 
@@ -4822,6 +4842,11 @@ class cooked_index_debug_info : public cooked_index_worker
       print_tu_stats (m_per_objfile);
   }
 
+  /* After the last CU-scanning task has finished, this function
+     finds the type units of the DWO files that have no skeleton, and
+     scans them in worker threads.  */
+  void process_skeletonless_tus ();
+
   /* After the last DWARF-reading task has finished, this function
      does the remaining work to finish the scan.  */
   void done_reading ();
@@ -4829,6 +4854,12 @@ class cooked_index_debug_info : public cooked_index_worker
   /* An iterator for the comp units.  */
   typedef std::vector<dwarf2_per_cu_data_up>::iterator unit_iterator;
 
+  /* Split the units in [FIRST, END) into batches of roughly equal
+     size, and scan each batch in a worker thread using process_cus.
+     DONE is called once all of them are finished.  */
+  void process_units (unit_iterator first, unit_iterator end,
+		      std::function<void ()> &&done);
+
   /* Process a batch of CUs.  This may be called multiple times in
      separate threads.  TASK_NUMBER indicates which task this is --
      the result is stored in that slot of M_RESULTS.  */
@@ -4871,6 +4902,23 @@ cooked_index_debug_info::process_cus (size_t task_number, unit_iterator first,
 					thread_storage.release_parent_map ());
 }
 
+void
+cooked_index_debug_info::process_skeletonless_tus ()
+{
+  std::vector<dwarf2_per_cu_data_up> &all_units
+    = m_per_objfile->per_bfd->all_units;
+  size_t first_new = all_units.size ();
+
+  /* This has to wait until we read the CUs, we need the list of DWOs.  */
+  process_skeletonless_type_units (m_per_objfile);
+
+  process_units (all_units.begin () + first_new, all_units.end (),
+		 [this] ()
+		 {
+		   this->done_reading ();
+		 });
+}
+
 void
 cooked_index_debug_info::done_reading ()
 {
@@ -4883,9 +4931,6 @@ cooked_index_debug_info::done_reading ()
       m_all_parents_map.add_map (std::get<3> (one_result));
     }
 
-  /* This has to wait until we read the CUs, we need the list of DWOs.  */
-  process_skeletonless_type_units (m_per_objfile, &m_index_storage);
-
   indexes.push_back (m_index_storage.release ());
   indexes.shrink_to_fit ();
 
@@ -4914,6 +4959,18 @@ cooked_index_debug_info::do_reading ()
 			       m_index_storage.get_addrmap (),
 			       &m_warnings);
 
+  process_units (per_bfd->all_units.begin (), per_bfd->all_units.end (),
+		 [this] ()
+		 {
+		   this->process_skeletonless_tus ();
+		 });
+}
+
+void
+cooked_index_debug_info::process_units (unit_iterator first,
+					unit_iterator end,
+					std::function<void ()> &&done)
+{
   /* We want to balance the load between the worker threads.  This is
      done by using the size of each CU as a rough estimate of how
      difficult it will be to operate on.  This isn't ideal -- for
@@ -4922,8 +4979,8 @@ cooked_index_debug_info::do_reading ()
      heuristic works well for typical compiler output.  */
 
   size_t total_size = 0;
-  for (const auto &per_cu : per_bfd->all_units)
-    total_size += per_cu->length ();
+  for (auto iter = first; iter != end; ++iter)
+    total_size += (*iter)->length ();
 
   /* How many worker threads we plan to use.  We may not actually use
      this many.  We use 1 as the minimum to avoid division by zero,
@@ -4937,14 +4994,12 @@ cooked_index_debug_info::do_reading ()
     = std::max (total_size / n_worker_threads, (size_t) 1);
 
   /* Work is done in a task group.  */
-  gdb::task_group workers ([this] ()
-  {
-    this->done_reading ();
-  });
+  gdb::task_group workers (std::move (done));
 
-  auto end = per_bfd->all_units.end ();
+  /* The results of these tasks go after those of any earlier batch.  */
+  const size_t first_task = m_results.size ();
   size_t task_count = 0;
-  for (auto iter = per_bfd->all_units.begin (); iter != end; )
+  for (auto iter = first; iter != end; )
     {
       auto last = iter;
       /* Put all remaining CUs into the last task.  */
@@ -4960,14 +5015,14 @@ cooked_index_debug_info::do_reading ()
       gdb_assert (iter != last);
       workers.add_task ([=] ()
 	{
-	  process_cus (task_count, iter, last);
+	  process_cus (first_task + task_count, iter, last);
 	});
 
       ++task_count;
       iter = last;
     }
 
-  m_results.resize (task_count);
+  m_results.resize (first_task + task_count);
   workers.start ();
 }
 
@@ -5484,12 +5539,48 @@ load_full_comp_unit (dwarf2_per_cu_data *this_cu,
 {
   gdb_assert (! this_cu->is_debug_types);
 
+  if (existing_cu == nullptr)
+    {
+      /* The DIEs may already have been read by a worker thread.  */
+      std::unique_ptr<dwarf2_cu> cu = per_objfile->take_prefetched_cu (this_cu);
+      if (cu != nullptr)
+	{
+	  if (skip_partial && cu->dies->tag == DW_TAG_partial_unit)
+	    return;
+
+	  prepare_one_comp_unit (cu.get (), cu->dies, pretend_language);
+	  per_objfile->set_cu (this_cu, std::move (cu));
+	  return;
+	}
+    }
+
   cutu_reader reader (this_cu, per_objfile, NULL, existing_cu, skip_partial);
   if (reader.dummy_p)
     return;
 
-  struct dwarf2_cu *cu = reader.cu;
-  const gdb_byte *info_ptr = reader.info_ptr;
+  read_comp_unit_dies (&reader);
+
+  /* We try not to read any attributes in this function, because not
+     all CUs needed for references have been loaded yet, and symbol
+     table processing isn't initialized.  But we have to set the CU language,
+     or we won't be able to build types correctly.
+     Similarly, if we do not read the producer, we can not apply
+     producer-specific interpretation.  */
+  prepare_one_comp_unit (reader.cu, reader.cu->dies, pretend_language);
+
+  reader.keep ();
+}
+
+/* Read the DIEs of the CU that READER is positioned on, storing them
+   in the CU.  This does not read any attributes, so it is safe to
+   call from a worker thread as long as READER's CU is not yet
+   installed in its dwarf2_per_objfile.  */
+
+static void
+read_comp_unit_dies (cutu_reader *reader)
+{
+  struct dwarf2_cu *cu = reader->cu;
+  const gdb_byte *info_ptr = reader->info_ptr;
 
   gdb_assert (cu->die_hash == NULL);
   cu->die_hash =
@@ -5501,22 +5592,12 @@ load_full_comp_unit (dwarf2_per_cu_data *this_cu,
 			  hashtab_obstack_allocate,
 			  dummy_obstack_deallocate);
 
-  if (reader.comp_unit_die->has_children)
-    reader.comp_unit_die->child
-      = read_die_and_siblings (&reader, reader.info_ptr,
-			       &info_ptr, reader.comp_unit_die);
-  cu->dies = reader.comp_unit_die;
+  if (reader->comp_unit_die->has_children)
+    reader->comp_unit_die->child
+      = read_die_and_siblings (reader, reader->info_ptr,
+			       &info_ptr, reader->comp_unit_die);
+  cu->dies = reader->comp_unit_die;
   /* comp_unit_die is not stored in die_hash, no need.  */
-
-  /* We try not to read any attributes in this function, because not
-     all CUs needed for references have been loaded yet, and symbol
-     table processing isn't initialized.  But we have to set the CU language,
-     or we won't be able to build types correctly.
-     Similarly, if we do not read the producer, we can not apply
-     producer-specific interpretation.  */
-  prepare_one_comp_unit (cu, cu->dies, pretend_language);
-
-  reader.keep ();
 }
 
 /* Add a DIE to the delayed physname list.  */
@@ -7852,8 +7933,7 @@ create_cus_hash_table (dwarf2_per_objfile *per_objfile,
       if (cus_htab == NULL)
 	cus_htab = allocate_dwo_unit_table ();
 
-      dwo_unit = OBSTACK_ZALLOC (&per_bfd->obstack,
-				 struct dwo_unit);
+      dwo_unit = OBSTACK_ZALLOC (&dwo_file.obstack, struct dwo_unit);
       *dwo_unit = read_unit;
       slot = htab_find_slot (cus_htab.get (), dwo_unit, INSERT);
       gdb_assert (slot != NULL);
@@ -9448,6 +9528,49 @@ get_dwp_file (dwarf2_per_objfile *per_objfile)
   return per_objfile->per_bfd->dwp_file.get ();
 }
 
+/* Return the DWO file DWO_NAME referenced by CU, opening it and reading
+   the table of its CUs/TUs if this wasn't done yet.  Return NULL if the
+   file can't be found.
+
+   This is called from the worker threads scanning the skeleton CUs, so
+   the file is opened and read without holding the DWO lock: only the
+   accesses to the per-BFD table of DWO files are serialized.  If two
+   threads open the same file at the same time, the first one to finish
+   wins and the other copy is discarded.  */
+
+static struct dwo_file *
+lookup_or_open_dwo_file (dwarf2_cu *cu, const char *dwo_name,
+			 const char *comp_dir)
+{
+  dwarf2_per_objfile *per_objfile = cu->per_objfile;
+
+  {
+#if CXX_STD_THREAD
+    std::lock_guard<std::mutex> guard (per_objfile->per_bfd->dwo_lock);
+#endif
+
+    void **slot = lookup_dwo_file_slot (per_objfile, dwo_name, comp_dir);
+    if (*slot != NULL)
+      return (struct dwo_file *) *slot;
+  }
+
+  /* Read in the file and build a table of the CUs/TUs it contains.  */
+  dwo_file_up dwo_file (open_and_init_dwo_file (cu, dwo_name, comp_dir));
+  if (dwo_file == nullptr)
+    return NULL;
+
+#if CXX_STD_THREAD
+  std::lock_guard<std::mutex> guard (per_objfile->per_bfd->dwo_lock);
+#endif
+
+  /* The table may have been resized meanwhile, so look the slot up
+     again.  */
+  void **slot = lookup_dwo_file_slot (per_objfile, dwo_name, comp_dir);
+  if (*slot == NULL)
+    *slot = dwo_file.release ();
+  return (struct dwo_file *) *slot;
+}
+
 /* Subroutine of lookup_dwo_comp_unit, lookup_dwo_type_unit.
    Look up the CU/TU with signature SIGNATURE, either in DWO file DWO_NAME
    or in the DWP file for the objfile, referenced by THIS_UNIT.
@@ -9471,7 +9594,6 @@ lookup_dwo_cutu (dwarf2_cu *cu, const char *dwo_name, const char *comp_dir,
   dwarf2_per_objfile *per_objfile = cu->per_objfile;
   struct objfile *objfile = per_objfile->objfile;
   const char *kind = is_debug_types ? "TU" : "CU";
-  void **dwo_file_slot;
   struct dwo_file *dwo_file;
   struct dwp_file *dwp_file;
 
@@ -9480,7 +9602,13 @@ lookup_dwo_cutu (dwarf2_cu *cu, const char *dwo_name, const char *comp_dir,
      look for the original DWO file.  It makes gdb behave differently
      depending on whether one is debugging in the build tree.  */
 
-  dwp_file = get_dwp_file (per_objfile);
+  {
+#if CXX_STD_THREAD
+    std::lock_guard<std::mutex> guard (per_objfile->per_bfd->dwo_lock);
+#endif
+
+    dwp_file = get_dwp_file (per_objfile);
+  }
   if (dwp_file != NULL)
     {
       const struct dwp_hash_table *dwp_htab =
@@ -9488,9 +9616,17 @@ lookup_dwo_cutu (dwarf2_cu *cu, const char *dwo_name, const char *comp_dir,
 
       if (dwp_htab != NULL)
 	{
+#if CXX_STD_THREAD
+	  /* The virtual DWO files and units of a DWP file are created
+	     lazily, so the lookup must be done with the lock held.  */
+	  std::unique_lock<std::mutex> guard (per_objfile->per_bfd->dwo_lock);
+#endif
 	  struct dwo_unit *dwo_cutu =
 	    lookup_dwo_unit_in_dwp (per_objfile, dwp_file, comp_dir, signature,
 				    is_debug_types);
+#if CXX_STD_THREAD
+	  guard.unlock ();
+#endif
 
 	  if (dwo_cutu != NULL)
 	    {
@@ -9506,14 +9642,8 @@ lookup_dwo_cutu (dwarf2_cu *cu, const char *dwo_name, const char *comp_dir,
     {
       /* No DWP file, look for the DWO file.  */
 
-      dwo_file_slot = lookup_dwo_file_slot (per_objfile, dwo_name, comp_dir);
-      if (*dwo_file_slot == NULL)
-	{
-	  /* Read in the file and build a table of the CUs/TUs it contains.  */
-	  *dwo_file_slot = open_and_init_dwo_file (cu, dwo_name, comp_dir);
-	}
       /* NOTE: This will be NULL if unable to open the file.  */
-      dwo_file = (struct dwo_file *) *dwo_file_slot;
+      dwo_file = lookup_or_open_dwo_file (cu, dwo_name, comp_dir);
 
       if (dwo_file != NULL)
 	{
@@ -21703,8 +21833,117 @@ dwarf2_per_objfile::remove_cu (dwarf2_per_cu_data *per_cu)
   m_dwarf2_cus.erase (it);
 }
 
+/* Read the DIEs of PER_CU, in the context of PER_OBJFILE.  This is
+   run in a worker thread by dwarf2_per_objfile::prefetch_cu.  */
+
+static dwarf2_prefetched_cu
+read_prefetched_cu (dwarf2_per_cu_data *per_cu,
+		    dwarf2_per_objfile *per_objfile)
+{
+  SCOPE_EXIT { bfd_thread_cleanup (); };
+
+  /* Ensure that complaints are handled correctly.  */
+  complaint_interceptor complaint_handler;
+
+  dwarf2_prefetched_cu result;
+  try
+    {
+      /* Passing an abbrev cache tells cutu_reader that it is running
+	 in a worker thread.  */
+      abbrev_cache cache;
+      cutu_reader reader (per_cu, per_objfile, nullptr, nullptr, false,
+			  &cache);
+      if (!reader.dummy_p)
+	{
+	  read_comp_unit_dies (&reader);
+	  result.cu = reader.release_cu ();
+	}
+    }
+  catch (const gdb_exception &except)
+    {
+      /* Prefetching is only an optimization.  The CU will be read
+	 again on the main thread when it is needed, and any error
+	 reported at that point.  */
+      return {};
+    }
+
+  result.complaints = complaint_handler.release ();
+  return result;
+}
+
+/* See read.h.  */
+
+void
+dwarf2_per_objfile::prefetch_cu (dwarf2_per_cu_data *per_cu)
+{
+  gdb_assert (is_main_thread ());
+
+  if (per_cu->is_debug_types
+      || symtab_set_p (per_cu)
+      || get_cu (per_cu) != nullptr
+      || m_prefetched_cus.find (per_cu) != m_prefetched_cus.end ())
+    return;
+
+  /* Don't let unused results pile up.  A single stop never asks for
+     more than dwarf_prefetch_frames CUs.  */
+  if (m_prefetched_cus.size () >= std::max (dwarf_prefetch_frames, 1u))
+    discard_prefetched_cus ();
+
+  /* The worker only reads sections that are mapped here, so make
+     sure they have been read in on the main thread first.  This is
+     cheap if they already are.  */
+  per_bfd->map_info_sections (objfile);
+
+  dwarf_read_debug_printf ("Prefetching CU at offset %s",
+			   sect_offset_str (per_cu->sect_off));
+
+  dwarf2_per_objfile *per_objfile = this;
+  m_prefetched_cus[per_cu]
+    = (gdb::thread_pool::g_thread_pool->post_task<dwarf2_prefetched_cu>
+       ([=] ()
+	 {
+	   return read_prefetched_cu (per_cu, per_objfile);
+	 }));
+}
+
+/* See read.h.  */
+
+std::unique_ptr<dwarf2_cu>
+dwarf2_per_objfile::take_prefetched_cu (dwarf2_per_cu_data *per_cu)
+{
+  if (m_prefetched_cus.empty ())
+    return nullptr;
+
+  /* Worker threads may read sections that the main thread is about to
+     read as well, so let all of them finish first.  */
+  for (auto &pair : m_prefetched_cus)
+    pair.second.wait ();
+
+  auto it = m_prefetched_cus.find (per_cu);
+  if (it == m_prefetched_cus.end ())
+    return nullptr;
+
+  dwarf2_prefetched_cu result = it->second.get ();
+  m_prefetched_cus.erase (it);
+
+  re_emit_complaints (result.complaints);
+  return std::move (result.cu);
+}
+
+/* See read.h.  */
+
+void
+dwarf2_per_objfile::discard_prefetched_cus ()
+{
+  for (auto &pair : m_prefetched_cus)
+    pair.second.wait ();
+  m_prefetched_cus.clear ();
+}
+
 dwarf2_per_objfile::~dwarf2_per_objfile ()
 {
+  /* The worker threads refer to this object, so wait for them.  */
+  discard_prefetched_cus ();
   remove_all_cus ();
 }
 
@@ -21887,6 +22126,60 @@ get_die_type (struct die_info *die, struct dwarf2_cu *cu)
   return get_die_type_at_offset (die->sect_off, cu->per_cu, cu->per_objfile);
 }
 
+/* A normal_stop observer that starts reading, in worker threads, the
+   DIEs of the CUs covering the innermost "maint set dwarf
+   prefetch-frames" frames of the current backtrace.  Commands like
+   "up", "finish" or "bt full" are then less likely to have to wait
+   for the DIEs to be read.  */
+
+static void
+dwarf2_prefetch_frame_cus (struct bpstat *bs, int print_frame)
+{
+  if (dwarf_prefetch_frames == 0 || !has_stack_frames ())
+    return;
+
+  try
+    {
+      frame_info_ptr frame = get_current_frame ();
+      for (unsigned int i = 0;
+	   frame != nullptr && i < dwarf_prefetch_frames;
+	   ++i, frame = get_prev_frame (frame))
+	{
+	  CORE_ADDR pc;
+	  if (!get_frame_address_in_block_if_available (frame, &pc))
+	    continue;
+
+	  struct obj_section *section = find_pc_section (pc);
+	  if (section == nullptr)
+	    continue;
+
+	  for (objfile *iter : section->objfile->separate_debug_objfiles ())
+	    {
+	      dwarf2_per_objfile *per_objfile = get_dwarf2_per_objfile (iter);
+	      if (per_objfile == nullptr
+		  || per_objfile->per_bfd->index_table == nullptr)
+		continue;
+
+	      CORE_ADDR baseaddr = iter->text_section_offset ();
+	      dwarf2_per_cu_data *per_cu
+		= (per_objfile->per_bfd->index_table->lookup
+		   ((unrelocated_addr) (pc - baseaddr)));
+	      if (per_cu != nullptr)
+		{
+		  per_objfile->prefetch_cu (per_cu);
+		  break;
+		}
+	    }
+	}
+    }
+  catch (const gdb_exception_error &except)
+    {
+      /* Prefetching is only an optimization; an unwinding error will
+	 be reported by whatever command needs the frame.  */
+      dwarf_read_debug_printf ("Prefetching stopped: %s", except.what ());
+    }
+}
+
 struct cmd_list_element *set_dwarf_cmdlist;
 struct cmd_list_element *show_dwarf_cmdlist;
 
@@ -21940,6 +22233,23 @@ for debug info processing to be finished before gdb can proceed."),
 			    &set_dwarf_cmdlist,
 			    &show_dwarf_cmdlist);
 
+  add_setshow_zuinteger_cmd ("prefetch-frames", class_obscure,
+			     &dwarf_prefetch_frames, _("\
+Set the number of frames whose DWARF compilation units are prefetched."), _("\
+Show the number of frames whose DWARF compilation units are prefetched."), _("\
+When the inferior stops, the DWARF compilation units covering this many\n\
+frames of the backtrace, counting from the innermost frame, are read in\n\
+worker threads.  Later commands that need these frames, such as \"up\" or\n\
+\"finish\", can then expand their symbols without reading the DWARF again.\n\
+Zero, the default, disables prefetching."),
+			     nullptr,
+			     show_dwarf_prefetch_frames,
+			     &set_dwarf_cmdlist,
+			     &show_dwarf_cmdlist);
+
+  gdb::observers::normal_stop.attach (dwarf2_prefetch_frame_cus,
+				      "dwarf2-read");
+
   add_setshow_zuinteger_cmd ("dwarf-read", no_class, &dwarf_read_debug, _("\
 Set debugging of the DWARF reader."), _("\
 Show debugging of the DWARF reader."), _("\
@@ -20,6 +20,7 @@
 #ifndef DWARF2READ_H
 #define DWARF2READ_H
 
+#include <mutex>
 #include <queue>
 #include <unordered_map>
 #include "dwarf2/comp-unit-head.h"
@@ -29,10 +30,12 @@
 #include "dwarf2/section.h"
 #include "dwarf2/cu.h"
 #include "filename-seen-cache.h"
+#include "complaints.h"
 #include "gdbsupport/gdb_obstack.h"
 #include "gdbsupport/hash_enum.h"
 #include "gdbsupport/function-view.h"
 #include "gdbsupport/packed.h"
+#include "gdbsupport/thread-pool.h"
 
 /* Hold 'maintenance (set|show) dwarf' commands.  */
 extern struct cmd_list_element *set_dwarf_cmdlist;
@@ -499,6 +502,13 @@ struct dwarf2_per_bfd
   /* The DWP file if there is one, or NULL.  */
   std::unique_ptr<struct dwp_file> dwp_file;
 
+#if CXX_STD_THREAD
+  /* Lock protecting DWO_FILES, DWP_FILE and the units of the DWP file,
+     which are looked up from the worker threads scanning the skeleton
+     CUs.  It is not held while a DWO file is being read.  */
+  std::mutex dwo_lock;
+#endif
+
   /* The shared '.dwz' file, if one exists.  This is used when the
      original data was compressed using 'dwz -m'.  */
   std::optional<std::unique_ptr<struct dwz_file>> dwz_file;
@@ -627,6 +637,21 @@ struct type_unit_group_unshareable
   struct symtab **symtabs = nullptr;
 };
 
+/* The result of reading the DIEs of a compilation unit in a worker
+   thread, ahead of the CU being needed.  See
+   dwarf2_per_objfile::prefetch_cu.  */
+
+struct dwarf2_prefetched_cu
+{
+  /* The CU, with its DIEs loaded.  This is nullptr if the CU could
+     not be read, or is a dummy CU.  */
+  std::unique_ptr<dwarf2_cu> cu;
+
+  /* Complaints issued while reading the DIEs.  These are re-emitted
+     on the main thread when the CU is installed.  */
+  complaint_collection complaints;
+};
+
 /* Collection of data recorded per objfile.
    This hangs off of dwarf2_objfile_data_key.
 
@@ -689,6 +714,20 @@ struct dwarf2_per_objfile
      any that are too old.  */
   void age_comp_units ();
 
+  /* Start reading the DIEs of PER_CU in a worker thread, so that a
+     later expansion of PER_CU does not have to.  This does nothing if
+     PER_CU is already expanded, loaded or being prefetched.  This may
+     only be called from the main thread.  */
+  void prefetch_cu (dwarf2_per_cu_data *per_cu);
+
+  /* Wait for all pending prefetches started by prefetch_cu, and
+     return the dwarf2_cu that was read for PER_CU, if any.  Ownership
+     of the result is transferred to the caller.  */
+  std::unique_ptr<dwarf2_cu> take_prefetched_cu (dwarf2_per_cu_data *per_cu);
+
+  /* Wait for all pending prefetches, then discard their results.  */
+  void discard_prefetched_cus ();
+
   /* Apply any needed adjustments to ADDR and then relocate the
      address according to the objfile's section offsets, returning a
      relocated address.  */
@@ -736,6 +775,12 @@ struct dwarf2_per_objfile
      corresponding objfile-dependent dwarf2_cu instances.  */
   std::unordered_map<dwarf2_per_cu_data *,
 		     std::unique_ptr<dwarf2_cu>> m_dwarf2_cus;
+
+  /* CUs whose DIEs are being read, or have been read, by a worker
+     thread.  Only the main thread accesses this map; the worker
+     threads only fill in the futures.  */
+  std::unordered_map<dwarf2_per_cu_data *,
+		     gdb::future<dwarf2_prefetched_cu>> m_prefetched_cus;
 };
 
 /* Converts DWARF language names to GDB language names.  */
@@ -1058,40 +1058,40 @@ elf_gnu_ifunc_resolver_return_stop (code_breakpoint *b)
 /* A helper function for elf_symfile_read that reads the minimal
    symbols.  */
 
-static void
-elf_read_minimal_symbols (struct objfile *objfile, int symfile_flags,
-			  const struct elfinfo *ei)
-{
-  bfd *synth_abfd, *abfd = objfile->obfd.get ();
-  long symcount = 0, dynsymcount = 0, synthcount, storage_needed;
-  asymbol **symbol_table = NULL, **dyn_symbol_table = NULL;
-  asymbol *synthsyms;
+/* The canonical ELF symbol tables of a BFD.  These are kept with the
+   BFD, so that they are read only once even if several objfiles use
+   the BFD, and so that they can be read ahead of time, see
+   elf_sym_read_ahead.  */
 
-  symtab_create_debug_printf ("reading minimal symbols of objfile %s",
-			      objfile_name (objfile));
+struct elf_bfd_symtabs
+{
+  /* The regular symbol table, allocated on the BFD's obstack.  This
+     is nullptr if the BFD has no symbols.  */
+  asymbol **symbol_table = nullptr;
+  long symcount = 0;
+
+  /* Likewise, for the dynamic symbol table.  */
+  asymbol **dyn_symbol_table = nullptr;
+  long dynsymcount = 0;
+};
 
-  /* If we already have minsyms, then we can skip some work here.
-     However, if there were stabs or mdebug sections, we go ahead and
-     redo all the work anyway, because the psym readers for those
-     kinds of debuginfo need extra information found here.  This can
-     go away once all types of symbols are in the per-BFD object.  */
-  if (objfile->per_bfd->minsyms_read
-      && ei->stabsect == NULL
-      && ei->mdebugsect == NULL
-      && ei->ctfsect == NULL)
-    {
-      symtab_create_debug_printf ("minimal symbols were previously read");
-      return;
-    }
+static const registry<bfd>::key<elf_bfd_symtabs> elf_bfd_symtabs_key;
 
-  minimal_symbol_reader reader (objfile);
+/* Read the canonical symbol tables of ABFD, and store them in ABFD's
+   registry.  Throws an error if they cannot be read.  This does not
+   depend on any global state, so it may be called from a worker
+   thread as long as no other thread uses ABFD at the same time.  */
 
-  /* Process the normal ELF symbol table first.  */
+static const elf_bfd_symtabs *
+elf_read_bfd_symtabs (bfd *abfd)
+{
+  elf_bfd_symtabs symtabs;
+  long storage_needed;
 
-  storage_needed = bfd_get_symtab_upper_bound (objfile->obfd.get ());
+  storage_needed = bfd_get_symtab_upper_bound (abfd);
   if (storage_needed < 0)
     error (_("Can't read symbols from %s: %s"),
-	   bfd_get_filename (objfile->obfd.get ()),
+	   bfd_get_filename (abfd),
 	   bfd_errmsg (bfd_get_error ()));
 
   if (storage_needed > 0)
@@ -1099,21 +1099,16 @@ elf_read_minimal_symbols (struct objfile *objfile, int symfile_flags,
       /* Memory gets permanently referenced from ABFD after
 	 bfd_canonicalize_symtab so it must not get freed before ABFD gets.  */
 
-      symbol_table = (asymbol **) bfd_alloc (abfd, storage_needed);
-      symcount = bfd_canonicalize_symtab (objfile->obfd.get (), symbol_table);
+      symtabs.symbol_table = (asymbol **) bfd_alloc (abfd, storage_needed);
+      symtabs.symcount = bfd_canonicalize_symtab (abfd, symtabs.symbol_table);
 
-      if (symcount < 0)
+      if (symtabs.symcount < 0)
 	error (_("Can't read symbols from %s: %s"),
-	       bfd_get_filename (objfile->obfd.get ()),
+	       bfd_get_filename (abfd),
 	       bfd_errmsg (bfd_get_error ()));
-
-      elf_symtab_read (reader, objfile, ST_REGULAR, symcount, symbol_table,
-		       false);
     }
 
-  /* Add the dynamic symbols.  */
-
-  storage_needed = bfd_get_dynamic_symtab_upper_bound (objfile->obfd.get ());
+  storage_needed = bfd_get_dynamic_symtab_upper_bound (abfd);
 
   if (storage_needed > 0)
     {
@@ -1124,15 +1119,76 @@ elf_read_minimal_symbols (struct objfile *objfile, int symfile_flags,
 	 done by _bfd_elf_get_synthetic_symtab which is all a bfd
 	 implementation detail, though.  */
 
-      dyn_symbol_table = (asymbol **) bfd_alloc (abfd, storage_needed);
-      dynsymcount = bfd_canonicalize_dynamic_symtab (objfile->obfd.get (),
-						     dyn_symbol_table);
+      symtabs.dyn_symbol_table = (asymbol **) bfd_alloc (abfd, storage_needed);
+      symtabs.dynsymcount
+	= bfd_canonicalize_dynamic_symtab (abfd, symtabs.dyn_symbol_table);
 
-      if (dynsymcount < 0)
+      if (symtabs.dynsymcount < 0)
 	error (_("Can't read symbols from %s: %s"),
-	       bfd_get_filename (objfile->obfd.get ()),
+	       bfd_get_filename (abfd),
 	       bfd_errmsg (bfd_get_error ()));
+    }
+
+  return elf_bfd_symtabs_key.emplace (abfd, symtabs);
+}
+
+/* The "sym_read_ahead" method of the ELF symbol reader.  */
+
+static void
+elf_sym_read_ahead (bfd *abfd)
+{
+  if (elf_bfd_symtabs_key.get (abfd) == nullptr)
+    elf_read_bfd_symtabs (abfd);
+}
+
+static void
+elf_read_minimal_symbols (struct objfile *objfile, int symfile_flags,
+			  const struct elfinfo *ei)
+{
+  bfd *synth_abfd, *abfd = objfile->obfd.get ();
+  long symcount = 0, dynsymcount = 0, synthcount;
+  asymbol **symbol_table = NULL, **dyn_symbol_table = NULL;
+  asymbol *synthsyms;
+
+  symtab_create_debug_printf ("reading minimal symbols of objfile %s",
+			      objfile_name (objfile));
+
+  /* If we already have minsyms, then we can skip some work here.
+     However, if there were stabs or mdebug sections, we go ahead and
+     redo all the work anyway, because the psym readers for those
+     kinds of debuginfo need extra information found here.  This can
+     go away once all types of symbols are in the per-BFD object.  */
+  if (objfile->per_bfd->minsyms_read
+      && ei->stabsect == NULL
+      && ei->mdebugsect == NULL
+      && ei->ctfsect == NULL)
+    {
+      symtab_create_debug_printf ("minimal symbols were previously read");
+      return;
+    }
 
+  minimal_symbol_reader reader (objfile);
+
+  /* The canonical symbol tables may already have been read by
+     elf_sym_read_ahead.  */
+  const elf_bfd_symtabs *symtabs = elf_bfd_symtabs_key.get (abfd);
+  if (symtabs == nullptr)
+    symtabs = elf_read_bfd_symtabs (abfd);
+
+  /* Process the normal ELF symbol table first.  */
+
+  symcount = symtabs->symcount;
+  symbol_table = symtabs->symbol_table;
+  if (symcount > 0)
+    elf_symtab_read (reader, objfile, ST_REGULAR, symcount, symbol_table,
+		     false);
+
+  /* Add the dynamic symbols.  */
+
+  dynsymcount = symtabs->dynsymcount;
+  dyn_symbol_table = symtabs->dyn_symbol_table;
+  if (dyn_symbol_table != nullptr)
+    {
       elf_symtab_read (reader, objfile, ST_DYNAMIC, dynsymcount,
 		       dyn_symbol_table, false);
 
@@ -1389,6 +1445,7 @@ static const struct sym_fns elf_sym_fns =
   NULL,
   default_symfile_relocate,	/* Relocate a debug section.  */
   &elf_probe_fns,		/* sym_probe_fns */
+  elf_sym_read_ahead,		/* sym_read_ahead */
 };
 
 /* STT_GNU_IFUNC resolver vector to be installed to gnu_ifunc_fns_p.  */
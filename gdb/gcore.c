@@ -37,6 +37,10 @@
 #include "gdbsupport/gdb_unlinker.h"
 #include "gdbsupport/byte-vector.h"
 #include "gdbsupport/scope-exit.h"
+#include "gdbsupport/thread-pool.h"
+#include "event-top.h"
+#include "ui-out.h"
+#include <optional>
 
 /* To generate sparse cores, we look at the data to write in chunks of
    this size when considering whether to skip the write.  Only if we
@@ -743,50 +747,161 @@ sparse_bfd_set_section_contents (bfd *obfd, asection *osec,
   return true;
 }
 
+/* A piece of a "load" section read from the target, to be written to
+   the core file.  */
+
+struct gcore_chunk
+{
+  /* The section, and the offset within it, of the data.  */
+  asection *osec = nullptr;
+  bfd_size_type offset = 0;
+
+  /* The data, and how much of it is valid.  */
+  gdb::byte_vector data;
+  bfd_size_type size = 0;
+};
+
+/* Write CHUNK to OBFD, skipping its all-zero blocks.  This runs in a
+   worker thread, while the main thread reads the next chunk from the
+   target, so it must not touch anything but OBFD.  Return true on
+   success; otherwise, store the BFD error message in *ERRMSG.  */
+
+static bool
+gcore_write_chunk (bfd *obfd, const gcore_chunk &chunk, std::string *errmsg)
+{
+  if (!sparse_bfd_set_section_contents (obfd, chunk.osec,
+					chunk.data.data (), chunk.offset,
+					chunk.size))
+    {
+      *errmsg = bfd_errmsg (bfd_get_error ());
+      return false;
+    }
+
+  return true;
+}
+
+/* Dumps at least this large show a progress report.  */
+#define GCORE_PROGRESS_MIN_BYTES (64 * 1024 * 1024)
+
+/* Copy the contents of all the "load" sections of OBFD from the
+   target's memory.
+
+   Reading the target and writing the file take about the same time
+   for large dumps, and the sparse logic adds a scan of all the data
+   for all-zero blocks.  So the target is read on the main thread one
+   chunk at a time, while the previous chunk is scanned and written
+   out by a worker thread.  */
+
 static void
-gcore_copy_callback (bfd *obfd, asection *osec)
+gcore_copy_load_sections (bfd *obfd)
 {
-  bfd_size_type size, total_size = bfd_section_size (osec);
-  file_ptr offset = 0;
+  std::vector<asection *> sections;
+  ULONGEST total_bytes = 0;
 
-  /* Read-only sections are marked; we don't have to copy their contents.  */
-  if ((bfd_section_flags (osec) & SEC_LOAD) == 0)
-    return;
+  for (asection *osec : gdb_bfd_sections (obfd))
+    {
+      /* Read-only sections are marked; we don't have to copy their
+	 contents.  */
+      if ((bfd_section_flags (osec) & SEC_LOAD) == 0)
+	continue;
 
-  /* Only interested in "load" sections.  */
-  if (!startswith (bfd_section_name (osec), "load"))
-    return;
+      /* Only interested in "load" sections.  */
+      if (!startswith (bfd_section_name (osec), "load"))
+	continue;
 
-  size = std::min (total_size, (bfd_size_type) MAX_COPY_BYTES);
-  gdb::byte_vector memhunk (size);
+      sections.push_back (osec);
+      total_bytes += bfd_section_size (osec);
+    }
 
-  while (total_size > 0)
+  std::optional<ui_out::progress_update> progress;
+  if (total_bytes >= GCORE_PROGRESS_MIN_BYTES)
+    progress.emplace ();
+  ULONGEST done_bytes = 0;
+
+  /* The chunk being read, and the one being written.  */
+  gcore_chunk chunks[2];
+  gcore_chunk *reading = &chunks[0];
+  gcore_chunk *writing = &chunks[1];
+  std::optional<gdb::future<bool>> write_done;
+  std::string write_errmsg;
+
+  /* Make sure the worker is done with its chunk before the chunks go
+     away, even if we're interrupted.  */
+  SCOPE_EXIT
     {
-      if (size > total_size)
-	size = total_size;
+      if (write_done.has_value ())
+	write_done->wait ();
+    };
 
-      if (target_read_memory (bfd_section_vma (osec) + offset,
-			      memhunk.data (), size) != 0)
-	{
-	  warning (_("Memory read failed for corefile "
-		     "section, %s bytes at %s."),
-		   plongest (size),
-		   paddress (current_inferior ()->arch (),
-			     bfd_section_vma (osec)));
-	  break;
-	}
+  /* Wait for the chunk being written, if any.  Return false if
+     writing it failed.  */
+  auto wait_for_write = [&] ()
+    {
+      if (!write_done.has_value ())
+	return true;
+
+      bool ok = write_done->get ();
+      write_done.reset ();
+      if (!ok)
+	warning (_("Failed to write corefile contents (%s)."),
+		 write_errmsg.c_str ());
+      return ok;
+    };
+
+  for (asection *osec : sections)
+    {
+      bfd_size_type total_size = bfd_section_size (osec);
+      bfd_size_type offset = 0;
 
-      if (!sparse_bfd_set_section_contents (obfd, osec, memhunk.data (),
-					    offset, size))
+      while (total_size > 0)
 	{
-	  warning (_("Failed to write corefile contents (%s)."),
-		   bfd_errmsg (bfd_get_error ()));
-	  break;
+	  QUIT;
+
+	  bfd_size_type size
+	    = std::min (total_size, (bfd_size_type) MAX_COPY_BYTES);
+
+	  reading->data.resize (MAX_COPY_BYTES);
+	  if (target_read_memory (bfd_section_vma (osec) + offset,
+				  reading->data.data (), size) != 0)
+	    {
+	      warning (_("Memory read failed for corefile "
+			 "section, %s bytes at %s."),
+		       plongest (size),
+		       paddress (current_inferior ()->arch (),
+				 bfd_section_vma (osec)));
+	      break;
+	    }
+	  reading->osec = osec;
+	  reading->offset = offset;
+	  reading->size = size;
+
+	  /* If writing the previous chunk of this section failed, give
+	     up on the rest of the section, like for a read failure, but
+	     go on with the other sections.  */
+	  if (!wait_for_write () && writing->osec == osec)
+	    break;
+
+	  std::swap (reading, writing);
+	  write_done.emplace
+	    (gdb::thread_pool::g_thread_pool->post_task<bool>
+	       ([=, &write_errmsg] ()
+		 {
+		   SCOPE_EXIT { bfd_thread_cleanup (); };
+		   return gcore_write_chunk (obfd, *writing, &write_errmsg);
+		 }));
+
+	  total_size -= size;
+	  offset += size;
+	  done_bytes += size;
+
+	  if (progress.has_value ())
+	    progress->update_progress (_("Writing core file"), "M",
+				       (double) done_bytes / total_bytes,
+				       (double) total_bytes / (1024 * 1024));
 	}
-
-      total_size -= size;
-      offset += size;
     }
+
+  wait_for_write ();
 }
 
 /* Callback to copy contents to a particular memory tag section.  */
@@ -830,11 +945,9 @@ gcore_memory_sections (bfd *obfd)
     make_output_phdrs (obfd, sect);
 
   /* Copy memory region and memory tag contents.  */
+  gcore_copy_load_sections (obfd);
   for (asection *sect : gdb_bfd_sections (obfd))
-    {
-      gcore_copy_callback (obfd, sect);
-      gcore_copy_memtag_section_callback (obfd, sect);
-    }
+    gcore_copy_memtag_section_callback (obfd, sect);
 
   return 1;
 }
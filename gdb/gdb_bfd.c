@@ -30,6 +30,7 @@
 #endif
 #endif
 #include "target.h"
+#include "target-file-cache.h"
 #include "gdbsupport/fileio.h"
 #include "inferior.h"
 #include "cli/cli-style.h"
@@ -475,6 +476,162 @@ target_fileio_stream::stat (struct bfd *abfd, struct stat *sb)
   return result;
 }
 
+/* An object that manages the underlying stream for a BFD on a target
+   file, reading the target file cache's local copy of it.  */
+
+struct cached_target_file_stream : public gdb_bfd_iovec_base
+{
+  /* FD is the local copy, ST the target's status of the file.  */
+  cached_target_file_stream (scoped_fd fd, const struct stat &st)
+    : m_fd (std::move (fd)),
+      m_stat (st)
+  {
+  }
+
+  file_ptr read (bfd *abfd, void *buffer, file_ptr nbytes,
+		 file_ptr offset) override;
+
+  int stat (struct bfd *abfd, struct stat *sb) override;
+
+private:
+
+  /* The descriptor of the local copy.  */
+  scoped_fd m_fd;
+
+  /* The status of the file on the target.  It is what the BFD reports,
+     so that reading the copy isn't visible to the rest of GDB.  */
+  struct stat m_stat;
+};
+
+/* Read the local copy.  */
+
+file_ptr
+cached_target_file_stream::read (struct bfd *abfd, void *buf,
+				 file_ptr nbytes, file_ptr offset)
+{
+  file_ptr pos = 0;
+
+  while (nbytes > pos)
+    {
+      ssize_t bytes;
+
+#ifdef HAVE_PREAD
+      bytes = pread (m_fd.get (), (gdb_byte *) buf + pos, nbytes - pos,
+		     offset + pos);
+#else
+      bytes = lseek (m_fd.get (), offset + pos, SEEK_SET);
+      if (bytes != -1)
+	bytes = ::read (m_fd.get (), (gdb_byte *) buf + pos, nbytes - pos);
+#endif
+      if (bytes == 0)
+	/* Success, but no bytes, means end-of-file.  */
+	break;
+      if (bytes == -1)
+	{
+	  if (errno == EINTR)
+	    continue;
+	  bfd_set_error (bfd_error_system_call);
+	  return -1;
+	}
+
+      pos += bytes;
+    }
+
+  return pos;
+}
+
+/* Return the target's status of the file.  */
+
+int
+cached_target_file_stream::stat (struct bfd *abfd, struct stat *sb)
+{
+  *sb = m_stat;
+  return 0;
+}
+
+/* Open a BFD on the target file cache's copy FD of target file NAME,
+   whose status on the target is ST.  */
+
+static gdb_bfd_ref_ptr
+gdb_bfd_open_cached_copy (const char *name, const char *target,
+			  scoped_fd fd, const struct stat &st)
+{
+  auto open = [&] (bfd *nbfd) -> gdb_bfd_iovec_base *
+  {
+    return new cached_target_file_stream (std::move (fd), st);
+  };
+
+  return gdb_bfd_openr_iovec (name, target, open);
+}
+
+/* Open target file NAME like gdb_bfd_open does, reading it from the
+   target file cache's copy of it when there is one.  */
+
+static gdb_bfd_ref_ptr
+gdb_bfd_open_target_file_cached (const char *name, const char *target,
+				 bool warn_if_slow)
+{
+  fileio_error target_errno;
+
+  /* Open the file and get its status ourselves, rather than through a
+     BFD, so that a copy found from the status alone is used without
+     making a BFD that reads the target.  */
+  int target_fd = target_fileio_open (current_inferior (),
+				      name + strlen (TARGET_SYSROOT_PREFIX),
+				      FILEIO_O_RDONLY, 0, warn_if_slow,
+				      &target_errno);
+  if (target_fd == -1)
+    {
+      errno = fileio_error_to_host (target_errno);
+      bfd_set_error (bfd_error_system_call);
+      return nullptr;
+    }
+
+  struct stat st;
+  bool have_st = (target_fileio_fstat (target_fd, &st, &target_errno) == 0
+		  && S_ISREG (st.st_mode));
+  if (have_st)
+    {
+      scoped_fd cached_fd = target_file_cache_lookup (name, st);
+      if (cached_fd.get () != -1)
+	{
+	  gdb_bfd_ref_ptr cached
+	    = gdb_bfd_open_cached_copy (name, target, std::move (cached_fd),
+					st);
+	  if (cached != nullptr)
+	    {
+	      target_fileio_close (target_fd, &target_errno);
+	      return cached;
+	    }
+	}
+    }
+
+  /* Read the target file, handing our descriptor to the BFD.  */
+  bool fd_taken = false;
+  auto open = [&] (bfd *nbfd) -> gdb_bfd_iovec_base *
+  {
+    fd_taken = true;
+    return new target_fileio_stream (nbfd, target_fd);
+  };
+
+  gdb_bfd_ref_ptr result = gdb_bfd_openr_iovec (name, target, open);
+  if (!fd_taken)
+    target_fileio_close (target_fd, &target_errno);
+  if (result == nullptr || !have_st)
+    return result;
+
+  /* Read the file from a local copy instead, if the cache can
+     provide one.  */
+  scoped_fd cached_fd = target_file_cache_fetch (result.get (), st);
+  if (cached_fd.get () == -1)
+    return result;
+
+  gdb_bfd_ref_ptr cached = gdb_bfd_open_cached_copy (name, target,
+						     std::move (cached_fd),
+						     st);
+  return cached != nullptr ? cached : result;
+}
+
 /* A helper function to initialize the data that gdb attaches to each
    BFD.  */
 
@@ -516,6 +673,10 @@ gdb_bfd_open (const char *name, const char *target, int fd,
 	{
 	  gdb_assert (fd == -1);
 
+	  if (target_file_cache_enabled_p ())
+	    return gdb_bfd_open_target_file_cached (name, target,
+						    warn_if_slow);
+
 	  auto open = [&] (bfd *nbfd) -> gdb_bfd_iovec_base *
 	  {
 	    return gdb_bfd_iovec_fileio_open (nbfd, current_inferior (),
@@ -1066,6 +1227,11 @@ gdb_bfd_record_inclusion (bfd *includer, bfd *includee)
 {
   struct gdb_bfd_data *gdata;
 
+#if CXX_STD_THREAD
+  /* DWO files are opened from worker threads.  */
+  std::lock_guard<std::recursive_mutex> guard (gdb_bfd_mutex);
+#endif
+
   gdata = (struct gdb_bfd_data *) bfd_usrdata (includer);
   gdata->included_bfds.push_back (gdb_bfd_ref_ptr::new_reference (includee));
 }
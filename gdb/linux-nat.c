@@ -53,6 +53,7 @@
 #include <dirent.h>
 #include "xml-support.h"
 #include <sys/vfs.h>
+#include <sys/uio.h>
 #include "solib.h"
 #include "nat/linux-osdata.h"
 #include "linux-tdep.h"
@@ -235,7 +236,13 @@ PTRACE_PEEKTEXT/PTRACE_POKETEXT or process_vm_readv/process_vm_writev:
   or exits, reading/writing from/to the file returns 0 (EOF),
   indicating the address space is gone, and so we return
   TARGET_XFER_EOF to the core.  We close the old file and open a new
-  one when we finally see the PTRACE_EVENT_EXEC event.  */
+  one when we finally see the PTRACE_EVENT_EXEC event.
+
+  The one exception is linux_nat_target::read_memory_batch, which
+  gathers many disjoint ranges with a single process_vm_readv call.
+  It only does so while every LWP of the process is ptrace-stopped,
+  in which case the process cannot exec behind our back, and falls
+  back to /proc/PID/mem otherwise.  */
 
 #ifndef O_LARGEFILE
 #define O_LARGEFILE 0
@@ -3943,6 +3950,124 @@ linux_nat_target::xfer_partial (enum target_object object,
 					  offset, len, xfered_len);
 }
 
+/* Whether process_vm_readv is usable.  Cleared the first time the
+   kernel refuses the call outright, e.g., because it predates Linux
+   3.2 or because a seccomp filter denies it.  */
+
+static bool process_vm_readv_works = true;
+
+/* Return true if PID has at least one LWP, and all its LWPs are
+   ptrace-stopped.  */
+
+static bool
+all_lwps_of_pid_stopped (int pid)
+{
+  bool found = false;
+
+  for (lwp_info *lp : all_lwps ())
+    if (lp->ptid.pid () == pid)
+      {
+	if (!lp->stopped)
+	  return false;
+	found = true;
+      }
+
+  return found;
+}
+
+/* Implement the "read_memory_batch" target method using
+   process_vm_readv.  See "Accessing inferior memory" at the top for
+   why this is only done while the whole process is stopped.  */
+
+bool
+linux_nat_target::read_memory_batch
+  (gdb::array_view<memory_read_request> requests)
+{
+#ifdef __NR_process_vm_readv
+  if (!process_vm_readv_works || inferior_ptid == null_ptid)
+    return false;
+
+  int pid = inferior_ptid.pid ();
+  if (!all_lwps_of_pid_stopped (pid))
+    return false;
+
+  /* See the address masking in xfer_partial.  */
+  int addr_bit = gdbarch_addr_bit (current_inferior ()->arch ());
+  ULONGEST addr_mask = ~(ULONGEST) 0;
+  if (addr_bit < (sizeof (ULONGEST) * HOST_CHAR_BIT))
+    addr_mask = ((ULONGEST) 1 << addr_bit) - 1;
+
+  /* The kernel's UIO_MAXIOV.  */
+  constexpr size_t max_iov = 1024;
+  std::vector<struct iovec> local (std::min (requests.size (), max_iov));
+  std::vector<struct iovec> remote (local.size ());
+
+  size_t next = 0;
+  size_t done = 0;
+  while (next < requests.size ())
+    {
+      size_t count = std::min (requests.size () - next, max_iov);
+
+      for (size_t i = 0; i < count; ++i)
+	{
+	  const memory_read_request &req = requests[next + i];
+
+	  local[i].iov_base = req.data;
+	  local[i].iov_len = req.end - req.begin;
+	  remote[i].iov_base
+	    = (void *) (uintptr_t) (req.begin & addr_mask);
+	  remote[i].iov_len = req.end - req.begin;
+	}
+
+      ssize_t ret = syscall (__NR_process_vm_readv, pid, local.data (), count,
+			     remote.data (), count, 0);
+      if (ret == -1)
+	{
+	  linux_nat_debug_printf ("process_vm_readv for pid %d failed: %s (%d)",
+				  pid, safe_strerror (errno), errno);
+
+	  if (errno == ENOSYS || errno == EPERM)
+	    {
+	      process_vm_readv_works = false;
+	      return next != 0;
+	    }
+	  else if (errno == ESRCH)
+	    break;
+
+	  /* The first range is unreadable.  Leave it to the caller
+	     and carry on with the rest.  */
+	  ++next;
+	  continue;
+	}
+
+      /* The kernel stops at the first range it fails to read, and
+	 reports how many bytes it managed to transfer until then.  */
+      size_t i;
+      for (i = 0; i < count; ++i)
+	{
+	  memory_read_request &req = requests[next + i];
+	  ULONGEST len = req.end - req.begin;
+
+	  if ((ULONGEST) ret < len)
+	    break;
+
+	  req.done = true;
+	  ++done;
+	  ret -= len;
+	}
+
+      /* Skip the range that stopped the transfer, if any.  */
+      next += (i < count ? i + 1 : count);
+    }
+
+  linux_nat_debug_printf ("read %zu of %zu ranges of pid %d with "
+			  "process_vm_readv", done, requests.size (), pid);
+  return true;
+#else
+  return false;
+#endif
+}
+
 bool
 linux_nat_target::thread_alive (ptid_t ptid)
 {
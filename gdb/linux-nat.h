@@ -57,6 +57,8 @@ class linux_nat_target : public inf_ptrace_target
 					ULONGEST offset, ULONGEST len,
 					ULONGEST *xfered_len) override;
 
+  bool read_memory_batch (gdb::array_view<memory_read_request>) override;
+
   void kill () override;
 
   void mourn_inferior () override;
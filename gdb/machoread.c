@@ -936,6 +936,7 @@ static const struct sym_fns macho_sym_fns = {
   NULL,
   macho_symfile_relocate,	/* Relocate a debug section.  */
   NULL,				/* sym_get_probes */
+  NULL,				/* sym_read_ahead */
 };
 
 void _initialize_machoread ();
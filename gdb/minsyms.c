@@ -54,6 +54,8 @@
 #include "gdbsupport/gdb-safe-ctype.h"
 #include "gdbsupport/parallel-for.h"
 #include "inferior.h"
+#include "build-id.h"
+#include "dwarf2/index-cache.h"
 
 #if CXX_STD_THREAD
 #include <mutex>
@@ -1478,6 +1480,19 @@ minimal_symbol_reader::install ()
 
       std::vector<computed_hash_values> hash_values (mcount);
 
+      /* The demangled names of this objfile may have been saved by an
+	 earlier session, in which case there is no need to demangle
+	 them again.  If they weren't, save them for the next one.  */
+      const bfd_build_id *build_id
+	= build_id_bfd_get (m_objfile->obfd.get ());
+      std::unique_ptr<demangled_name_cache> name_cache;
+      bool store_name_cache = false;
+      if (build_id != nullptr && global_index_cache.enabled ())
+	{
+	  name_cache = global_index_cache.lookup_demangled_names (build_id);
+	  store_name_cache = name_cache == nullptr;
+	}
+
       msymbols = m_objfile->per_bfd->msymbols.get ();
       /* Arbitrarily require at least 10 elements in a thread.  */
       gdb::parallel_for_each (10, &msymbols[0], &msymbols[mcount],
@@ -1487,22 +1502,43 @@ minimal_symbol_reader::install ()
 	     {
 	       size_t idx = msym - msymbols;
 	       hash_values[idx].name_length = strlen (msym->linkage_name ());
-	       if (!msym->name_set)
-		 {
-		   /* This will be freed later, by compute_and_set_names.  */
-		   gdb::unique_xmalloc_ptr<char> demangled_name
-		     = symbol_find_demangled_name (msym, msym->linkage_name ());
-		   msym->set_demangled_name
-		     (demangled_name.release (),
-		      &m_objfile->per_bfd->storage_obstack);
-		   msym->name_set = 1;
-		 }
 	       /* This mangled_name_hash computation has to be outside of
 		  the name_set check, or compute_and_set_names below will
 		  be called with an invalid hash value.  */
 	       hash_values[idx].mangled_name_hash
 		 = fast_hash (msym->linkage_name (),
 			      hash_values[idx].name_length);
+	       if (!msym->name_set)
+		 {
+		   enum language cached_language;
+		   const char *cached_name;
+
+		   if (name_cache != nullptr
+		       && msym->language () == language_unknown
+		       && name_cache->lookup (msym->linkage_name (),
+					      hash_values[idx].mangled_name_hash,
+					      &cached_language, &cached_name))
+		     {
+		       /* This mimics what symbol_find_demangled_name
+			  does.  */
+		       msym->m_language = cached_language;
+		       msym->set_demangled_name
+			 (cached_name == nullptr ? nullptr : xstrdup (cached_name),
+			  &m_objfile->per_bfd->storage_obstack);
+		     }
+		   else
+		     {
+		       /* This will be freed later, by
+			  compute_and_set_names.  */
+		       gdb::unique_xmalloc_ptr<char> demangled_name
+			 = symbol_find_demangled_name (msym,
+						       msym->linkage_name ());
+		       msym->set_demangled_name
+			 (demangled_name.release (),
+			  &m_objfile->per_bfd->storage_obstack);
+		     }
+		   msym->name_set = 1;
+		 }
 	       hash_values[idx].minsym_hash
 		 = msymbol_hash (msym->linkage_name ());
 	       /* We only use this hash code if the search name differs
@@ -1532,6 +1568,28 @@ minimal_symbol_reader::install ()
 	 });
 
       build_minimal_symbol_hash_tables (m_objfile, hash_values);
+
+      if (store_name_cache)
+	{
+	  std::vector<demangled_name_cache_entry> entries;
+	  entries.reserve (mcount);
+	  for (int i = 0; i < mcount; ++i)
+	    {
+	      const minimal_symbol *msym = &msymbols[i];
+
+	      /* Ada names are decoded lazily, see ada_decode_symbol.  */
+	      if (msym->language () == language_ada)
+		continue;
+
+	      entries.push_back ({ msym->linkage_name (),
+				   hash_values[i].mangled_name_hash,
+				   msym->language (),
+				   msym->demangled_name () });
+	    }
+
+	  global_index_cache.store_demangled_names (build_id,
+						    std::move (entries));
+	}
     }
 }
 
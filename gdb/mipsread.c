@@ -372,6 +372,7 @@ static const struct sym_fns ecoff_sym_fns =
   NULL,
   default_symfile_relocate,	/* Relocate a debug section.  */
   NULL,				/* sym_probe_fns */
+  NULL,				/* sym_read_ahead */
 };
 
 void _initialize_mipsread ();
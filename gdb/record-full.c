@@ -381,6 +381,80 @@ static struct cmd_list_element *record_full_cmdlist;
 static void record_full_goto_insn (struct record_full_entry *entry,
 				   enum exec_direction_kind dir);
 
+/* Entries of the execution log are carved out of chunks of this many
+   entries instead of being malloc'd one at a time, and released entries
+   are kept on a free list.  Once the log is full, the entries dropped
+   from its beginning are thus reused for the instructions added at its
+   end, and recording does not go through malloc for each change.  */
+
+#define RECORD_FULL_ENTRY_CHUNK_SIZE 4096
+
+/* The chunks the entries are allocated from.  */
+static std::vector<std::unique_ptr<record_full_entry[]>>
+  record_full_entry_chunks;
+
+/* The free entries of RECORD_FULL_ENTRY_CHUNKS, linked through their
+   "next" field.  */
+static struct record_full_entry *record_full_entry_free_list;
+
+/* Number of entries of RECORD_FULL_ENTRY_CHUNKS in use.  */
+static size_t record_full_entry_live_count;
+
+/* Get a zeroed entry of type TYPE from the free list, allocating a new
+   chunk if the free list is empty.  */
+
+static struct record_full_entry *
+record_full_entry_alloc (enum record_full_type type)
+{
+  struct record_full_entry *rec;
+
+  if (record_full_entry_free_list == NULL)
+    {
+      record_full_entry *chunk
+	= new record_full_entry[RECORD_FULL_ENTRY_CHUNK_SIZE];
+      record_full_entry_chunks.emplace_back (chunk);
+
+      for (int i = RECORD_FULL_ENTRY_CHUNK_SIZE - 1; i >= 0; --i)
+	{
+	  chunk[i].next = record_full_entry_free_list;
+	  record_full_entry_free_list = &chunk[i];
+	}
+    }
+
+  rec = record_full_entry_free_list;
+  record_full_entry_free_list = rec->next;
+  ++record_full_entry_live_count;
+
+  memset (rec, 0, sizeof (*rec));
+  rec->type = type;
+  return rec;
+}
+
+/* Put REC back on the free list.  */
+
+static void
+record_full_entry_free (struct record_full_entry *rec)
+{
+  gdb_assert (record_full_entry_live_count > 0);
+  --record_full_entry_live_count;
+
+  rec->next = record_full_entry_free_list;
+  record_full_entry_free_list = rec;
+}
+
+/* Give the memory of the entry chunks back to the system, if none of
+   their entries is in use.  */
+
+static void
+record_full_entry_chunks_release ()
+{
+  if (record_full_entry_live_count != 0)
+    return;
+
+  record_full_entry_free_list = NULL;
+  record_full_entry_chunks.clear ();
+}
+
 /* Alloc and free functions for record_full_reg, record_full_mem, and
    record_full_end entries.  */
 
@@ -392,8 +466,7 @@ record_full_reg_alloc (struct regcache *regcache, int regnum)
   struct record_full_entry *rec;
   struct gdbarch *gdbarch = regcache->arch ();
 
-  rec = XCNEW (struct record_full_entry);
-  rec->type = record_full_reg;
+  rec = record_full_entry_alloc (record_full_reg);
   rec->u.reg.num = regnum;
   rec->u.reg.len = register_size (gdbarch, regnum);
   if (rec->u.reg.len > sizeof (rec->u.reg.u.buf))
@@ -410,7 +483,7 @@ record_full_reg_release (struct record_full_entry *rec)
   gdb_assert (rec->type == record_full_reg);
   if (rec->u.reg.len > sizeof (rec->u.reg.u.buf))
     xfree (rec->u.reg.u.ptr);
-  xfree (rec);
+  record_full_entry_free (rec);
 }
 
 /* Alloc a record_full_mem record entry.  */
@@ -420,8 +493,7 @@ record_full_mem_alloc (CORE_ADDR addr, int len)
 {
   struct record_full_entry *rec;
 
-  rec = XCNEW (struct record_full_entry);
-  rec->type = record_full_mem;
+  rec = record_full_entry_alloc (record_full_mem);
   rec->u.mem.addr = addr;
   rec->u.mem.len = len;
   if (rec->u.mem.len > sizeof (rec->u.mem.u.buf))
@@ -438,7 +510,7 @@ record_full_mem_release (struct record_full_entry *rec)
   gdb_assert (rec->type == record_full_mem);
   if (rec->u.mem.len > sizeof (rec->u.mem.u.buf))
     xfree (rec->u.mem.u.ptr);
-  xfree (rec);
+  record_full_entry_free (rec);
 }
 
 /* Alloc a record_full_end record entry.  */
@@ -446,12 +518,7 @@ record_full_mem_release (struct record_full_entry *rec)
 static inline struct record_full_entry *
 record_full_end_alloc (void)
 {
-  struct record_full_entry *rec;
-
-  rec = XCNEW (struct record_full_entry);
-  rec->type = record_full_end;
-
-  return rec;
+  return record_full_entry_alloc (record_full_end);
 }
 
 /* Free a record_full_end record entry.  */
@@ -459,7 +526,7 @@ record_full_end_alloc (void)
 static inline void
 record_full_end_release (struct record_full_entry *rec)
 {
-  xfree (rec);
+  record_full_entry_free (rec);
 }
 
 /* Free one record entry, any type.
@@ -1002,6 +1069,7 @@ record_full_base_target::close ()
     gdb_printf (gdb_stdlog, "Process record: record_full_close\n");
 
   record_full_list_release (record_full_list);
+  record_full_entry_chunks_release ();
 
   /* Release record_full_core_regbuf.  */
   if (record_full_core_regbuf)
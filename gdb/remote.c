@@ -73,10 +73,14 @@
 #include "gdbsupport/scoped_restore.h"
 #include "gdbsupport/environ.h"
 #include "gdbsupport/byte-vector.h"
+#include "dcache.h"
+#include "target-dcache.h"
 #include "gdbsupport/search.h"
 #include <algorithm>
+#include <deque>
 #include <iterator>
 #include <unordered_map>
+#include <zlib.h>
 #include "async-event.h"
 #include "gdbsupport/selftest.h"
 #include "cli/cli-style.h"
@@ -391,6 +395,25 @@ enum {
      errors, and so they should not need to check for this feature.  */
   PACKET_accept_error_message,
 
+  /* Support for the QStopSnapshot packet.  */
+  PACKET_QStopSnapshot,
+
+  /* Support for compressed replies to memory reads, qXfer reads and
+     vFile:pread requests.  */
+  PACKET_compression,
+
+  /* Support for the qCRCBlocks packet.  */
+  PACKET_qCRCBlocks,
+
+  /* Support for the qRegisters packet.  */
+  PACKET_qRegisters,
+
+  /* Support for the vFile:bulkread packet.  */
+  PACKET_vFile_bulkread,
+
+  /* Support for the vZ0 and vz0 packets.  */
+  PACKET_vZ0,
+
   PACKET_MAX
 };
 
@@ -420,6 +443,15 @@ struct vCont_action_support
 
 #define MAXTHREADLISTRESULTS 32
 
+/* The number of threads whose registers the first qRegisters request
+   after a resumption asks for.  */
+
+#define REGISTERS_PREFETCH_INITIAL_BATCH 8
+
+/* How much to read ahead at once with vFile:bulkread.  */
+
+#define REMOTE_HOSTIO_BULK_READ_SIZE (4 * 1024 * 1024)
+
 /* Data for the vFile:pread readahead cache.  */
 
 struct readahead_cache
@@ -570,6 +602,11 @@ class remote_state
      reliable.  */
   bool noack_mode = false;
 
+  /* The number of requests the stub accepts without waiting for their
+     replies, as reported by its PacketPipeline feature.  Zero if it
+     didn't report one.  */
+  int packet_pipeline = 0;
+
   /* True if we're connected in extended remote mode.  */
   bool extended = false;
 
@@ -606,6 +643,15 @@ class remote_state
   ptid_t general_thread = null_ptid;
   ptid_t continue_thread = null_ptid;
 
+  /* The thread whose registers were last fetched with a 'g' or
+     qRegisters request since the last resumption, or null_ptid.  */
+  ptid_t last_fetched_registers_ptid = null_ptid;
+
+  /* The number of threads the next qRegisters request asks for.  It
+     starts small after each resumption, in case GDB is not walking
+     the threads after all, and doubles with each request.  */
+  int registers_prefetch_batch = REGISTERS_PREFETCH_INITIAL_BATCH;
+
   /* This is the traceframe which we last selected on the remote system.
      It will be -1 if no traceframe is selected.  */
   int remote_traceframe_number = -1;
@@ -622,6 +668,9 @@ class remote_state
      target.  */
   bool last_thread_events = false;
 
+  /* And the last QStopSnapshot packet the target accepted.  */
+  std::string last_stop_snapshot_packet;
+
   gdb_signal last_sent_signal = GDB_SIGNAL_0;
 
   bool last_sent_step = false;
@@ -854,6 +903,7 @@ class remote_target : public process_stratum_target
   void disconnect (const char *, int) override;
 
   void commit_requested_thread_options ();
+  void set_stop_snapshot ();
 
   void commit_resumed () override;
   void resume (ptid_t, int, enum gdb_signal) override;
@@ -869,6 +919,13 @@ class remote_target : public process_stratum_target
   int remove_breakpoint (struct gdbarch *, struct bp_target_info *,
 			 enum remove_bp_reason) override;
 
+  int insert_breakpoint_batch (struct gdbarch *,
+			       gdb::array_view<bp_target_info *>) override;
+
+  int remove_breakpoint_batch (struct gdbarch *,
+			       gdb::array_view<bp_target_info *>,
+			       enum remove_bp_reason) override;
+
 
   bool stopped_by_sw_breakpoint () override;
   bool supports_stopped_by_sw_breakpoint () override;
@@ -1089,6 +1146,10 @@ class remote_target : public process_stratum_target
   int verify_memory (const gdb_byte *data,
 		     CORE_ADDR memaddr, ULONGEST size) override;
 
+  int verify_memory_blocks (const gdb_byte *data, CORE_ADDR memaddr,
+			    ULONGEST size, ULONGEST block_size,
+			    std::vector<bool> *matches) override;
+
 
   bool get_tib_address (ptid_t ptid, CORE_ADDR *addr) override;
 
@@ -1157,10 +1218,18 @@ class remote_target : public process_stratum_target
 			    ULONGEST offset, fileio_error *remote_errno);
   int remote_hostio_pread_vFile (int fd, gdb_byte *read_buf, int len,
 				 ULONGEST offset, fileio_error *remote_errno);
+  int remote_hostio_pread_pipelined (int fd, gdb_byte *read_buf, int len,
+				     ULONGEST offset,
+				     fileio_error *remote_errno);
+  int remote_hostio_pread_bulk (int fd, gdb_byte *read_buf, int len,
+				ULONGEST offset, fileio_error *remote_errno);
 
   int remote_hostio_send_command (int command_bytes, int which_packet,
 				  fileio_error *remote_errno, const char **attachment,
 				  int *attachment_len);
+  int remote_hostio_parse_reply (int bytes_read, int which_packet,
+				 fileio_error *remote_errno,
+				 const char **attachment, int *attachment_len);
   int remote_hostio_set_filesystem (struct inferior *inf,
 				    fileio_error *remote_errno);
   /* We should get rid of this and use fileio_open directly.  */
@@ -1182,6 +1251,9 @@ class remote_target : public process_stratum_target
 
   char *append_pending_thread_resumptions (char *p, char *endp,
 					   ptid_t ptid);
+
+  int send_breakpoint_batch (bool insert,
+			     gdb::array_view<bp_target_info *> bps);
   static void open_1 (const char *name, int from_tty, int extended_p);
   void start_remote (int from_tty, int extended_p);
   void remote_detach_1 (struct inferior *inf, int from_tty);
@@ -1283,6 +1355,12 @@ class remote_target : public process_stratum_target
 
   void remote_packet_size (const protocol_feature *feature,
 			   packet_support support, const char *value);
+  void remote_packet_pipeline (const protocol_feature *feature,
+			       enum packet_support support,
+			       const char *value);
+  void remote_compression_feature (const protocol_feature *feature,
+				   enum packet_support support,
+				   const char *value);
   void remote_supported_thread_options (const protocol_feature *feature,
 					enum packet_support support,
 					const char *value);
@@ -1306,6 +1384,8 @@ class remote_target : public process_stratum_target
   int send_g_packet ();
   void process_g_packet (struct regcache *regcache);
   void fetch_registers_using_g (struct regcache *regcache);
+  void prefetch_registers (struct regcache *regcache);
+  bool take_prefetched_registers (ptid_t ptid);
   int store_register_using_P (const struct regcache *regcache,
 			      packet_reg *reg);
   void store_registers_using_G (const struct regcache *regcache);
@@ -1350,6 +1430,7 @@ class remote_target : public process_stratum_target
 					 const gdb_byte *data);
 
   int readchar (int timeout);
+  void read_raw (gdb_byte *buf, int len);
 
   void remote_serial_write (const char *str, int len);
   void remote_serial_send_break ();
@@ -1366,6 +1447,12 @@ class remote_target : public process_stratum_target
   long read_frame (gdb::char_vector *buf_p);
   int getpkt (gdb::char_vector *buf, bool forever = false,
 	      bool *is_notif = nullptr);
+
+  int pipeline_window ();
+  int pipeline_packets (int count,
+			gdb::function_view<std::string (int)> build_request,
+			gdb::function_view<bool (int, int)> handle_reply);
+  int uncompress_reply (int len);
   int remote_vkill (int pid);
   void remote_kill_k ();
 
@@ -1460,6 +1547,11 @@ struct stop_reply : public notif_event
      fetch them is avoided).  */
   std::vector<cached_reg_t> regcache;
 
+  /* The memory at the top of the stack of the thread that stopped,
+     if the stub sent it along with the event (see QStopSnapshot).  */
+  CORE_ADDR stack_addr;
+  gdb::byte_vector stack;
+
   enum target_stop_reason stop_reason;
 
   CORE_ADDR watch_data_address;
@@ -1604,6 +1696,17 @@ struct remote_thread_info : public private_thread_info
      to stop for a watchpoint.  */
   CORE_ADDR watch_data_address = 0;
 
+  /* The registers of this thread, formatted as in a 'g' reply, when
+     they were fetched along with those of another thread and not yet
+     supplied to GDB.  */
+  std::string prefetched_registers;
+
+  /* Whether this thread's registers were fetched since it was last
+     resumed.  qRegisters requests leave such threads out, even if GDB
+     flushed its register cache since, in which case their registers
+     are fetched with 'g' again.  */
+  bool registers_fetched = false;
+
   /* Get the thread's resume state.  */
   enum resume_state get_resume_state () const
   {
@@ -3049,6 +3152,83 @@ record_currthread (struct remote_state *rs, ptid_t currthread)
   rs->general_thread = currthread;
 }
 
+/* The number of bytes of stack above the stack pointer we ask the
+   remote stub to send along with stop replies.  */
+
+static unsigned int remote_stop_snapshot_stack_size = 256;
+
+/* The value the user set with "set remote stop-snapshot-stack-size",
+   only copied to remote_stop_snapshot_stack_size once validated.  */
+
+static unsigned int remote_stop_snapshot_stack_size_1 = 256;
+
+/* The largest value of remote_stop_snapshot_stack_size.  */
+
+#define REMOTE_STOP_SNAPSHOT_MAX_STACK_SIZE 0x4000
+
+static void
+set_remote_stop_snapshot_stack_size (const char *args, int from_tty,
+				     struct cmd_list_element *c)
+{
+  if (remote_stop_snapshot_stack_size_1 > REMOTE_STOP_SNAPSHOT_MAX_STACK_SIZE)
+    {
+      remote_stop_snapshot_stack_size_1 = remote_stop_snapshot_stack_size;
+      error (_("The stop snapshot stack size can't be larger than %d bytes."),
+	     REMOTE_STOP_SNAPSHOT_MAX_STACK_SIZE);
+    }
+
+  remote_stop_snapshot_stack_size = remote_stop_snapshot_stack_size_1;
+}
+
+static void
+show_remote_stop_snapshot_stack_size (struct ui_file *file, int from_tty,
+				      struct cmd_list_element *c,
+				      const char *value)
+{
+  gdb_printf (file, _("The number of bytes of stack sent along with "
+		      "stop replies is %s.\n"), value);
+}
+
+/* If 'QStopSnapshot' is supported, ask the remote stub to send all
+   the registers of the thread that stopped, and the top of its stack,
+   along with its stop replies.  This saves fetching them with separate
+   packets after each stop.  Only send the packet when what we'd ask
+   for changes, e.g., when the current inferior's architecture does.  */
+
+void
+remote_target::set_stop_snapshot ()
+{
+  struct remote_state *rs = get_remote_state ();
+
+  if (m_features.packet_support (PACKET_QStopSnapshot) == PACKET_DISABLE)
+    return;
+
+  gdbarch *gdbarch = current_inferior ()->arch ();
+  int sp_regnum = gdbarch_sp_regnum (gdbarch);
+  if (sp_regnum < 0 || sp_regnum >= gdbarch_num_regs (gdbarch))
+    return;
+
+  remote_arch_state *rsa = rs->get_remote_arch_state (gdbarch);
+  packet_reg *reg = packet_reg_from_regnum (gdbarch, rsa, sp_regnum);
+  if (reg->pnum < 0)
+    return;
+
+  std::string packet = string_printf ("QStopSnapshot:%s,%x",
+				      phex_nz (reg->pnum, 0),
+				      remote_stop_snapshot_stack_size);
+  if (packet == rs->last_stop_snapshot_packet)
+    return;
+
+  putpkt (packet.c_str ());
+  getpkt (&rs->buf);
+
+  packet_result result = m_features.packet_ok (rs->buf, PACKET_QStopSnapshot);
+  if (result.status () == PACKET_OK)
+    rs->last_stop_snapshot_packet = std::move (packet);
+  else if (result.status () == PACKET_ERROR)
+    warning (_("Remote failure reply: %s"), result.err_msg ());
+}
+
 /* If 'QPassSignals' is supported, tell the remote stub what signals
    it can simply pass through to the inferior without reporting.  */
 
@@ -5678,6 +5858,72 @@ remote_packet_size (remote_target *remote, const protocol_feature *feature,
   remote->remote_packet_size (feature, support, value);
 }
 
+void
+remote_target::remote_packet_pipeline (const protocol_feature *feature,
+				       enum packet_support support,
+				       const char *value)
+{
+  struct remote_state *rs = get_remote_state ();
+
+  if (support != PACKET_ENABLE)
+    return;
+
+  if (value == nullptr || *value == '\0')
+    {
+      warning (_("Remote target reported \"%s\" without a depth."),
+	       feature->name);
+      return;
+    }
+
+  ULONGEST depth = 0;
+  const char *p = unpack_varlen_hex (value, &depth);
+  if (*p != '\0' || depth > INT_MAX)
+    {
+      warning (_("Remote target reported \"%s\" with a bad depth: \"%s\"."),
+	       feature->name, value);
+      return;
+    }
+
+  rs->packet_pipeline = depth;
+}
+
+static void
+remote_packet_pipeline (remote_target *remote, const protocol_feature *feature,
+			enum packet_support support, const char *value)
+{
+  remote->remote_packet_pipeline (feature, support, value);
+}
+
+void
+remote_target::remote_compression_feature (const protocol_feature *feature,
+					   enum packet_support support,
+					   const char *value)
+{
+  if (support == PACKET_ENABLE && (value == nullptr || *value == '\0'))
+    {
+      warning (_("Remote target reported \"%s\" without an algorithm."),
+	       feature->name);
+      support = PACKET_DISABLE;
+    }
+  else if (support == PACKET_ENABLE && strcmp (value, "zlib") != 0)
+    {
+      warning (_("Remote target reported \"%s\" with an unknown "
+		 "algorithm: \"%s\"."),
+	       feature->name, value);
+      support = PACKET_DISABLE;
+    }
+
+  m_features.m_protocol_packets[feature->packet].support = support;
+}
+
+static void
+remote_compression_feature (remote_target *remote,
+			    const protocol_feature *feature,
+			    enum packet_support support, const char *value)
+{
+  remote->remote_compression_feature (feature, support, value);
+}
+
 void
 remote_target::remote_supported_thread_options (const protocol_feature *feature,
 						enum packet_support support,
@@ -5723,6 +5969,7 @@ remote_supported_thread_options (remote_target *remote,
 
 static const struct protocol_feature remote_protocol_features[] = {
   { "PacketSize", PACKET_DISABLE, remote_packet_size, -1 },
+  { "PacketPipeline", PACKET_DISABLE, remote_packet_pipeline, -1 },
   { "qXfer:auxv:read", PACKET_DISABLE, remote_supported_packet,
     PACKET_qXfer_auxv },
   { "qXfer:exec-file:read", PACKET_DISABLE, remote_supported_packet,
@@ -5830,6 +6077,17 @@ static const struct protocol_feature remote_protocol_features[] = {
     PACKET_memory_tagging_feature },
   { "error-message", PACKET_ENABLE, remote_supported_packet,
     PACKET_accept_error_message },
+  { "QStopSnapshot", PACKET_DISABLE, remote_supported_packet,
+    PACKET_QStopSnapshot },
+  { "compression", PACKET_DISABLE, remote_compression_feature,
+    PACKET_compression },
+  { "qCRCBlocks", PACKET_DISABLE, remote_supported_packet,
+    PACKET_qCRCBlocks },
+  { "qRegisters", PACKET_DISABLE, remote_supported_packet,
+    PACKET_qRegisters },
+  { "vFile:bulkread", PACKET_DISABLE, remote_supported_packet,
+    PACKET_vFile_bulkread },
+  { "vZ0", PACKET_DISABLE, remote_supported_packet, PACKET_vZ0 },
 };
 
 static char *remote_support_xml;
@@ -5941,6 +6199,10 @@ remote_target::remote_query_supported ()
 	  != AUTO_BOOLEAN_FALSE)
 	remote_query_supported_append (&q, "memory-tagging+");
 
+      if (m_features.packet_set_cmd_state (PACKET_compression)
+	  != AUTO_BOOLEAN_FALSE)
+	remote_query_supported_append (&q, "compression=zlib");
+
       /* Keep this one last to work around a gdbserver <= 7.10 bug in
 	 the qSupported:xmlRegisters=i386 handling.  */
       if (remote_support_xml != NULL
@@ -7010,6 +7272,8 @@ remote_target::resume (ptid_t scope_ptid, int step, enum gdb_signal siggnal)
 {
   struct remote_state *rs = get_remote_state ();
 
+  set_stop_snapshot ();
+
   /* When connected in non-stop mode, the core resumes threads
      individually.  Resuming remote threads directly in target_resume
      would thus result in sending one packet per thread.  Instead, to
@@ -7027,6 +7291,10 @@ remote_target::resume (ptid_t scope_ptid, int step, enum gdb_signal siggnal)
       gdb_assert (remote_thr->get_resume_state () == resume_state::NOT_RESUMED);
 
       remote_thr->set_resumed_pending_vcont (step, siggnal);
+      remote_thr->prefetched_registers.clear ();
+      remote_thr->registers_fetched = false;
+      rs->last_fetched_registers_ptid = null_ptid;
+      rs->registers_prefetch_batch = REGISTERS_PREFETCH_INITIAL_BATCH;
 
       /* There's actually nothing that says that the core can't
 	 request a wildcard resume in non-stop mode, though.  It's
@@ -7053,9 +7321,18 @@ remote_target::resume (ptid_t scope_ptid, int step, enum gdb_signal siggnal)
   if (!remote_resume_with_vcont (scope_ptid, step, siggnal))
     remote_resume_with_hc (scope_ptid, step, siggnal);
 
-  /* Update resumed state tracked by the remote target.  */
+  /* Update resumed state tracked by the remote target, and forget the
+     registers fetched while the threads were stopped.  */
   for (thread_info *tp : all_non_exited_threads (this, scope_ptid))
-    get_remote_thread_info (tp)->set_resumed ();
+    {
+      remote_thread_info *remote_thr = get_remote_thread_info (tp);
+
+      remote_thr->set_resumed ();
+      remote_thr->prefetched_registers.clear ();
+      remote_thr->registers_fetched = false;
+    }
+  rs->last_fetched_registers_ptid = null_ptid;
+  rs->registers_prefetch_batch = REGISTERS_PREFETCH_INITIAL_BATCH;
 
   /* We've just told the target to resume.  The remote server will
      wait for the inferior to stop, and then send a stop reply.  In
@@ -7992,6 +8269,7 @@ remote_target::remote_parse_stop_reply (const char *buf, stop_reply *event)
   event->ws.set_ignore ();
   event->stop_reason = TARGET_STOPPED_BY_NO_REASON;
   event->regcache.clear ();
+  event->stack.clear ();
   event->core = -1;
 
   switch (buf[0])
@@ -8138,6 +8416,27 @@ Packet: '%s'\n"),
 	      event->ws.set_thread_created ();
 	      p = strchrnul (p1 + 1, ';');
 	    }
+	  else if (strprefix (p, p1, "stack"))
+	    {
+	      ULONGEST stack_addr;
+	      const char *end;
+
+	      p = unpack_varlen_hex (++p1, &stack_addr);
+	      if (*p != ',')
+		error (_("Malformed stack snapshot in stop reply: %s"), buf);
+	      ++p;
+	      end = strchrnul (p, ';');
+
+	      /* As with the registers, skip the memory of the program
+		 that was replaced by an exec.  */
+	      if (!skipregs)
+		{
+		  event->stack_addr = stack_addr;
+		  event->stack.resize ((end - p) / 2);
+		  hex2bin (p, event->stack.data (), event->stack.size ());
+		}
+	      p = end;
+	    }
 	  else
 	    {
 	      ULONGEST pnum;
@@ -8553,6 +8852,22 @@ remote_target::process_stop_reply (stop_reply_up stop_reply,
 	    regcache->raw_supply (reg.num, reg.data.get ());
 	}
 
+      /* Seed the stack cache with the top of the stack, so that
+	 unwinding the stopped thread doesn't need to read it again.
+	 The thread has not run since the stub read it.  In non-stop
+	 mode, other threads may have written to it meanwhile, but the
+	 stack cache already assumes they don't: it is only flushed
+	 when handling events, like here.  */
+      if (!stop_reply->stack.empty ()
+	  && stack_cache_enabled_p ())
+	{
+	  inferior *inf = find_inferior_ptid (this, ptid);
+
+	  dcache_prime (target_dcache_get_or_init (inf->pspace->aspace),
+			this, ptid, stop_reply->stack_addr,
+			stop_reply->stack.data (), stop_reply->stack.size ());
+	}
+
       remote_thread_info *remote_thr = get_remote_thread_info (this, ptid);
       remote_thr->core = stop_reply->core;
       remote_thr->stop_reason = stop_reply->stop_reason;
@@ -9036,10 +9351,144 @@ remote_target::process_g_packet (struct regcache *regcache)
     }
 }
 
+/* Copy the registers of thread PTID fetched by prefetch_registers, if
+   any, to the remote buffer, as if they had just been received in
+   reply to a 'g' request.  Returns false if there are none.  */
+
+bool
+remote_target::take_prefetched_registers (ptid_t ptid)
+{
+  struct remote_state *rs = get_remote_state ();
+  thread_info *tp = this->find_thread (ptid);
+
+  /* A traceframe's registers are not those of the live thread.  */
+  if (tp == nullptr || get_traceframe_number () != -1)
+    return false;
+
+  remote_thread_info *priv = get_remote_thread_info (tp);
+  if (priv->prefetched_registers.empty ())
+    return false;
+
+  size_t len = priv->prefetched_registers.size ();
+  if (rs->buf.size () < len + 1)
+    rs->buf.resize (len + 1);
+  memcpy (rs->buf.data (), priv->prefetched_registers.c_str (), len + 1);
+  priv->prefetched_registers.clear ();
+  return true;
+}
+
+/* Fetch the registers of REGCACHE's thread, and those of as many other
+   stopped threads of the same process as fit in one reply, with a
+   single qRegisters request.  GDB walking the threads, as "thread
+   apply all backtrace" does, then doesn't need a 'g' request, and a
+   'Hg' request, per thread.  The registers are kept until GDB asks for
+   them, or the threads are resumed.  */
+
+void
+remote_target::prefetch_registers (struct regcache *regcache)
+{
+  struct remote_state *rs = get_remote_state ();
+  remote_arch_state *rsa = rs->get_remote_arch_state (regcache->arch ());
+  ptid_t ptid = regcache->ptid ();
+  char tid[64];
+
+  /* Each reply entry is a thread id, a colon, the registers and a
+     semicolon.  */
+  long entry_size = 2 * rsa->sizeof_g_packet + sizeof (tid) + 2;
+  long max_threads = std::min ((long) rs->registers_prefetch_batch,
+				(get_remote_packet_size () - 1) / entry_size);
+  if (max_threads < 2)
+    return;
+
+  std::string request = "qRegisters:";
+  write_ptid (tid, tid + sizeof (tid), ptid);
+  request += tid;
+  long count = 1;
+
+  for (thread_info *tp : all_non_exited_threads (this, ptid_t (ptid.pid ())))
+    {
+      if (count == max_threads)
+	break;
+
+      remote_thread_info *priv = get_remote_thread_info (tp);
+      if (tp->ptid == ptid
+	  || tp->executing ()
+	  || priv->get_resume_state () != resume_state::NOT_RESUMED
+	  || priv->registers_fetched
+	  || !priv->prefetched_registers.empty ())
+	continue;
+
+      write_ptid (tid, tid + sizeof (tid), tp->ptid);
+      if (request.size () + strlen (tid) + 2 > get_remote_packet_size ())
+	break;
+      request += ';';
+      request += tid;
+      count++;
+    }
+
+  if (count == 1)
+    return;
+
+  if (rs->registers_prefetch_batch < INT_MAX / 2)
+    rs->registers_prefetch_batch *= 2;
+
+  putpkt (request.c_str ());
+  getpkt (&rs->buf);
+  if (m_features.packet_ok (rs->buf, PACKET_qRegisters).status ()
+      != PACKET_OK)
+    return;
+
+  const char *p = rs->buf.data ();
+  while (*p != '\0')
+    {
+      ptid_t entry_ptid = read_ptid (p, &p);
+      if (*p != ':')
+	break;
+      p++;
+
+      const char *end = strchrnul (p, ';');
+      thread_info *tp = this->find_thread (entry_ptid);
+      if (tp != nullptr)
+	{
+	  remote_thread_info *priv = get_remote_thread_info (tp);
+
+	  priv->prefetched_registers.assign (p, end - p);
+	  priv->registers_fetched = true;
+	}
+
+      p = end;
+      if (*p == ';')
+	p++;
+    }
+}
+
 void
 remote_target::fetch_registers_using_g (struct regcache *regcache)
 {
-  send_g_packet ();
+  struct remote_state *rs = get_remote_state ();
+  ptid_t ptid = regcache->ptid ();
+
+  if (!take_prefetched_registers (ptid))
+    {
+      /* Fetching the registers of a second thread since the last
+	 resumption suggests GDB is walking the threads.  */
+      if (m_features.packet_support (PACKET_qRegisters) != PACKET_DISABLE
+	  && get_traceframe_number () == -1
+	  && rs->last_fetched_registers_ptid != null_ptid
+	  && rs->last_fetched_registers_ptid != ptid)
+	prefetch_registers (regcache);
+
+      if (!take_prefetched_registers (ptid))
+	{
+	  set_general_thread (ptid);
+	  send_g_packet ();
+	}
+    }
+
+  rs->last_fetched_registers_ptid = ptid;
+  if (thread_info *tp = this->find_thread (ptid); tp != nullptr)
+    get_remote_thread_info (tp)->registers_fetched = true;
+
   process_g_packet (regcache);
 }
 
@@ -9075,7 +9524,6 @@ remote_target::fetch_registers (struct regcache *regcache, int regnum)
   int i;
 
   set_remote_traceframe ();
-  set_general_thread (regcache->ptid ());
 
   if (regnum >= 0)
     {
@@ -9094,6 +9542,7 @@ remote_target::fetch_registers (struct regcache *regcache, int regnum)
 	    return;
 	}
 
+      set_general_thread (regcache->ptid ());
       if (fetch_register_using_p (regcache, reg))
 	return;
 
@@ -9107,11 +9556,14 @@ remote_target::fetch_registers (struct regcache *regcache, int regnum)
 
   for (i = 0; i < gdbarch_num_regs (gdbarch); i++)
     if (!rsa->regs[i].in_g_packet)
-      if (!fetch_register_using_p (regcache, &rsa->regs[i]))
-	{
-	  /* This register is not available.  */
-	  regcache->raw_supply (i, NULL);
-	}
+      {
+	set_general_thread (regcache->ptid ());
+	if (!fetch_register_using_p (regcache, &rsa->regs[i]))
+	  {
+	    /* This register is not available.  */
+	    regcache->raw_supply (i, NULL);
+	  }
+      }
 }
 
 /* Prepare to store registers.  Since we may send them all (using a
@@ -9236,6 +9688,11 @@ remote_target::store_registers (struct regcache *regcache, int regnum)
   set_remote_traceframe ();
   set_general_thread (regcache->ptid ());
 
+  /* Registers fetched ahead of time would be stale after this.  */
+  if (thread_info *tp = this->find_thread (regcache->ptid ());
+      tp != nullptr)
+    get_remote_thread_info (tp)->prefetched_registers.clear ();
+
   if (regnum >= 0)
     {
       packet_reg *reg = packet_reg_from_regnum (gdbarch, rsa, regnum);
@@ -9625,6 +10082,12 @@ remote_target::remote_write_bytes (CORE_ADDR memaddr, const gdb_byte *myaddr,
 				 packet_format[0], 1);
 }
 
+/* The maximum number of "m" packets one memory read sends, when the
+   stub accepts pipelined requests.  This bounds how long a single
+   read can take.  */
+
+#define REMOTE_PIPELINE_MAX_MEMORY_REQUESTS 64
+
 /* Read memory data directly from the remote machine.
    This does not use the data cache; the data cache uses this.
    MEMADDR is the address in the remote memory space.
@@ -9658,25 +10121,58 @@ remote_target::remote_read_bytes_1 (CORE_ADDR memaddr, gdb_byte *myaddr,
   todo_units = std::min (len_units,
 			 (ULONGEST) (buf_size_bytes / unit_size) / 2);
 
-  /* Construct "m"<memaddr>","<len>".  */
-  memaddr = remote_address_masked (memaddr);
-  p = rs->buf.data ();
-  *p++ = 'm';
-  p += hexnumstr (p, (ULONGEST) memaddr);
-  *p++ = ',';
-  p += hexnumstr (p, (ULONGEST) todo_units);
-  *p = '\0';
-  putpkt (rs->buf);
-  getpkt (&rs->buf);
-  packet_result result = packet_check_result (rs->buf);
-  if (result.status () == PACKET_ERROR)
+  /* If the stub can take several requests at once, read more than a
+     packet's worth, with one "m" packet per packet's worth.  */
+  int count = 1;
+  if (len_units > todo_units && pipeline_window () > 1)
+    count = std::min<ULONGEST> ((len_units + todo_units - 1) / todo_units,
+				REMOTE_PIPELINE_MAX_MEMORY_REQUESTS);
+
+  ULONGEST done_units = 0;
+  bool io_error = false;
+  pipeline_packets
+    (count,
+     [&] (int i)
+       {
+	 ULONGEST start = i * todo_units;
+	 ULONGEST units = std::min (len_units - start, (ULONGEST) todo_units);
+	 char buf[3 + 4 * sizeof (ULONGEST)];
+
+	 /* Construct "m"<memaddr>","<len>".  */
+	 p = buf;
+	 *p++ = 'm';
+	 p += hexnumstr (p, (ULONGEST) remote_address_masked (memaddr + start));
+	 *p++ = ',';
+	 p += hexnumstr (p, units);
+	 return std::string (buf, p - buf);
+       },
+     [&] (int i, int len)
+       {
+	 ULONGEST start = i * todo_units;
+	 ULONGEST units = std::min (len_units - start, (ULONGEST) todo_units);
+
+	 uncompress_reply (len);
+	 packet_result result = packet_check_result (rs->buf);
+	 if (result.status () == PACKET_ERROR)
+	   {
+	     io_error = i == 0;
+	     return false;
+	   }
+
+	 /* Reply describes memory byte by byte, each byte encoded as
+	    two hex characters.  */
+	 decoded_bytes = hex2bin (rs->buf.data (),
+				  myaddr + start * unit_size,
+				  units * unit_size);
+	 done_units += decoded_bytes / unit_size;
+	 return decoded_bytes == units * unit_size;
+       });
+
+  if (io_error)
     return TARGET_XFER_E_IO;
-  /* Reply describes memory byte by byte, each byte encoded as two hex
-     characters.  */
-  p = rs->buf.data ();
-  decoded_bytes = hex2bin (p, myaddr, todo_units * unit_size);
+
   /* Return what we have.  Let higher layers handle partial reads.  */
-  *xfered_len_units = (ULONGEST) (decoded_bytes / unit_size);
+  *xfered_len_units = done_units;
   return (*xfered_len_units != 0) ? TARGET_XFER_OK : TARGET_XFER_EOF;
 }
 
@@ -9935,6 +10431,51 @@ remote_target::readchar (int timeout)
   return ch;
 }
 
+/* Read LEN bytes the remote sent outside of any packet, such as the
+   file data following a vFile:bulkread reply, into BUF.  Losing some
+   of those bytes leaves the connection out of sync, so unlike
+   readchar, this closes the target and throws on timeouts too.  */
+
+void
+remote_target::read_raw (gdb_byte *buf, int len)
+{
+  struct remote_state *rs = get_remote_state ();
+  int status;
+
+  try
+    {
+      scoped_restore restore_quit_target
+	= make_scoped_restore (&curr_quit_handler_target, this);
+      scoped_restore restore_quit
+	= make_scoped_restore (&quit_handler, ::remote_serial_quit_handler);
+
+      rs->got_ctrlc_during_io = 0;
+
+      status = serial_read (rs->remote_desc, buf, len, remote_timeout);
+
+      if (rs->got_ctrlc_during_io)
+	set_quit_flag ();
+    }
+  catch (const gdb_exception_error &ex)
+    {
+      remote_unpush_target (this);
+      throw_error (TARGET_CLOSE_ERROR,
+		   _("Remote communication error.  "
+		     "Target disconnected: %s"),
+		   ex.what ());
+    }
+
+  if (status == 0)
+    return;
+
+  remote_unpush_target (this);
+  if (status == SERIAL_EOF)
+    throw_error (TARGET_CLOSE_ERROR, _("Remote connection closed"));
+  throw_error (TARGET_CLOSE_ERROR,
+	       _("Remote communication error.  "
+		 "Target disconnected: timeout reading file data"));
+}
+
 /* Wrapper for serial_write that closes the target and throws if
    writing fails.  The current quit handler is overridden to avoid
    quitting in the middle of packet sequence, as that would break
@@ -10498,6 +11039,143 @@ remote_target::getpkt (gdb::char_vector *buf, bool forever, bool *is_notif)
     }
 }
 
+/* The maximum number of packets "set remote pipeline-window" lets
+   GDB send without waiting for their replies.  */
+
+static unsigned int remote_pipeline_window = 16;
+
+static void
+show_remote_pipeline_window (struct ui_file *file, int from_tty,
+			     struct cmd_list_element *c, const char *value)
+{
+  gdb_printf (file, _("The maximum number of outstanding remote "
+		      "requests is %s.\n"), value);
+}
+
+/* Return how many requests may be outstanding at once.  Pipelining
+   needs no-ack mode, as an ack can't tell which packet it is for, and
+   a stub that says it reads packets while it's busy replying to
+   earlier ones.  */
+
+int
+remote_target::pipeline_window ()
+{
+  struct remote_state *rs = get_remote_state ();
+
+  if (!rs->noack_mode || rs->packet_pipeline <= 1)
+    return 1;
+
+  return std::max (1, std::min (rs->packet_pipeline,
+				(int) std::min (remote_pipeline_window,
+						(unsigned int) INT_MAX)));
+}
+
+/* Send COUNT requests, built by BUILD_REQUEST from their index, and
+   pass each reply to HANDLE_REPLY, with the index of its request and
+   the length returned by getpkt.  The reply is in the packet buffer.
+
+   Up to the pipeline window of requests are kept outstanding, so
+   that bulk transfers don't pay a round trip per packet.  The stub
+   replies in order, so the index of the request each reply is for is
+   just the oldest outstanding one.  Once HANDLE_REPLY returns false,
+   e.g., on an error or a short read, no more requests are sent, and
+   the replies to those already sent are read and dropped.  Return the
+   number of replies HANDLE_REPLY accepted, which are those for the
+   first requests.  */
+
+int
+remote_target::pipeline_packets
+  (int count, gdb::function_view<std::string (int)> build_request,
+   gdb::function_view<bool (int, int)> handle_reply)
+{
+  struct remote_state *rs = get_remote_state ();
+  int window = pipeline_window ();
+  std::deque<int> outstanding;
+  int next = 0;
+  int accepted = 0;
+  bool done = false;
+
+  try
+    {
+      while (!outstanding.empty () || (!done && next < count))
+	{
+	  while (!done && next < count && outstanding.size () < window)
+	    {
+	      std::string request = build_request (next);
+
+	      putpkt_binary (request.data (), request.size ());
+	      outstanding.push_back (next++);
+	    }
+
+	  int tag = outstanding.front ();
+	  int len = getpkt (&rs->buf);
+	  outstanding.pop_front ();
+
+	  if (done)
+	    continue;
+	  if (handle_reply (tag, len))
+	    accepted++;
+	  else
+	    done = true;
+	}
+    }
+  catch (const gdb_exception &ex)
+    {
+      /* If the connection is gone, there is nothing left to read.  */
+      if (ex.error == TARGET_CLOSE_ERROR)
+	throw;
+
+      /* Otherwise, keep the stub and us in sync.  */
+      for (size_t i = 0; i < outstanding.size (); i++)
+	getpkt (&rs->buf);
+      throw;
+    }
+
+  return accepted;
+}
+
+/* If the reply of LEN bytes in the packet buffer, as returned by
+   getpkt, is a compressed one ("z<length>;<compressed data>"),
+   replace it with the reply it stands for, and return that one's
+   length.  Otherwise, return LEN.  The stub only sends such replies
+   to memory reads, qXfer reads and vFile:pread requests, and only
+   once compression was agreed to in qSupported.  */
+
+int
+remote_target::uncompress_reply (int len)
+{
+  struct remote_state *rs = get_remote_state ();
+
+  if (len <= 0 || rs->buf[0] != 'z'
+      || m_features.packet_support (PACKET_compression) != PACKET_ENABLE)
+    return len;
+
+  ULONGEST size;
+  const char *p = unpack_varlen_hex (rs->buf.data () + 1, &size);
+  if (*p != ';' || size > INT_MAX)
+    error (_("Malformed compressed reply from remote target."));
+  p++;
+
+  int escaped_len = len - (p - rs->buf.data ());
+  gdb::byte_vector compressed (escaped_len);
+  int compressed_len = remote_unescape_input ((const gdb_byte *) p,
+					      escaped_len, compressed.data (),
+					      compressed.size ());
+
+  /* Leave room for the terminating NUL the callers expect.  */
+  if (rs->buf.size () < size + 1)
+    rs->buf.resize (size + 1);
+
+  uLongf uncompressed_len = size;
+  if (uncompress ((Bytef *) rs->buf.data (), &uncompressed_len,
+		  compressed.data (), compressed_len) != Z_OK
+      || uncompressed_len != size)
+    error (_("Could not uncompress reply from remote target."));
+
+  rs->buf[size] = '\0';
+  return size;
+}
+
 /* Kill any new fork children of inferior INF that haven't been
    processed by follow_fork.  */
 
@@ -11104,6 +11782,87 @@ remote_target::remove_breakpoint (struct gdbarch *gdbarch,
   return memory_remove_breakpoint (this, gdbarch, bp_tgt, reason);
 }
 
+/* Insert the software breakpoints BPS if INSERT, or remove them
+   otherwise, with vZ0 or vz0 packets holding as many breakpoints as
+   fit.  The stub inserts or removes all the breakpoints of a packet,
+   or none of them.  Returns the number of leading breakpoints of BPS
+   inserted or removed.  */
+
+int
+remote_target::send_breakpoint_batch (bool insert,
+				      gdb::array_view<bp_target_info *> bps)
+{
+  /* The stub only knows about the breakpoints it inserted with Z0
+     packets.  */
+  if (m_features.packet_support (PACKET_Z0) == PACKET_DISABLE
+      || m_features.packet_support (PACKET_vZ0) == PACKET_DISABLE)
+    return 0;
+
+  /* Make sure the remote is pointing at the right process, if
+     necessary.  */
+  if (!gdbarch_has_global_breakpoints (current_inferior ()->arch ()))
+    set_general_process ();
+
+  struct remote_state *rs = get_remote_state ();
+
+  /* Room for an address, a kind and their separators.  */
+  const int entry_size = 2 * sizeof (ULONGEST) + 16;
+  size_t done = 0;
+
+  while (done < bps.size ())
+    {
+      char *p = rs->buf.data ();
+      char *endbuf = p + get_remote_packet_size ();
+      int count = 0;
+
+      p += xsnprintf (p, endbuf - p, "%s", insert ? "vZ0:" : "vz0:");
+      for (bp_target_info *bp_tgt : bps.slice (done))
+	{
+	  if (endbuf - p < entry_size)
+	    break;
+
+	  /* Like insert_breakpoint and remove_breakpoint.  */
+	  CORE_ADDR addr = (insert
+			    ? bp_tgt->reqstd_address
+			    : bp_tgt->placed_address);
+
+	  if (count > 0)
+	    *(p++) = ';';
+	  p += hexnumstr (p, (ULONGEST) remote_address_masked (addr));
+	  p += xsnprintf (p, endbuf - p, ",%x", bp_tgt->kind);
+	  count++;
+	}
+
+      if (count == 0)
+	break;
+
+      putpkt (rs->buf);
+      getpkt (&rs->buf);
+
+      if (m_features.packet_ok (rs->buf, PACKET_vZ0).status () != PACKET_OK)
+	break;
+
+      done += count;
+    }
+
+  return done;
+}
+
+int
+remote_target::insert_breakpoint_batch (struct gdbarch *gdbarch,
+					gdb::array_view<bp_target_info *> bps)
+{
+  return send_breakpoint_batch (true, bps);
+}
+
+int
+remote_target::remove_breakpoint_batch (struct gdbarch *gdbarch,
+					gdb::array_view<bp_target_info *> bps,
+					enum remove_bp_reason reason)
+{
+  return send_breakpoint_batch (false, bps);
+}
+
 static enum Z_packet_type
 watchpoint_to_Z_packet (int type)
 {
@@ -11440,7 +12199,7 @@ remote_target::verify_memory (const gdb_byte *data, CORE_ADDR lma, ULONGEST size
 
       /* Be clever; compute the host_crc before waiting for target
 	 reply.  */
-      host_crc = xcrc32 (data, size, 0xffffffff);
+      host_crc = remote_crc32 (data, size, 0xffffffff);
 
       getpkt (&rs->buf);
 
@@ -11459,6 +12218,83 @@ remote_target::verify_memory (const gdb_byte *data, CORE_ADDR lma, ULONGEST size
   return simple_verify_memory (this, data, lma, size);
 }
 
+/* Verify memory a block at a time using "qCRCBlocks:" requests, each
+   asking for the CRCs of as many blocks as fit in a reply.  */
+
+int
+remote_target::verify_memory_blocks (const gdb_byte *data, CORE_ADDR lma,
+				     ULONGEST size, ULONGEST block_size,
+				     std::vector<bool> *matches)
+{
+  struct remote_state *rs = get_remote_state ();
+
+  /* It doesn't make sense to use qCRCBlocks if the remote target is
+     connected but not running.  */
+  if (!target_has_execution ()
+      || m_features.packet_support (PACKET_qCRCBlocks) == PACKET_DISABLE)
+    return beneath ()->verify_memory_blocks (data, lma, size, block_size,
+					     matches);
+
+  gdb_assert (block_size > 0);
+
+  /* Make sure the remote is pointing at the right process.  */
+  set_general_process ();
+
+  /* Each CRC in a reply takes at most eight hex digits and a
+     separator.  */
+  ULONGEST nblocks = (size + block_size - 1) / block_size;
+  ULONGEST per_request
+    = std::max<ULONGEST> (1, (get_remote_packet_size () - 2) / 9);
+  int count = (nblocks + per_request - 1) / per_request;
+
+  matches->assign (nblocks, false);
+  int accepted = pipeline_packets
+    (count,
+     [&] (int i)
+       {
+	 ULONGEST offset = i * per_request * block_size;
+	 ULONGEST len = std::min (per_request * block_size, size - offset);
+
+	 return string_printf ("qCRCBlocks:%s,%s,%s",
+			       phex_nz (lma + offset, sizeof (lma)),
+			       phex_nz (len, sizeof (len)),
+			       phex_nz (block_size, sizeof (block_size)));
+       },
+     [&] (int i, int len)
+       {
+	 if (m_features.packet_ok (rs->buf, PACKET_qCRCBlocks).status ()
+	     != PACKET_OK
+	     || rs->buf[0] != 'C')
+	   return false;
+
+	 ULONGEST first = i * per_request;
+	 ULONGEST last = std::min (nblocks, first + per_request);
+	 const char *p = &rs->buf[1];
+	 for (ULONGEST block = first; block < last; block++)
+	   {
+	     ULONGEST offset = block * block_size;
+	     ULONGEST n = std::min (block_size, size - offset);
+	     ULONGEST target_crc;
+
+	     if (block > first && *p++ != ',')
+	       return false;
+	     p = unpack_varlen_hex (p, &target_crc);
+	     (*matches)[block]
+	       = remote_crc32 (data + offset, n, 0xffffffff) == target_crc;
+	   }
+	 return *p == '\0';
+       });
+
+  if (accepted == count)
+    return 0;
+
+  /* The stub may turn out not to know the packet after all.  */
+  if (m_features.packet_support (PACKET_qCRCBlocks) == PACKET_DISABLE)
+    return beneath ()->verify_memory_blocks (data, lma, size, block_size,
+					     matches);
+  return -1;
+}
+
 /* compare-sections command
 
    With no arguments, compares each loadable section in the exec bfd
@@ -11619,38 +12455,78 @@ remote_target::remote_read_qxfer (const char *object_name,
      the target is free to respond with slightly less data.  We subtract
      five to account for the response type and the protocol frame.  */
   n = std::min<LONGEST> (get_remote_packet_size () - 5, len);
-  snprintf (rs->buf.data (), get_remote_packet_size () - 4,
-	    "qXfer:%s:read:%s:%s,%s",
-	    object_name, annex ? annex : "",
-	    phex_nz (offset, sizeof offset),
-	    phex_nz (n, sizeof n));
-  i = putpkt (rs->buf);
-  if (i < 0)
-    return TARGET_XFER_E_IO;
 
-  rs->buf[0] = '\0';
-  packet_len = getpkt (&rs->buf);
-  if (packet_len < 0
-      || m_features.packet_ok (rs->buf, which_packet).status () != PACKET_OK)
-    return TARGET_XFER_E_IO;
-
-  if (rs->buf[0] != 'l' && rs->buf[0] != 'm')
-    error (_("Unknown remote qXfer reply: %s"), rs->buf.data ());
-
-  /* 'm' means there is (or at least might be) more data after this
-     batch.  That does not make sense unless there's at least one byte
-     of data in this reply.  */
-  if (rs->buf[0] == 'm' && packet_len == 1)
-    error (_("Remote qXfer reply contained no data."));
+  /* If the stub can take several requests at once, ask for more than
+     a packet's worth.  Ask for half a packet per request then, so
+     that escaping can't make the stub send less than asked, which
+     would leave a hole before the data of the next request.  */
+  int count = 1;
+  if (len > n && pipeline_window () > 1)
+    {
+      n = (get_remote_packet_size () - 5) / 2;
+      count = std::min<LONGEST> ((len + n - 1) / n, pipeline_window ());
+    }
 
-  /* Got some data.  */
-  i = remote_unescape_input ((gdb_byte *) rs->buf.data () + 1,
-			     packet_len - 1, readbuf, n);
+  bool io_error = false;
+  bool saw_eof = false;
+  i = 0;
+  pipeline_packets
+    (count,
+     [&] (int req)
+       {
+	 LONGEST req_len = std::min (n, len - req * n);
+	 ULONGEST req_offset = offset + req * n;
+
+	 return string_printf ("qXfer:%s:read:%s:%s,%s",
+			       object_name, annex ? annex : "",
+			       phex_nz (req_offset, sizeof req_offset),
+			       phex_nz (req_len, sizeof req_len));
+       },
+     [&] (int req, int reply_len)
+       {
+	 LONGEST req_len = std::min (n, len - req * n);
+
+	 packet_len = uncompress_reply (reply_len);
+	 if (packet_len < 0
+	     || (m_features.packet_ok (rs->buf, which_packet).status ()
+		 != PACKET_OK))
+	   {
+	     io_error = req == 0;
+	     return false;
+	   }
+
+	 if (rs->buf[0] != 'l' && rs->buf[0] != 'm')
+	   error (_("Unknown remote qXfer reply: %s"), rs->buf.data ());
+
+	 /* 'm' means there is (or at least might be) more data after
+	    this batch.  That does not make sense unless there's at
+	    least one byte of data in this reply.  */
+	 if (rs->buf[0] == 'm' && packet_len == 1)
+	   error (_("Remote qXfer reply contained no data."));
+
+	 /* Got some data.  */
+	 LONGEST got
+	   = remote_unescape_input ((gdb_byte *) rs->buf.data () + 1,
+				    packet_len - 1, readbuf + req * n,
+				    req_len);
+	 i += got;
+
+	 if (rs->buf[0] == 'l')
+	   {
+	     saw_eof = true;
+	     return false;
+	   }
+
+	 return got == req_len;
+       });
+
+  if (io_error)
+    return TARGET_XFER_E_IO;
 
   /* 'l' is an EOF marker, possibly including a final block of data,
      or possibly empty.  If we have the final block of a non-empty
      object, record this fact to bypass a subsequent partial read.  */
-  if (rs->buf[0] == 'l' && offset + i > 0)
+  if (saw_eof && offset + i > 0)
     {
       rs->finished_object = xstrdup (object_name);
       rs->finished_annex = xstrdup (annex ? annex : "");
@@ -12638,8 +13514,7 @@ remote_target::remote_hostio_send_command (int command_bytes, int which_packet,
 					   int *attachment_len)
 {
   struct remote_state *rs = get_remote_state ();
-  int ret, bytes_read;
-  const char *attachment_tmp;
+  int bytes_read;
 
   if (m_features.packet_support (which_packet) == PACKET_DISABLE)
     {
@@ -12650,6 +13525,24 @@ remote_target::remote_hostio_send_command (int command_bytes, int which_packet,
   putpkt_binary (rs->buf.data (), command_bytes);
   bytes_read = getpkt (&rs->buf);
 
+  return remote_hostio_parse_reply (bytes_read, which_packet, remote_errno,
+				    attachment, attachment_len);
+}
+
+/* Parse the reply to an I/O packet, which getpkt returned BYTES_READ
+   for and left in RS->BUF.  The other arguments and the return value
+   are like for remote_hostio_send_command.  */
+
+int
+remote_target::remote_hostio_parse_reply (int bytes_read, int which_packet,
+					  fileio_error *remote_errno,
+					  const char **attachment,
+					  int *attachment_len)
+{
+  struct remote_state *rs = get_remote_state ();
+  int ret;
+  const char *attachment_tmp;
+
   /* If it timed out, something is wrong.  Don't try to parse the
      buffer.  */
   if (bytes_read < 0)
@@ -12658,6 +13551,8 @@ remote_target::remote_hostio_send_command (int command_bytes, int which_packet,
       return -1;
     }
 
+  bytes_read = uncompress_reply (bytes_read);
+
   switch (m_features.packet_ok (rs->buf, which_packet).status ())
     {
     case PACKET_ERROR:
@@ -12885,6 +13780,123 @@ remote_target::remote_hostio_pread_vFile (int fd, gdb_byte *read_buf, int len,
   return ret;
 }
 
+/* Like remote_hostio_pread_vFile, but read LEN bytes with as many
+   vFile:pread packets as needed, keeping up to the pipeline window of
+   them outstanding.  Fewer bytes are read only at the end of the
+   file.  */
+
+int
+remote_target::remote_hostio_pread_pipelined (int fd, gdb_byte *read_buf,
+					      int len, ULONGEST offset,
+					      fileio_error *remote_errno)
+{
+  if (m_features.packet_support (PACKET_vFile_pread) == PACKET_DISABLE)
+    {
+      *remote_errno = FILEIO_ENOSYS;
+      return -1;
+    }
+
+  /* Ask for half a packet per request, so that escaping can't make
+     the stub send less than asked before the end of the file.  */
+  int chunk = std::max<long> (1, (get_remote_packet_size () - 32) / 2);
+  int count = (len + chunk - 1) / chunk;
+  int total = 0;
+  bool failed = false;
+
+  pipeline_packets
+    (count,
+     [&] (int i)
+       {
+	 char buf[64];
+	 char *p = buf;
+	 int left = sizeof (buf);
+
+	 remote_buffer_add_string (&p, &left, "vFile:pread:");
+	 remote_buffer_add_int (&p, &left, fd);
+	 remote_buffer_add_string (&p, &left, ",");
+	 remote_buffer_add_int (&p, &left, std::min (chunk, len - i * chunk));
+	 remote_buffer_add_string (&p, &left, ",");
+	 remote_buffer_add_int (&p, &left, offset + (ULONGEST) i * chunk);
+	 return std::string (buf, p - buf);
+       },
+     [&] (int i, int bytes_read)
+       {
+	 int want = std::min (chunk, len - i * chunk);
+	 const char *attachment;
+	 int attachment_len;
+	 fileio_error err;
+
+	 int ret = remote_hostio_parse_reply (bytes_read, PACKET_vFile_pread,
+					      &err, &attachment,
+					      &attachment_len);
+	 if (ret < 0)
+	   {
+	     if (i == 0)
+	       {
+		 *remote_errno = err;
+		 failed = true;
+	       }
+	     return false;
+	   }
+
+	 int read_len = remote_unescape_input ((gdb_byte *) attachment,
+					       attachment_len,
+					       read_buf + i * chunk, want);
+	 if (read_len != ret)
+	   error (_("Read returned %d, but %d bytes."), ret, read_len);
+
+	 total += ret;
+	 return ret == want;
+       });
+
+  return failed ? -1 : total;
+}
+
+/* Like remote_hostio_pread_vFile, but read the file with
+   vFile:bulkread, which has the stub send the data unescaped and
+   without packet framing right after its reply.  This lets a stub
+   read much more per request, directly from the file to the
+   connection.  Fewer bytes than LEN may be read.  */
+
+int
+remote_target::remote_hostio_pread_bulk (int fd, gdb_byte *read_buf, int len,
+					 ULONGEST offset,
+					 fileio_error *remote_errno)
+{
+  struct remote_state *rs = get_remote_state ();
+  char *p = rs->buf.data ();
+  int left = get_remote_packet_size ();
+
+  remote_buffer_add_string (&p, &left, "vFile:bulkread:");
+
+  remote_buffer_add_int (&p, &left, fd);
+  remote_buffer_add_string (&p, &left, ",");
+
+  remote_buffer_add_int (&p, &left, len);
+  remote_buffer_add_string (&p, &left, ",");
+
+  remote_buffer_add_int (&p, &left, offset);
+
+  int ret = remote_hostio_send_command (p - rs->buf.data (),
+					PACKET_vFile_bulkread,
+					remote_errno, NULL, NULL);
+  if (ret <= 0)
+    return ret;
+
+  if (ret > len)
+    {
+      /* We can't tell where the data ends, so the connection is
+	 lost.  */
+      remote_unpush_target (this);
+      throw_error (TARGET_CLOSE_ERROR,
+		   _("Remote sent %d bytes of file data, but %d were "
+		     "requested.  Target disconnected."), ret, len);
+    }
+
+  read_raw (read_buf, ret);
+  return ret;
+}
+
 /* See declaration.h.  */
 
 int
@@ -12932,13 +13944,44 @@ remote_target::remote_hostio_pread (int fd, gdb_byte *read_buf, int len,
   remote_debug_printf ("readahead cache miss %s",
 		       pulongest (cache->miss_count));
 
+  /* If this read follows the cached data, the file is likely being
+     read sequentially, e.g., by "remote get" or BFD.  Read ahead as
+     much as the stub lets us request at once, then.  */
+  bool sequential = (cache->fd == fd
+		     && offset == cache->offset + cache->buf.size ());
+  int window = pipeline_window ();
+
   cache->fd = fd;
   cache->offset = offset;
-  cache->buf.resize (get_remote_packet_size ());
 
-  ret = remote_hostio_pread_vFile (cache->fd, &cache->buf[0],
-				   cache->buf.size (),
-				   cache->offset, remote_errno);
+  /* The data following a vFile:bulkread reply can't be acknowledged
+     nor retransmitted, so only use it without acks.  If it fails,
+     e.g. because FD isn't a regular file, read with vFile:pread.  */
+  ret = -1;
+  if (sequential
+      && rs->noack_mode
+      && m_features.packet_support (PACKET_vFile_bulkread) != PACKET_DISABLE)
+    {
+      cache->buf.resize (REMOTE_HOSTIO_BULK_READ_SIZE);
+      ret = remote_hostio_pread_bulk (cache->fd, cache->buf.data (),
+				      cache->buf.size (),
+				      cache->offset, remote_errno);
+    }
+
+  if (ret < 0 && sequential && window > 1)
+    {
+      cache->buf.resize ((size_t) window * get_remote_packet_size () / 2);
+      ret = remote_hostio_pread_pipelined (cache->fd, cache->buf.data (),
+					   cache->buf.size (),
+					   cache->offset, remote_errno);
+    }
+  else if (ret < 0)
+    {
+      cache->buf.resize (get_remote_packet_size ());
+      ret = remote_hostio_pread_vFile (cache->fd, &cache->buf[0],
+				       cache->buf.size (),
+				       cache->offset, remote_errno);
+    }
   if (ret <= 0)
     {
       cache->invalidate_fd (fd);
@@ -16052,6 +17095,29 @@ Specify \"unlimited\" for unlimited hardware breakpoints."),
 			    NULL, show_hardware_breakpoint_limit,
 			    &remote_set_cmdlist, &remote_show_cmdlist);
 
+  add_setshow_zuinteger_cmd ("pipeline-window", no_class,
+			     &remote_pipeline_window, _("\
+Set the maximum number of outstanding remote requests."), _("\
+Show the maximum number of outstanding remote requests."), _("\
+When the remote stub supports it, bulk transfers, such as large memory\n\
+reads, file transfers and object reads, send up to this many requests\n\
+before waiting for the first reply, instead of paying a round trip per\n\
+packet.  This requires no-ack mode.  Zero or one disables pipelining."),
+			     NULL, show_remote_pipeline_window,
+			     &remote_set_cmdlist, &remote_show_cmdlist);
+
+  add_setshow_zuinteger_cmd ("stop-snapshot-stack-size", no_class,
+			     &remote_stop_snapshot_stack_size_1, _("\
+Set the number of bytes of stack sent along with stop replies."), _("\
+Show the number of bytes of stack sent along with stop replies."), _("\
+If the remote stub supports it, it sends all the registers of the\n\
+thread that stopped, and this many bytes of its stack above the stack\n\
+pointer, along with each stop reply.  This saves the round trips needed\n\
+to fetch them separately.  Zero means only the registers are sent."),
+			     set_remote_stop_snapshot_stack_size,
+			     show_remote_stop_snapshot_stack_size,
+			     &remote_set_cmdlist, &remote_show_cmdlist);
+
   add_setshow_zuinteger_cmd ("remoteaddresssize", class_obscure,
 			     &remote_address_size, _("\
 Set the maximum size of the address (in bits) in a memory packet."), _("\
@@ -16288,6 +17354,23 @@ Show the maximum size of the address (in bits) in a memory packet."), NULL,
   add_packet_config_cmd (PACKET_accept_error_message,
 			 "error-message", "error-message", 0);
 
+  add_packet_config_cmd (PACKET_QStopSnapshot, "QStopSnapshot",
+			 "stop-snapshot", 0);
+
+  add_packet_config_cmd (PACKET_compression, "compression",
+			 "compression", 0);
+
+  add_packet_config_cmd (PACKET_qCRCBlocks, "qCRCBlocks",
+			 "verify-memory-blocks", 0);
+
+  add_packet_config_cmd (PACKET_qRegisters, "qRegisters",
+			 "fetch-thread-registers", 0);
+
+  add_packet_config_cmd (PACKET_vFile_bulkread, "vFile:bulkread",
+			 "hostio-bulkread", 0);
+
+  add_packet_config_cmd (PACKET_vZ0, "vZ0", "breakpoint-batch", 0);
+
   /* Assert that we've registered "set remote foo-packet" commands
      for all packet configs.  */
   {
@@ -398,6 +398,36 @@ serial_readchar (struct serial *scb, int timeout)
   return (ch);
 }
 
+int
+serial_read (struct serial *scb, void *buf, size_t count, int timeout)
+{
+  gdb_byte *p = (gdb_byte *) buf;
+
+  while (count > 0)
+    {
+      /* Let serial_readchar wait for the data, and log it.  */
+      int ch = serial_readchar (scb, timeout);
+      if (ch < 0)
+	return ch;
+
+      *p++ = ch;
+      count--;
+
+      /* Logging goes through serial_readchar, a byte at a time.  */
+      if (serial_logfp != NULL || serial_debug_p (scb))
+	continue;
+
+      size_t n = std::min (count, (size_t) std::max (scb->bufcnt, 0));
+      memcpy (p, scb->bufp, n);
+      scb->bufp += n;
+      scb->bufcnt -= n;
+      p += n;
+      count -= n;
+    }
+
+  return 0;
+}
+
 void
 serial_write (struct serial *scb, const void *buf, size_t count)
 {
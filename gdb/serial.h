@@ -119,6 +119,13 @@ enum serial_rc {
 
 extern int serial_readchar (struct serial *scb, int timeout);
 
+/* Read COUNT bytes from SCB into BUF, like as many serial_readchar
+   calls would, but copying the data already received in one go.
+   Returns zero on success, or the serial_readchar error code.  */
+
+extern int serial_read (struct serial *scb, void *buf, size_t count,
+			int timeout);
+
 /* Write COUNT bytes from BUF to the port SCB.  Throws exception on
    error.  */
 
@@ -991,18 +991,34 @@ solib_add (const char *pattern, int from_tty, int readsyms)
     if (from_tty)
       add_flags |= SYMFILE_VERBOSE;
 
+    /* Normally, we would read the symbols from a library only if
+       READSYMS is set.  However, we're making a small exception for
+       the pthread library, because we sometimes need the library
+       symbols to be loaded in order to provide thread support
+       (x86-linux for instance).  */
+    auto add_this_solib = [&] (const solib &so)
+      {
+	return readsyms || libpthread_solib_p (so);
+      };
+
+    /* Objfiles can only be created one at a time, but the symbol
+       tables of the libraries can be read in parallel beforehand.
+       This matters when attaching to a process that has many
+       libraries loaded.  */
+    std::vector<bfd *> read_ahead_bfds;
+    for (solib &gdb : current_program_space->solibs ())
+      if ((!pattern || re_exec (gdb.so_name.c_str ()))
+	  && add_this_solib (gdb)
+	  && !gdb.symbols_loaded
+	  && gdb.abfd != nullptr)
+	read_ahead_bfds.push_back (gdb.abfd.get ());
+    symfile_read_ahead (read_ahead_bfds);
+
     for (solib &gdb : current_program_space->solibs ())
       if (!pattern || re_exec (gdb.so_name.c_str ()))
 	{
-	  /* Normally, we would read the symbols from that library
-	     only if READSYMS is set.  However, we're making a small
-	     exception for the pthread library, because we sometimes
-	     need the library symbols to be loaded in order to provide
-	     thread support (x86-linux for instance).  */
-	  const int add_this_solib = (readsyms || libpthread_solib_p (gdb));
-
 	  any_matches = true;
-	  if (add_this_solib)
+	  if (add_this_solib (gdb))
 	    {
 	      if (gdb.symbols_loaded)
 		{
@@ -814,6 +814,7 @@ static const struct sym_fns debug_sym_fns =
   debug_sym_read_linetable,
   debug_sym_relocate,
   &debug_sym_probe_fns,
+  nullptr,			/* sym_read_ahead: not objfile-specific.  */
 };
 
 /* Install the debugging versions of the symfile functions for OBJFILE.
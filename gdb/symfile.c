@@ -47,12 +47,16 @@
 #include "stack.h"
 #include "gdb_bfd.h"
 #include "cli/cli-utils.h"
+#include "cli/cli-option.h"
+#include "memattr.h"
 #include "gdbsupport/byte-vector.h"
 #include "gdbsupport/pathstuff.h"
 #include "gdbsupport/selftest.h"
 #include "cli/cli-style.h"
 #include "gdbsupport/forward-scope-exit.h"
 #include "gdbsupport/buildargv.h"
+#include "gdbsupport/parallel-for.h"
+#include "gdbsupport/scope-exit.h"
 
 #include <sys/types.h>
 #include <fcntl.h>
@@ -60,6 +64,7 @@
 #include <ctype.h>
 #include <chrono>
 #include <algorithm>
+#include <unordered_set>
 
 int (*deprecated_ui_load_progress_hook) (const char *section,
 					 unsigned long num);
@@ -1781,6 +1786,79 @@ add_symtab_fns (enum bfd_flavour flavour, const struct sym_fns *sf)
   symtab_fns.emplace_back (flavour, sf);
 }
 
+/* See symfile.h.  */
+
+void
+symfile_read_ahead (gdb::array_view<bfd *> bfds)
+{
+  using read_ahead_item = std::pair<bfd *, void (*) (bfd *)>;
+  std::vector<read_ahead_item> items;
+  std::unordered_set<bfd *> seen;
+
+  for (bfd *abfd : bfds)
+    {
+      /* Several shared libraries can share a BFD, but a BFD must
+	 only be used by one thread at a time.  */
+      if (abfd == nullptr || !seen.insert (abfd).second)
+	continue;
+
+      /* Reading a BFD opened through the target's filesystem sends
+	 remote protocol packets, which only the main thread may
+	 do.  */
+      if (is_target_filename (bfd_get_filename (abfd))
+	  && !target_filesystem_is_local ())
+	continue;
+
+      const struct sym_fns *sf;
+      try
+	{
+	  sf = find_sym_fns (abfd);
+	}
+      catch (const gdb_exception_error &except)
+	{
+	  /* The error is reported when the objfile is created.  */
+	  continue;
+	}
+
+      if (sf != nullptr && sf->sym_read_ahead != nullptr)
+	items.emplace_back (abfd, sf->sym_read_ahead);
+    }
+
+  /* There is nothing to gain from reading a single BFD ahead of
+     time.  */
+  if (items.size () < 2)
+    return;
+
+  std::vector<complaint_collection> complaints (items.size ());
+  gdb::parallel_for_each (1, items.begin (), items.end (),
+    [&] (std::vector<read_ahead_item>::iterator first,
+	 std::vector<read_ahead_item>::iterator last)
+    {
+      SCOPE_EXIT { bfd_thread_cleanup (); };
+
+      /* Ensure that complaints are handled correctly.  */
+      complaint_interceptor complaint_handler;
+
+      for (auto iter = first; iter != last; ++iter)
+	{
+	  try
+	    {
+	      iter->second (iter->first);
+	    }
+	  catch (const gdb_exception &except)
+	    {
+	      /* Reading ahead is only an optimization.  Whatever went
+		 wrong is reported again when the objfile is read.  */
+	    }
+	}
+
+      complaints[first - items.begin ()] = complaint_handler.release ();
+    });
+
+  for (const complaint_collection &collection : complaints)
+    re_emit_complaints (collection);
+}
+
 /* Initialize OBJFILE to read symbols from its associated BFD.  It
    either returns or calls error().  The result is an initialized
    struct sym_fns in the objfile structure, that contains cached
@@ -1805,11 +1883,66 @@ find_sym_fns (bfd *abfd)
 }
 
 
+/* If true, "load" only sends the parts of the file that differ from
+   what the target's memory already holds.  Set by "load -delta".  */
+
+static bool load_delta = false;
+
+/* The options for the "load" command.  */
+
+struct load_options
+{
+  /* For "-delta".  */
+  bool delta = false;
+};
+
+static const gdb::option::option_def load_option_defs[] = {
+
+  gdb::option::flag_option_def<load_options> {
+    "delta",
+    [] (load_options *opts) { return &opts->delta; },
+    N_("Only send the blocks that differ from the target's memory."),
+  },
+
+};
+
+/* Create an option_def_group for the "load" options, with OPTS as
+   context.  */
+
+static gdb::option::option_def_group
+make_load_options_def_group (load_options *opts)
+{
+  return {{load_option_defs}, opts};
+}
+
+/* Completer for the "load" command.  */
+
+static void
+load_command_completer (struct cmd_list_element *ignore,
+			completion_tracker &tracker,
+			const char *text, const char *word)
+{
+  const auto group = make_load_options_def_group (nullptr);
+  if (gdb::option::complete_options
+      (tracker, &text, gdb::option::PROCESS_OPTIONS_UNKNOWN_IS_OPERAND, group))
+    return;
+
+  word = advance_to_filename_complete_word_point (tracker, text);
+  filename_completer (ignore, tracker, text, word);
+}
+
 /* This function runs the load command of our current target.  */
 
 static void
 load_command (const char *arg, int from_tty)
 {
+  load_options opts;
+  const auto group = make_load_options_def_group (&opts);
+  gdb::option::process_options
+    (&arg, gdb::option::PROCESS_OPTIONS_UNKNOWN_IS_OPERAND, group);
+  if (arg != nullptr && *arg == '\0')
+    arg = nullptr;
+
   dont_repeat ();
 
   /* The user might be reloading because the binary has changed.  Take
@@ -1844,6 +1977,8 @@ load_command (const char *arg, int from_tty)
 	}
     }
 
+  scoped_restore restore_load_delta
+    = make_scoped_restore (&load_delta, opts.delta);
   target_load (arg, from_tty);
 
   /* After re-loading the executable, we don't really know which
@@ -1898,18 +2033,13 @@ struct load_section_data
     : progress_data (progress_data_)
   {}
 
-  ~load_section_data ()
-  {
-    for (auto &&request : requests)
-      {
-	xfree (request.data);
-	delete ((load_progress_section_data *) request.baton);
-      }
-  }
-
   CORE_ADDR load_offset = 0;
   struct load_progress_data *progress_data;
   std::vector<struct memory_write_request> requests;
+
+  /* The section contents and progress batons REQUESTS point to.  */
+  std::vector<gdb::unique_xmalloc_ptr<gdb_byte>> buffers;
+  std::vector<std::unique_ptr<load_progress_section_data>> batons;
 };
 
 /* Target write callback routine for progress reporting.  */
@@ -2001,9 +2131,109 @@ load_one_section (bfd *abfd, asection *asec,
     = new load_progress_section_data (args->progress_data, sect_name, size,
 				      begin, buffer);
 
+  args->buffers.emplace_back (buffer);
+  args->batons.emplace_back (section_data);
   args->requests.emplace_back (begin, end, buffer, section_data);
 }
 
+/* The size of the blocks "load -delta" compares with the target's
+   memory.  Smaller blocks send less of a file with scattered changes,
+   at the cost of more checksums.  */
+
+#define LOAD_DELTA_BLOCK_SIZE 0x1000
+
+/* Return true if any of [BEGIN, END) is flash memory.  */
+
+static bool
+load_range_in_flash (ULONGEST begin, ULONGEST end)
+{
+  for (ULONGEST addr = begin; addr < end; )
+    {
+      mem_region *region = lookup_mem_region (addr);
+
+      if (region->attrib.mode == MEM_FLASH)
+	return true;
+      if (region->hi == 0 || region->hi <= addr)
+	break;
+      addr = region->hi;
+    }
+  return false;
+}
+
+/* Drop from the requests in ARGS the blocks that the target's memory
+   already holds, as "load -delta" does.  Return the number of bytes
+   dropped.  */
+
+static ULONGEST
+load_drop_unchanged (load_section_data *args)
+{
+  std::vector<memory_write_request> requests;
+  std::vector<memory_write_request> flash_requests;
+  bool flash_unchanged = true;
+  ULONGEST flash_size = 0;
+  ULONGEST dropped = 0;
+
+  for (const memory_write_request &r : args->requests)
+    {
+      ULONGEST size = r.end - r.begin;
+
+      /* Flash is erased a whole block at a time, and whatever isn't
+	 written back is lost, so write all of it or none of it.  */
+      if (load_range_in_flash (r.begin, r.end))
+	{
+	  if (flash_unchanged)
+	    flash_unchanged = target_verify_memory (r.data, r.begin, size) == 1;
+	  flash_requests.push_back (r);
+	  flash_size += size;
+	  continue;
+	}
+
+      std::vector<bool> matches
+	= target_verify_memory_blocks (r.data, r.begin, size,
+				       LOAD_DELTA_BLOCK_SIZE);
+      if (matches.empty ())
+	{
+	  requests.push_back (r);
+	  continue;
+	}
+
+      /* Send each run of differing blocks as its own request.  */
+      auto *section = (load_progress_section_data *) r.baton;
+      for (size_t i = 0; i < matches.size (); )
+	{
+	  size_t j = i;
+	  while (j < matches.size () && matches[j] == matches[i])
+	    j++;
+
+	  ULONGEST start = i * LOAD_DELTA_BLOCK_SIZE;
+	  ULONGEST end = std::min<ULONGEST> (j * LOAD_DELTA_BLOCK_SIZE, size);
+	  if (matches[i])
+	    dropped += end - start;
+	  else
+	    {
+	      auto *baton
+		= new load_progress_section_data (section->cumulative,
+						  section->section_name,
+						  end - start, r.begin + start,
+						  r.data + start);
+	      args->batons.emplace_back (baton);
+	      requests.emplace_back (r.begin + start, r.begin + end,
+				     r.data + start, baton);
+	    }
+	  i = j;
+	}
+    }
+
+  if (flash_unchanged)
+    dropped += flash_size;
+  else
+    requests.insert (requests.end (), flash_requests.begin (),
+		     flash_requests.end ());
+
+  args->requests = std::move (requests);
+  return dropped;
+}
+
 static void print_transfer_performance (struct ui_file *stream,
 					unsigned long data_count,
 					unsigned long write_count,
@@ -2061,6 +2291,13 @@ generic_load (const char *args, int from_tty)
 
   steady_clock::time_point start_time = steady_clock::now ();
 
+  ULONGEST unchanged = 0;
+  if (load_delta)
+    {
+      unchanged = load_drop_unchanged (&cbdata);
+      total_progress.total_size -= unchanged;
+    }
+
   if (target_write_memory_blocks (cbdata.requests, flash_discard,
 				  load_progress) != 0)
     error (_("Load failed"));
@@ -2073,6 +2310,11 @@ generic_load (const char *args, int from_tty)
   uiout->field_core_addr ("address", current_inferior ()->arch (), entry);
   uiout->text (", load size ");
   uiout->field_unsigned ("load-size", total_progress.data_count);
+  if (load_delta)
+    {
+      uiout->text (", unchanged ");
+      uiout->field_unsigned ("unchanged-size", unchanged);
+    }
   uiout->text ("\n");
   regcache_write_pc (get_thread_regcache (inferior_thread ()), entry);
 
@@ -3868,11 +4110,14 @@ that lies within the boundaries of this symbol file in memory."),
   c = add_cmd ("load", class_files, load_command, _("\
 Dynamically load FILE into the running program.\n\
 FILE symbols are recorded for access from GDB.\n\
-Usage: load [FILE] [OFFSET]\n\
+Usage: load [-delta] [FILE] [OFFSET]\n\
 An optional load OFFSET may also be given as a literal address.\n\
 When OFFSET is provided, FILE must also be provided.  FILE can be provided\n\
-on its own."), &cmdlist);
-  set_cmd_completer (c, filename_completer);
+on its own.\n\
+With -delta, only the blocks of FILE that differ from the target's memory\n\
+are sent, which the target may be able to check without sending the memory\n\
+back."), &cmdlist);
+  set_cmd_completer_handle_brkchars (c, load_command_completer);
 
   cmd_list_element *overlay_cmd
     = add_basic_prefix_cmd ("overlay", class_support,
@@ -173,6 +173,15 @@ struct sym_fns
   /* If non-NULL, this objfile has probe support, and all the probe
      functions referred to here will be non-NULL.  */
   const struct sym_probe_fns *sym_probe_fns;
+
+  /* If non-NULL, read the parts of ABFD's symbol tables that do not
+     depend on an objfile, and keep them with ABFD so that a later
+     sym_read of an objfile for ABFD does not have to.  This may be
+     called from a worker thread, concurrently with calls for other
+     BFDs, see symfile_read_ahead.  Errors may be thrown; they are
+     ignored, and reported again by sym_read.  */
+
+  void (*sym_read_ahead) (bfd *abfd);
 };
 
 extern section_addr_info
@@ -221,6 +230,14 @@ extern void add_compunit_symtab_to_objfile (struct compunit_symtab *cu);
 
 extern void add_symtab_fns (enum bfd_flavour flavour, const struct sym_fns *);
 
+/* Call the sym_read_ahead method of the symbol reader of each of
+   BFDS, in parallel on the worker threads.  This is used before
+   adding many objfiles at once, for example the shared libraries of
+   a process that was just attached to, so that the expensive reading
+   of their symbol tables is not done one objfile after another.  */
+
+extern void symfile_read_ahead (gdb::array_view<bfd *> bfds);
+
 extern void clear_symtab_users (symfile_add_flags add_flags);
 
 extern enum language deduce_language_from_filename (const char *);
@@ -182,6 +182,10 @@ static std::string
 target_debug_print_std_vector_mem_region (const std::vector<mem_region> &vec)
 { return host_address_to_string (vec.data ()); }
 
+static std::string
+target_debug_print_std_vector_bool_p (std::vector<bool> *vec)
+{ return host_address_to_string (vec); }
+
 static std::string
 target_debug_print_std_vector_static_tracepoint_marker
   (const std::vector<static_tracepoint_marker> &vec)
@@ -277,6 +281,16 @@ target_debug_print_gdb_array_view_const_int
   (const gdb::array_view<const int> &view)
 { return host_address_to_string (view.data ()); }
 
+static std::string
+target_debug_print_gdb_array_view_memory_read_request
+  (const gdb::array_view<memory_read_request> &view)
+{ return pulongest (view.size ()); }
+
+static std::string
+target_debug_print_gdb_array_view_bp_target_info_p
+  (const gdb::array_view<bp_target_info *> &view)
+{ return pulongest (view.size ()); }
+
 static std::string
 target_debug_print_record_print_flags (record_print_flags flags)
 { return plongest (flags); }
@@ -42,6 +42,8 @@ struct dummy_target : public target_ops
   void files_info () override;
   int insert_breakpoint (struct gdbarch *arg0, struct bp_target_info *arg1) override;
   int remove_breakpoint (struct gdbarch *arg0, struct bp_target_info *arg1, enum remove_bp_reason arg2) override;
+  int insert_breakpoint_batch (struct gdbarch *arg0, gdb::array_view<bp_target_info *> arg1) override;
+  int remove_breakpoint_batch (struct gdbarch *arg0, gdb::array_view<bp_target_info *> arg1, enum remove_bp_reason arg2) override;
   bool stopped_by_sw_breakpoint () override;
   bool supports_stopped_by_sw_breakpoint () override;
   bool stopped_by_hw_breakpoint () override;
@@ -116,6 +118,7 @@ struct dummy_target : public target_ops
   CORE_ADDR get_thread_local_address (ptid_t arg0, CORE_ADDR arg1, CORE_ADDR arg2) override;
   enum target_xfer_status xfer_partial (enum target_object arg0, const char *arg1, gdb_byte *arg2, const gdb_byte *arg3, ULONGEST arg4, ULONGEST arg5, ULONGEST *arg6) override;
   ULONGEST get_memory_xfer_limit () override;
+  bool read_memory_batch (gdb::array_view<memory_read_request> arg0) override;
   std::vector<mem_region> memory_map () override;
   void flash_erase (ULONGEST arg0, LONGEST arg1) override;
   void flash_done () override;
@@ -159,6 +162,7 @@ struct dummy_target : public target_ops
   bool set_trace_notes (const char *arg0, const char *arg1, const char *arg2) override;
   int core_of_thread (ptid_t arg0) override;
   int verify_memory (const gdb_byte *arg0, CORE_ADDR arg1, ULONGEST arg2) override;
+  int verify_memory_blocks (const gdb_byte *arg0, CORE_ADDR arg1, ULONGEST arg2, ULONGEST arg3, std::vector<bool> *arg4) override;
   bool get_tib_address (ptid_t arg0, CORE_ADDR *arg1) override;
   void set_permissions () override;
   bool static_tracepoint_marker_at (CORE_ADDR arg0, static_tracepoint_marker *arg1) override;
@@ -219,6 +223,8 @@ struct debug_target : public target_ops
   void files_info () override;
   int insert_breakpoint (struct gdbarch *arg0, struct bp_target_info *arg1) override;
   int remove_breakpoint (struct gdbarch *arg0, struct bp_target_info *arg1, enum remove_bp_reason arg2) override;
+  int insert_breakpoint_batch (struct gdbarch *arg0, gdb::array_view<bp_target_info *> arg1) override;
+  int remove_breakpoint_batch (struct gdbarch *arg0, gdb::array_view<bp_target_info *> arg1, enum remove_bp_reason arg2) override;
   bool stopped_by_sw_breakpoint () override;
   bool supports_stopped_by_sw_breakpoint () override;
   bool stopped_by_hw_breakpoint () override;
@@ -293,6 +299,7 @@ struct debug_target : public target_ops
   CORE_ADDR get_thread_local_address (ptid_t arg0, CORE_ADDR arg1, CORE_ADDR arg2) override;
   enum target_xfer_status xfer_partial (enum target_object arg0, const char *arg1, gdb_byte *arg2, const gdb_byte *arg3, ULONGEST arg4, ULONGEST arg5, ULONGEST *arg6) override;
   ULONGEST get_memory_xfer_limit () override;
+  bool read_memory_batch (gdb::array_view<memory_read_request> arg0) override;
   std::vector<mem_region> memory_map () override;
   void flash_erase (ULONGEST arg0, LONGEST arg1) override;
   void flash_done () override;
@@ -336,6 +343,7 @@ struct debug_target : public target_ops
   bool set_trace_notes (const char *arg0, const char *arg1, const char *arg2) override;
   int core_of_thread (ptid_t arg0) override;
   int verify_memory (const gdb_byte *arg0, CORE_ADDR arg1, ULONGEST arg2) override;
+  int verify_memory_blocks (const gdb_byte *arg0, CORE_ADDR arg1, ULONGEST arg2, ULONGEST arg3, std::vector<bool> *arg4) override;
   bool get_tib_address (ptid_t arg0, CORE_ADDR *arg1) override;
   void set_permissions () override;
   bool static_tracepoint_marker_at (CORE_ADDR arg0, static_tracepoint_marker *arg1) override;
@@ -655,6 +663,59 @@ debug_target::remove_breakpoint (struct gdbarch *arg0, struct bp_target_info *ar
   return result;
 }
 
+int
+target_ops::insert_breakpoint_batch (struct gdbarch *arg0, gdb::array_view<bp_target_info *> arg1)
+{
+  return this->beneath ()->insert_breakpoint_batch (arg0, arg1);
+}
+
+int
+dummy_target::insert_breakpoint_batch (struct gdbarch *arg0, gdb::array_view<bp_target_info *> arg1)
+{
+  return 0;
+}
+
+int
+debug_target::insert_breakpoint_batch (struct gdbarch *arg0, gdb::array_view<bp_target_info *> arg1)
+{
+  target_debug_printf_nofunc ("-> %s->insert_breakpoint_batch (...)", this->beneath ()->shortname ());
+  int result
+    = this->beneath ()->insert_breakpoint_batch (arg0, arg1);
+  target_debug_printf_nofunc ("<- %s->insert_breakpoint_batch (%s, %s) = %s",
+	      this->beneath ()->shortname (),
+	      target_debug_print_gdbarch_p (arg0).c_str (),
+	      target_debug_print_gdb_array_view_bp_target_info_p (arg1).c_str (),
+	      target_debug_print_int (result).c_str ());
+  return result;
+}
+
+int
+target_ops::remove_breakpoint_batch (struct gdbarch *arg0, gdb::array_view<bp_target_info *> arg1, enum remove_bp_reason arg2)
+{
+  return this->beneath ()->remove_breakpoint_batch (arg0, arg1, arg2);
+}
+
+int
+dummy_target::remove_breakpoint_batch (struct gdbarch *arg0, gdb::array_view<bp_target_info *> arg1, enum remove_bp_reason arg2)
+{
+  return 0;
+}
+
+int
+debug_target::remove_breakpoint_batch (struct gdbarch *arg0, gdb::array_view<bp_target_info *> arg1, enum remove_bp_reason arg2)
+{
+  target_debug_printf_nofunc ("-> %s->remove_breakpoint_batch (...)", this->beneath ()->shortname ());
+  int result
+    = this->beneath ()->remove_breakpoint_batch (arg0, arg1, arg2);
+  target_debug_printf_nofunc ("<- %s->remove_breakpoint_batch (%s, %s, %s) = %s",
+	      this->beneath ()->shortname (),
+	      target_debug_print_gdbarch_p (arg0).c_str (),
+	      target_debug_print_gdb_array_view_bp_target_info_p (arg1).c_str (),
+	      target_debug_print_remove_bp_reason (arg2).c_str (),
+	      target_debug_print_int (result).c_str ());
+  return result;
+}
+
 bool
 target_ops::stopped_by_sw_breakpoint ()
 {
@@ -2441,6 +2502,31 @@ debug_target::get_memory_xfer_limit ()
   return result;
 }
 
+bool
+target_ops::read_memory_batch (gdb::array_view<memory_read_request> arg0)
+{
+  return this->beneath ()->read_memory_batch (arg0);
+}
+
+bool
+dummy_target::read_memory_batch (gdb::array_view<memory_read_request> arg0)
+{
+  return false;
+}
+
+bool
+debug_target::read_memory_batch (gdb::array_view<memory_read_request> arg0)
+{
+  target_debug_printf_nofunc ("-> %s->read_memory_batch (...)", this->beneath ()->shortname ());
+  bool result
+    = this->beneath ()->read_memory_batch (arg0);
+  target_debug_printf_nofunc ("<- %s->read_memory_batch (%s) = %s",
+	      this->beneath ()->shortname (),
+	      target_debug_print_gdb_array_view_memory_read_request (arg0).c_str (),
+	      target_debug_print_bool (result).c_str ());
+  return result;
+}
+
 std::vector<mem_region>
 target_ops::memory_map ()
 {
@@ -3469,6 +3555,35 @@ debug_target::verify_memory (const gdb_byte *arg0, CORE_ADDR arg1, ULONGEST arg2
   return result;
 }
 
+int
+target_ops::verify_memory_blocks (const gdb_byte *arg0, CORE_ADDR arg1, ULONGEST arg2, ULONGEST arg3, std::vector<bool> *arg4)
+{
+  return this->beneath ()->verify_memory_blocks (arg0, arg1, arg2, arg3, arg4);
+}
+
+int
+dummy_target::verify_memory_blocks (const gdb_byte *arg0, CORE_ADDR arg1, ULONGEST arg2, ULONGEST arg3, std::vector<bool> *arg4)
+{
+  return default_verify_memory_blocks (this, arg0, arg1, arg2, arg3, arg4);
+}
+
+int
+debug_target::verify_memory_blocks (const gdb_byte *arg0, CORE_ADDR arg1, ULONGEST arg2, ULONGEST arg3, std::vector<bool> *arg4)
+{
+  target_debug_printf_nofunc ("-> %s->verify_memory_blocks (...)", this->beneath ()->shortname ());
+  int result
+    = this->beneath ()->verify_memory_blocks (arg0, arg1, arg2, arg3, arg4);
+  target_debug_printf_nofunc ("<- %s->verify_memory_blocks (%s, %s, %s, %s, %s) = %s",
+	      this->beneath ()->shortname (),
+	      target_debug_print_const_gdb_byte_p (arg0).c_str (),
+	      target_debug_print_CORE_ADDR (arg1).c_str (),
+	      target_debug_print_ULONGEST (arg2).c_str (),
+	      target_debug_print_ULONGEST (arg3).c_str (),
+	      target_debug_print_std_vector_bool_p (arg4).c_str (),
+	      target_debug_print_int (result).c_str ());
+  return result;
+}
+
 bool
 target_ops::get_tib_address (ptid_t arg0, CORE_ADDR *arg1)
 {
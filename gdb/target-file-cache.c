@@ -0,0 +1,438 @@
+/* Caching of files read from the target's filesystem.
+
+   Copyright (C) 2024 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+/* With "set sysroot target:", the shared libraries of a remote
+   inferior are read over the remote protocol, in every session.  This
+   cache keeps local copies of them, named after their build-id.  A
+   small entry named after a hash of the file's name on the target
+   records the size, modification time and build-id of the file we
+   last fetched under that name.  When the target's fstat still
+   matches, the local copy is used without reading anything more from
+   the target.  Otherwise, the build-id is read from the target, and
+   the file is only fetched if no copy has it.  */
+
+#include "target-file-cache.h"
+#include "build-id.h"
+#include "cli/cli-cmds.h"
+#include "command.h"
+#include "dwarf2/index-write.h"
+#include "gdb_bfd.h"
+#include "gdbsupport/filestuff.h"
+#include "gdbsupport/pathstuff.h"
+
+/* When set to true, show debug messages about the target file
+   cache.  */
+static bool debug_target_file_cache = false;
+
+#define target_file_cache_debug(FMT, ...)				\
+  debug_prefixed_printf_cond_nofunc (debug_target_file_cache,		\
+				     "target-file-cache", FMT, ## __VA_ARGS__)
+
+/* Whether the cache is used, for "set/show target-file-cache
+   enabled".  */
+static bool target_file_cache_enabled = false;
+
+/* The cache directory, for "set/show target-file-cache directory".  */
+static std::string target_file_cache_directory;
+
+/* Number of files found in the cache, and fetched into it, this
+   session.  */
+static unsigned int target_file_cache_hits;
+static unsigned int target_file_cache_misses;
+
+/* set/show target-file-cache commands.  */
+static cmd_list_element *set_target_file_cache_prefix_list;
+static cmd_list_element *show_target_file_cache_prefix_list;
+
+/* Suffix of the copies of target files, named after their build-id.  */
+
+#define COPY_SUFFIX ".target-file"
+
+/* Suffix of the entries mapping target file names to build-ids.  */
+
+#define NAME_ENTRY_SUFFIX ".target-name"
+
+/* How much to read from the target at once when fetching a file.  */
+
+#define FETCH_CHUNK_SIZE (1024 * 1024)
+
+/* Return the base name of the entry for target file FILENAME.  Hash
+   collisions only make entries replace each other, as they hold the
+   full name.  */
+
+static std::string
+name_entry_basename (const char *filename)
+{
+  size_t len = strlen (filename);
+
+  /* Not fast_hash, whose value depends on how GDB was built.  */
+  return string_printf ("%08x%08x",
+			(unsigned int) iterative_hash (filename, len, 0),
+			(unsigned int) iterative_hash (filename, len,
+						      0x9e3779b9));
+}
+
+/* Return the contents of the entry for target file FILENAME, whose
+   target status is ST and whose build-id is BUILD_ID_STR.  */
+
+static std::string
+name_entry_contents (const char *filename, const struct stat &st,
+		     const std::string &build_id_str)
+{
+  return string_printf ("%s %s %s\n%s\n", pulongest (st.st_size),
+			plongest (st.st_mtime), build_id_str.c_str (),
+			filename);
+}
+
+/* Return the build-id the entry for target file FILENAME records, if
+   the file still has status ST on the target, or an empty string.  */
+
+static std::string
+lookup_name_entry (const char *filename, const struct stat &st)
+{
+  std::string entry_name
+    = (target_file_cache_directory + SLASH_STRING
+       + name_entry_basename (filename) + NAME_ENTRY_SUFFIX);
+
+  std::optional<std::string> contents
+    = read_text_file_to_string (entry_name.c_str ());
+  if (!contents.has_value ())
+    return {};
+
+  /* Rather than parsing the entry, see whether it is the one we would
+     write for any build-id.  */
+  std::string prefix = string_printf ("%s %s ", pulongest (st.st_size),
+				      plongest (st.st_mtime));
+  std::string suffix = string_printf ("\n%s\n", filename);
+
+  if (contents->size () <= prefix.size () + suffix.size ()
+      || !startswith (*contents, prefix)
+      || contents->compare (contents->size () - suffix.size (),
+			    suffix.size (), suffix) != 0)
+    {
+      target_file_cache_debug ("%s doesn't match %s", entry_name.c_str (),
+			       filename);
+      return {};
+    }
+
+  std::string build_id_str
+    = contents->substr (prefix.size (),
+			contents->size () - prefix.size () - suffix.size ());
+  if (build_id_str.find_first_not_of ("0123456789abcdef")
+      != std::string::npos)
+    return {};
+
+  return build_id_str;
+}
+
+/* Record that target file FILENAME, whose target status is ST, has
+   build-id BUILD_ID_STR.  The entry is written to a temporary file
+   that is then renamed over the old entry, so that a concurrent
+   lookup sees either entry whole.  */
+
+static void
+write_name_entry (const char *filename, const struct stat &st,
+		  const std::string &build_id_str)
+{
+  std::string contents = name_entry_contents (filename, st, build_id_str);
+  index_wip_file wip (target_file_cache_directory.c_str (),
+		      name_entry_basename (filename).c_str (),
+		      NAME_ENTRY_SUFFIX);
+
+  if (fwrite (contents.data (), 1, contents.size (), wip.out_file.get ())
+      != contents.size ()
+      || fflush (wip.out_file.get ()) != 0)
+    error (_("couldn't write the entry for %s"), filename);
+
+  wip.finalize ();
+}
+
+/* Return a descriptor for the copy of the file with build-id
+   BUILD_ID_STR, or -1 if there is none of the size ST says.  */
+
+static scoped_fd
+open_copy (const std::string &build_id_str, const struct stat &st)
+{
+  std::string copy_name = (target_file_cache_directory + SLASH_STRING
+			   + build_id_str + COPY_SUFFIX);
+
+  scoped_fd fd = gdb_open_cloexec (copy_name, O_RDONLY | O_BINARY, 0);
+  if (fd.get () == -1)
+    return fd;
+
+  struct stat copy_st;
+  if (fstat (fd.get (), &copy_st) != 0 || copy_st.st_size != st.st_size)
+    {
+      target_file_cache_debug ("ignoring %s, whose size differs",
+			       copy_name.c_str ());
+      return scoped_fd (-1);
+    }
+
+  return fd;
+}
+
+/* Copy the file ABFD reads, of status ST, to the copy for build-id
+   BUILD_ID_STR.  Throw an error on failure.  */
+
+static void
+fetch_file (bfd *abfd, const struct stat &st,
+	    const std::string &build_id_str)
+{
+  index_wip_file wip (target_file_cache_directory.c_str (),
+		      build_id_str.c_str (), COPY_SUFFIX);
+  gdb::byte_vector buf (FETCH_CHUNK_SIZE);
+
+  target_file_cache_debug ("fetching %s (%s bytes)", bfd_get_filename (abfd),
+			   pulongest (st.st_size));
+
+  for (off_t offset = 0; offset < st.st_size; )
+    {
+      size_t count = std::min<off_t> (buf.size (), st.st_size - offset);
+
+      if (bfd_seek (abfd, offset, SEEK_SET) != 0
+	  || bfd_read (buf.data (), count, abfd) != count)
+	error (_("couldn't read %s: %s"), bfd_get_filename (abfd),
+	       bfd_errmsg (bfd_get_error ()));
+
+      if (fwrite (buf.data (), 1, count, wip.out_file.get ()) != count)
+	error (_("couldn't write the copy of %s"), bfd_get_filename (abfd));
+
+      offset += count;
+    }
+
+  if (fflush (wip.out_file.get ()) != 0)
+    error (_("couldn't write the copy of %s"), bfd_get_filename (abfd));
+
+  wip.finalize ();
+}
+
+/* See target-file-cache.h.  */
+
+bool
+target_file_cache_enabled_p ()
+{
+  if (!target_file_cache_enabled)
+    return false;
+
+  if (target_file_cache_directory.empty ())
+    {
+      warning (_("The target file cache directory name is empty, "
+		 "skipping cache lookup."));
+      return false;
+    }
+
+  return true;
+}
+
+/* See target-file-cache.h.  */
+
+scoped_fd
+target_file_cache_lookup (const char *filename, const struct stat &st)
+{
+  std::string build_id_str = lookup_name_entry (filename, st);
+  if (build_id_str.empty ())
+    return scoped_fd (-1);
+
+  scoped_fd fd = open_copy (build_id_str, st);
+  if (fd.get () != -1)
+    {
+      target_file_cache_debug ("using the copy of %s", filename);
+      target_file_cache_hits++;
+    }
+
+  return fd;
+}
+
+/* See target-file-cache.h.  */
+
+scoped_fd
+target_file_cache_fetch (bfd *abfd, const struct stat &st)
+{
+  const char *filename = bfd_get_filename (abfd);
+
+  try
+    {
+      /* The file changed or was never fetched under this name.  Its
+	 build-id only takes reading the headers and notes.  */
+      if (!bfd_check_format (abfd, bfd_object))
+	return scoped_fd (-1);
+
+      const bfd_build_id *build_id = build_id_bfd_get (abfd);
+      if (build_id == nullptr)
+	{
+	  target_file_cache_debug ("%s has no build id", filename);
+	  return scoped_fd (-1);
+	}
+      std::string build_id_str = build_id_to_string (build_id);
+
+      if (!mkdir_recursive (target_file_cache_directory.c_str ()))
+	error (_("could not make cache directory: %s"),
+	       safe_strerror (errno));
+
+      scoped_fd fd = open_copy (build_id_str, st);
+      if (fd.get () != -1)
+	{
+	  target_file_cache_debug ("using the copy of %s, by build id %s",
+				   filename, build_id_str.c_str ());
+	  target_file_cache_hits++;
+	}
+      else
+	{
+	  target_file_cache_misses++;
+	  fetch_file (abfd, st, build_id_str);
+	  fd = open_copy (build_id_str, st);
+	  if (fd.get () == -1)
+	    return fd;
+	}
+
+      write_name_entry (filename, st, build_id_str);
+      return fd;
+    }
+  catch (const gdb_exception_error &except)
+    {
+      target_file_cache_debug ("couldn't use the cache for %s: %s",
+			       filename, except.what ());
+    }
+
+  return scoped_fd (-1);
+}
+
+/* True when we are executing "show target-file-cache".  This is used
+   to improve the printout a little bit.  */
+static bool in_show_target_file_cache_command = false;
+
+/* "show target-file-cache" handler.  */
+
+static void
+show_target_file_cache_command (const char *arg, int from_tty)
+{
+  auto restore_flag
+    = make_scoped_restore (&in_show_target_file_cache_command, true);
+
+  /* Call all "show target-file-cache" subcommands.  */
+  cmd_show_list (show_target_file_cache_prefix_list, from_tty);
+
+  gdb_printf ("\n");
+  gdb_printf (_("The target file cache is currently %s.\n"),
+	      target_file_cache_enabled ? _("enabled") : _("disabled"));
+}
+
+/* "set/show target-file-cache enabled" show callback.  */
+
+static void
+show_target_file_cache_enabled_command (ui_file *stream, int from_tty,
+					cmd_list_element *cmd,
+					const char *value)
+{
+  gdb_printf (stream, _("The target file cache is %s.\n"), value);
+}
+
+/* "set target-file-cache directory" handler.  */
+
+static void
+set_target_file_cache_directory_command (const char *arg, int from_tty,
+					 cmd_list_element *element)
+{
+  /* Make sure the cache directory is absolute and tilde-expanded.  */
+  target_file_cache_directory
+    = gdb_abspath (target_file_cache_directory.c_str ());
+}
+
+/* "show target-file-cache stats" handler.  */
+
+static void
+show_target_file_cache_stats_command (const char *arg, int from_tty)
+{
+  const char *indent = "";
+
+  /* If this command is invoked through "show target-file-cache", make
+     the display a bit nicer.  */
+  if (in_show_target_file_cache_command)
+    {
+      indent = "  ";
+      gdb_printf ("\n");
+    }
+
+  gdb_printf (_("%s  Cache hits (this session): %u\n"),
+	      indent, target_file_cache_hits);
+  gdb_printf (_("%sCache misses (this session): %u\n"),
+	      indent, target_file_cache_misses);
+}
+
+void _initialize_target_file_cache ();
+void
+_initialize_target_file_cache ()
+{
+  /* Set the default cache directory.  */
+  std::string cache_dir = get_standard_cache_dir ();
+  if (!cache_dir.empty ())
+    target_file_cache_directory
+      = cache_dir + SLASH_STRING + "target-files";
+
+  /* set target-file-cache */
+  add_basic_prefix_cmd ("target-file-cache", class_files,
+			_("Set target file cache options."),
+			&set_target_file_cache_prefix_list,
+			false, &setlist);
+
+  /* show target-file-cache */
+  add_prefix_cmd ("target-file-cache", class_files,
+		  show_target_file_cache_command,
+		  _("Show target file cache options."),
+		  &show_target_file_cache_prefix_list,
+		  false, &showlist);
+
+  /* set/show target-file-cache enabled */
+  add_setshow_boolean_cmd ("enabled", class_files,
+			   &target_file_cache_enabled,
+			   _("Enable the target file cache."),
+			   _("Show whether the target file cache is enabled."),
+			   _("\
+When on, keep local copies of the files GDB reads from the target's\n\
+filesystem, such as shared libraries with \"set sysroot target:\", and\n\
+use them in later sessions while the target's files are unchanged."),
+			   NULL, show_target_file_cache_enabled_command,
+			   &set_target_file_cache_prefix_list,
+			   &show_target_file_cache_prefix_list);
+
+  /* set/show target-file-cache directory */
+  add_setshow_filename_cmd ("directory", class_files,
+			    &target_file_cache_directory,
+			    _("Set the directory of the target file cache."),
+			    _("Show the directory of the target file cache."),
+			    NULL,
+			    set_target_file_cache_directory_command, NULL,
+			    &set_target_file_cache_prefix_list,
+			    &show_target_file_cache_prefix_list);
+
+  /* show target-file-cache stats */
+  add_cmd ("stats", class_files, show_target_file_cache_stats_command,
+	   _("Show some stats about the target file cache."),
+	   &show_target_file_cache_prefix_list);
+
+  /* set debug target-file-cache */
+  add_setshow_boolean_cmd ("target-file-cache", class_maintenance,
+			   &debug_target_file_cache,
+			   _("Set display of target file cache debug messages."),
+			   _("Show display of target file cache debug messages."),
+			   _("\
+When non-zero, debugging output for the target file cache is displayed."),
+			   NULL, NULL,
+			   &setdebuglist, &showdebuglist);
+}
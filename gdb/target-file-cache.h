@@ -0,0 +1,51 @@
+/* Caching of files read from the target's filesystem.
+
+   Copyright (C) 2024 Free Software Foundation, Inc.
+
+   This file is part of GDB.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#ifndef TARGET_FILE_CACHE_H
+#define TARGET_FILE_CACHE_H
+
+#include "gdbsupport/scoped_fd.h"
+
+/* Return true if the cache is enabled and has a directory.  The
+   functions below must only be called then.  */
+
+extern bool target_file_cache_enabled_p ();
+
+/* Return a descriptor for the local copy of target file FILENAME
+   recorded under that name, if the status of the file on the target,
+   ST, is still the one recorded.  Return -1 otherwise.  This doesn't
+   access the target.  */
+
+extern scoped_fd target_file_cache_lookup (const char *filename,
+					   const struct stat &st);
+
+/* Return a descriptor for a local copy of the target file ABFD was
+   opened on, with target file I/O, whose status on the target is ST.
+   The copy is looked up by the file's build-id, and the file is
+   fetched into the cache first if no copy has it.  The copy is then
+   recorded under the file's name, for target_file_cache_lookup.
+
+   Return -1 if the cache can't hold the file, e.g. because it has no
+   build-id.  ABFD may have been checked for being an object file
+   then.  */
+
+extern scoped_fd target_file_cache_fetch (bfd *abfd,
+					  const struct stat &st);
+
+#endif /* TARGET_FILE_CACHE_H */
@@ -60,6 +60,12 @@ static void generic_tls_error (void) ATTRIBUTE_NORETURN;
 
 static void default_rcmd (struct target_ops *, const char *, struct ui_file *);
 
+static int default_verify_memory_blocks (struct target_ops *self,
+					 const gdb_byte *data,
+					 CORE_ADDR memaddr, ULONGEST size,
+					 ULONGEST block_size,
+					 std::vector<bool> *matches);
+
 static int default_verify_memory (struct target_ops *self,
 				  const gdb_byte *data,
 				  CORE_ADDR memaddr, ULONGEST size);
@@ -1572,8 +1578,8 @@ memory_xfer_partial_1 (struct target_ops *ops, enum target_object object,
       DCACHE *dcache
 	= target_dcache_get_or_init (current_program_space->aspace);
 
-      return dcache_read_memory_partial (ops, dcache, memaddr, readbuf,
-					 reg_len, xfered_len);
+      return dcache_read_memory_partial (ops, dcache, object, memaddr,
+					 readbuf, reg_len, xfered_len);
     }
 
   /* If none of those methods found the memory we wanted, fall back
@@ -1801,6 +1807,67 @@ target_read_raw_memory (CORE_ADDR memaddr, gdb_byte *myaddr, ssize_t len)
     return -1;
 }
 
+/* See target.h.  */
+
+bool
+target_read_raw_memory_batch (gdb::array_view<memory_read_request> requests)
+{
+  for (memory_read_request &req : requests)
+    req.done = false;
+
+  /* Only hand the batch down when nothing above the process and
+     thread strata would want to intercept memory reads (e.g., a
+     record target replaying history), and when nothing in
+     memory_xfer_partial_1 would redirect a read elsewhere.  */
+  target_ops *top = current_inferior ()->top_target ();
+  bool batch_p = (inferior_ptid != null_ptid
+		  && top->stratum () <= thread_stratum
+		  && get_traceframe_number () == -1
+		  && !overlay_debugging
+		  && !trust_readonly);
+
+  if (batch_p)
+    {
+      gdbarch *arch = current_inferior ()->arch ();
+      std::vector<memory_read_request> batch;
+      std::vector<size_t> batch_index;
+
+      for (size_t i = 0; i < requests.size (); ++i)
+	{
+	  const memory_read_request &req = requests[i];
+	  ULONGEST len = req.end - req.begin;
+	  ULONGEST reg_len;
+
+	  /* Leave anything that the region attributes or the address
+	     mask would treat specially to the regular path.  */
+	  if (len == 0
+	      || gdbarch_remove_non_address_bits (arch, req.begin) != req.begin
+	      || !memory_xfer_check_region (req.data, NULL, req.begin, len,
+					    &reg_len, NULL)
+	      || reg_len != len)
+	    continue;
+
+	  batch.push_back (req);
+	  batch_index.push_back (i);
+	}
+
+      if (!batch.empty () && top->read_memory_batch (batch))
+	for (size_t i = 0; i < batch.size (); ++i)
+	  requests[batch_index[i]].done = batch[i].done;
+    }
+
+  bool all_done = true;
+  for (memory_read_request &req : requests)
+    if (!req.done)
+      {
+	req.done = (target_read_raw_memory (req.begin, req.data,
+					    req.end - req.begin) == 0);
+	all_done &= req.done;
+      }
+
+  return all_done;
+}
+
 /* Like target_read_memory, but specify explicitly that this is a read from
    the target's stack.  This may trigger different cache behavior.  */
 
@@ -2390,6 +2457,46 @@ target_remove_breakpoint (struct gdbarch *gdbarch,
   return target->remove_breakpoint (gdbarch, bp_tgt, reason);
 }
 
+/* Whether the software breakpoints may be inserted or removed in
+   batches.  Only do so when the process stratum target would handle
+   them, so that e.g. the record targets see each breakpoint.  */
+
+static bool
+breakpoint_batch_p ()
+{
+  return (may_insert_breakpoints
+	  && current_inferior ()->top_target ()->stratum () <= thread_stratum);
+}
+
+/* See target.h.  */
+
+int
+target_insert_breakpoint_batch (struct gdbarch *gdbarch,
+				gdb::array_view<bp_target_info *> bps)
+{
+  if (!breakpoint_batch_p ())
+    return 0;
+
+  target_ops *target = current_inferior ()->top_target ();
+
+  return target->insert_breakpoint_batch (gdbarch, bps);
+}
+
+/* See target.h.  */
+
+int
+target_remove_breakpoint_batch (struct gdbarch *gdbarch,
+				gdb::array_view<bp_target_info *> bps,
+				enum remove_bp_reason reason)
+{
+  if (!breakpoint_batch_p ())
+    return 0;
+
+  target_ops *target = current_inferior ()->top_target ();
+
+  return target->remove_breakpoint_batch (gdbarch, bps, reason);
+}
+
 static void
 info_target_command (const char *args, int from_tty)
 {
@@ -3942,6 +4049,45 @@ target_verify_memory (const gdb_byte *data, CORE_ADDR memaddr, ULONGEST size)
   return target->verify_memory (data, memaddr, size);
 }
 
+/* Default implementation of block-wise memory verification: verify
+   each block on its own, from the top of the target stack.  */
+
+static int
+default_verify_memory_blocks (struct target_ops *self,
+			      const gdb_byte *data, CORE_ADDR memaddr,
+			      ULONGEST size, ULONGEST block_size,
+			      std::vector<bool> *matches)
+{
+  gdb_assert (block_size > 0);
+
+  matches->clear ();
+  for (ULONGEST offset = 0; offset < size; offset += block_size)
+    {
+      ULONGEST n = std::min (block_size, size - offset);
+      int res = target_verify_memory (data + offset, memaddr + offset, n);
+
+      if (res < 0)
+	return -1;
+      matches->push_back (res == 1);
+    }
+  return 0;
+}
+
+/* See target.h.  */
+
+std::vector<bool>
+target_verify_memory_blocks (const gdb_byte *data, CORE_ADDR memaddr,
+			     ULONGEST size, ULONGEST block_size)
+{
+  target_ops *target = current_inferior ()->top_target ();
+  std::vector<bool> matches;
+
+  if (target->verify_memory_blocks (data, memaddr, size, block_size,
+				    &matches) != 0)
+    matches.clear ();
+  return matches;
+}
+
 /* The documentation for this function is in its prototype declaration in
    target.h.  */
 
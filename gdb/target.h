@@ -300,6 +300,25 @@ struct memory_read_result
 extern std::vector<memory_read_result> read_memory_robust
     (struct target_ops *ops, const ULONGEST offset, const LONGEST len);
 
+/* Describes one range of a batched raw memory read.  See
+   target_read_raw_memory_batch.  */
+
+struct memory_read_request
+{
+  memory_read_request (ULONGEST begin_, ULONGEST end_, gdb_byte *data_)
+    : begin (begin_), end (end_), data (data_)
+  {}
+
+  /* First address to read.  */
+  ULONGEST begin;
+  /* Past-the-end address.  */
+  ULONGEST end;
+  /* Where to store the contents; must hold END - BEGIN bytes.  */
+  gdb_byte *data;
+  /* Set once the whole range has been read into DATA.  */
+  bool done = false;
+};
+
 /* Request that OPS transfer up to LEN addressable units from BUF to the
    target's OBJECT.  When writing to a memory object, the addressable unit
    size is architecture dependent and can be found using
@@ -543,6 +562,19 @@ struct target_ops
 				 enum remove_bp_reason)
       TARGET_DEFAULT_NORETURN (noprocess ());
 
+    /* Insert or remove the software breakpoints in BPS, with as few
+       round trips to the inferior as possible.  Return the number of
+       leading breakpoints of BPS that were inserted or removed; the
+       caller is expected to handle the others one at a time with
+       insert_breakpoint or remove_breakpoint.  */
+    virtual int insert_breakpoint_batch (struct gdbarch *,
+					 gdb::array_view<bp_target_info *>)
+      TARGET_DEFAULT_RETURN (0);
+    virtual int remove_breakpoint_batch (struct gdbarch *,
+					 gdb::array_view<bp_target_info *>,
+					 enum remove_bp_reason)
+      TARGET_DEFAULT_RETURN (0);
+
     /* Returns true if the target stopped because it executed a
        software breakpoint.  This is necessary for correct background
        execution / non-stop mode operation, and for correct PC
@@ -849,6 +881,15 @@ struct target_ops
     virtual ULONGEST get_memory_xfer_limit ()
       TARGET_DEFAULT_RETURN (ULONGEST_MAX);
 
+    /* Read the raw memory of each request in REQUESTS, in as few
+       round trips to the inferior as possible, and set the DONE flag
+       of every request whose range was read in full.  Requests that
+       could not be read are left alone; the caller is expected to
+       retry them through the regular xfer_partial path.  Return false
+       if batched reads are not supported at all.  */
+    virtual bool read_memory_batch (gdb::array_view<memory_read_request> requests)
+      TARGET_DEFAULT_RETURN (false);
+
     /* Returns the memory map for the target.  A return value of NULL
        means that no memory map is available.  If a memory address
        does not fall within any returned regions, it's assumed to be
@@ -1154,6 +1195,17 @@ struct target_ops
 			       CORE_ADDR memaddr, ULONGEST size)
       TARGET_DEFAULT_FUNC (default_verify_memory);
 
+    /* Like verify_memory, but compare the two ranges in blocks of
+       BLOCK_SIZE bytes, the last one possibly shorter, and set
+       element I of *MATCHES to whether block I matches.  Returns 0 on
+       success, and -1 if an error is encountered while reading
+       memory.  */
+    virtual int verify_memory_blocks (const gdb_byte *data,
+				      CORE_ADDR memaddr, ULONGEST size,
+				      ULONGEST block_size,
+				      std::vector<bool> *matches)
+      TARGET_DEFAULT_FUNC (default_verify_memory_blocks);
+
     /* Return the address of the start of the Thread Information Block
        a Windows OS specific feature.  */
     virtual bool get_tib_address (ptid_t ptid, CORE_ADDR *addr)
@@ -1612,6 +1664,14 @@ extern bool target_can_run_breakpoint_commands ();
 extern int target_read_raw_memory (CORE_ADDR memaddr, gdb_byte *myaddr,
 				   ssize_t len);
 
+/* Read the raw memory of several ranges at once, bypassing the dcache
+   and breakpoint shadowing like target_read_raw_memory does.  On
+   return, the DONE flag of each request in REQUESTS tells whether its
+   range was read.  Returns true if every range was read.  */
+
+extern bool target_read_raw_memory_batch
+  (gdb::array_view<memory_read_request> requests);
+
 extern int target_read_stack (CORE_ADDR memaddr, gdb_byte *myaddr, ssize_t len);
 
 extern int target_read_code (CORE_ADDR memaddr, gdb_byte *myaddr, ssize_t len);
@@ -1701,6 +1761,19 @@ extern int target_remove_breakpoint (struct gdbarch *gdbarch,
 				     struct bp_target_info *bp_tgt,
 				     enum remove_bp_reason reason);
 
+/* Insert the software breakpoints in BPS at once, if the target
+   supports it.  Returns the number of leading breakpoints of BPS that
+   were inserted; insert the others with target_insert_breakpoint.  */
+
+extern int target_insert_breakpoint_batch
+  (struct gdbarch *gdbarch, gdb::array_view<bp_target_info *> bps);
+
+/* Likewise, but remove the breakpoints.  */
+
+extern int target_remove_breakpoint_batch
+  (struct gdbarch *gdbarch, gdb::array_view<bp_target_info *>,
+   enum remove_bp_reason reason);
+
 /* Return true if the target stack has a non-default
   "terminal_ours" method.  */
 
@@ -2380,6 +2453,16 @@ extern int simple_verify_memory (struct target_ops* ops,
 int target_verify_memory (const gdb_byte *data,
 			  CORE_ADDR memaddr, ULONGEST size);
 
+/* Compare the memory in the [MEMADDR, MEMADDR+SIZE) range with the
+   contents of [DATA,DATA+SIZE) in blocks of BLOCK_SIZE bytes, the
+   last one possibly shorter, and return whether each block matches.
+   Returns an empty vector if an error is encountered while reading
+   memory.  */
+std::vector<bool> target_verify_memory_blocks (const gdb_byte *data,
+					       CORE_ADDR memaddr,
+					       ULONGEST size,
+					       ULONGEST block_size);
+
 /* Routines for maintenance of the target structures...
 
    add_target:   Add a target to the list of all possible targets.
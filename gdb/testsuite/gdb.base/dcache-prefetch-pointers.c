@@ -0,0 +1,47 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2024 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+/* Each node starts a dcache line of its own, so that following NEXT
+   always leads to another line.  */
+
+struct node
+{
+  struct node *next;
+  int value;
+  char pad[200];
+} __attribute__ ((aligned (64)));
+
+int __attribute__((noinline))
+func (struct node *list)
+{
+  return list->value;
+}
+
+int
+main ()
+{
+  struct node nodes[4];
+  int i;
+
+  for (i = 0; i < 4; i++)
+    {
+      nodes[i].next = i < 3 ? &nodes[i + 1] : 0;
+      nodes[i].value = 10 + i;
+    }
+
+  return func (&nodes[0]) - 10;
+}
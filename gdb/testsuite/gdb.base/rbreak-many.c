@@ -0,0 +1,69 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2024 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+/* Define rbm_func_0 to rbm_func_99, and call them in order.  */
+
+#define FUNC(N)					\
+  int __attribute__ ((noinline))		\
+  rbm_func_ ## N (void)				\
+  {						\
+    return N;					\
+  }
+
+#define FUNCS(T)				\
+  FUNC (T ## 0) FUNC (T ## 1) FUNC (T ## 2)	\
+  FUNC (T ## 3) FUNC (T ## 4) FUNC (T ## 5)	\
+  FUNC (T ## 6) FUNC (T ## 7) FUNC (T ## 8)	\
+  FUNC (T ## 9)
+
+FUNCS ()
+FUNCS (1)
+FUNCS (2)
+FUNCS (3)
+FUNCS (4)
+FUNCS (5)
+FUNCS (6)
+FUNCS (7)
+FUNCS (8)
+FUNCS (9)
+
+#define CALL(N) sum += rbm_func_ ## N ();
+
+#define CALLS(T)				\
+  CALL (T ## 0) CALL (T ## 1) CALL (T ## 2)	\
+  CALL (T ## 3) CALL (T ## 4) CALL (T ## 5)	\
+  CALL (T ## 6) CALL (T ## 7) CALL (T ## 8)	\
+  CALL (T ## 9)
+
+int
+main (void)
+{
+  int sum = 0;
+
+  CALLS ()
+  CALLS (1)
+  CALLS (2)
+  CALLS (3)
+  CALLS (4)
+  CALLS (5)
+  CALLS (6)
+  CALLS (7)
+  CALLS (8)
+  CALLS (9)
+
+  return sum == 4950 ? 0 : 1;
+}
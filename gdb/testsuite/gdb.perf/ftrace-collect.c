@@ -0,0 +1,83 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright (C) 2024 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <pthread.h>
+#include "../gdb.trace/trace-common.h"
+
+#ifndef MAX_THREADS
+#define MAX_THREADS 64
+#endif
+
+/* The number of threads hitting the tracepoint, and the number of
+   times each of them hits it.  Set by GDB.  */
+int thread_count = 1;
+long hits_per_thread = 1000;
+
+/* Memory the tracepoint collects.  */
+unsigned char buffer[64];
+
+static void __attribute__ ((noinline))
+hit (long i)
+{
+  buffer[i & (sizeof (buffer) - 1)]++;
+
+  FAST_TRACEPOINT_LABEL (set_point);
+}
+
+static void *
+thread_function (void *arg)
+{
+  long i;
+
+  for (i = 0; i < hits_per_thread; i++)
+    hit (i);
+
+  return NULL;
+}
+
+void
+begin (void)
+{
+}
+
+void
+end (void)
+{
+}
+
+int
+main (void)
+{
+  while (1)
+    {
+      pthread_t threads[MAX_THREADS];
+      int i;
+
+      begin ();
+
+      if (thread_count > MAX_THREADS)
+	thread_count = MAX_THREADS;
+      for (i = 0; i < thread_count; i++)
+	pthread_create (&threads[i], NULL, thread_function, NULL);
+      for (i = 0; i < thread_count; i++)
+	pthread_join (threads[i], NULL);
+
+      end ();
+    }
+
+  return 0;
+}
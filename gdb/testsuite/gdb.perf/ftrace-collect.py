@@ -0,0 +1,53 @@
+# Copyright (C) 2024 Free Software Foundation, Inc.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+# This test case is to test the speed of the in-process agent when it
+# collects fast tracepoint hits, from one or several threads.
+
+from perftest import perftest
+
+
+class FtraceCollect(perftest.TestCaseWithBasicMeasurements):
+    def __init__(self, thread_count, hit_count):
+        super(FtraceCollect, self).__init__("ftrace-collect")
+        self.thread_count = thread_count
+        self.hit_count = hit_count
+
+    def _set_threads(self, count):
+        gdb.execute("set variable thread_count = %d" % count)
+        gdb.execute("set variable hits_per_thread = %d" % (self.hit_count // count))
+
+    def _run(self):
+        # Run one round of the program, from the "begin" breakpoint to
+        # the "end" one, with the tracepoint collecting.
+        gdb.execute("tstart", False, True)
+        gdb.execute("continue", False, True)
+        gdb.execute("tstop", False, True)
+        gdb.execute("continue", False, True)
+
+    def warm_up(self):
+        gdb.execute("break begin", False, True)
+        gdb.execute("break end", False, True)
+        gdb.execute("continue", False, True)
+        self._set_threads(1)
+        self._run()
+
+    def execute_test(self):
+        count = 1
+        while count <= self.thread_count:
+            self._set_threads(count)
+            func = lambda: self._run()
+            self.measure.measure(func, "threads-%d" % count)
+            count *= 2
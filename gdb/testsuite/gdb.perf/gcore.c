@@ -0,0 +1,51 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright (C) 2024 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <stdlib.h>
+
+#ifndef GCORE_MB
+#define GCORE_MB 256
+#endif
+
+#define PAGE_SIZE 4096
+
+/* A large buffer, most of which is left zero so that the core file
+   can be written sparsely.  */
+char *buffer;
+
+void
+stop_here (void)
+{
+}
+
+int
+main (void)
+{
+  size_t size = (size_t) GCORE_MB * 1024 * 1024;
+  size_t i;
+
+  buffer = malloc (size);
+  if (buffer == NULL)
+    return 1;
+
+  /* Dirty one page in eight, and leave the others zero.  */
+  for (i = 0; i < size; i += PAGE_SIZE)
+    buffer[i] = (i / PAGE_SIZE) % 8 == 0 ? (char) i + 1 : 0;
+
+  stop_here ();
+  return 0;
+}
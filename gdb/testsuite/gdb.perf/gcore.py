@@ -0,0 +1,41 @@
+# Copyright (C) 2024 Free Software Foundation, Inc.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+import os
+
+from perftest import perftest
+
+
+class Gcore(perftest.TestCaseWithBasicMeasurements):
+    def __init__(self, corefile, repeat):
+        super(Gcore, self).__init__("gcore")
+        self.corefile = corefile
+        self.repeat = repeat
+
+    def _gcore(self):
+        gdb.execute("gcore %s" % self.corefile, False, True)
+        os.remove(self.corefile)
+
+    def warm_up(self):
+        self._gcore()
+
+    def _run(self, r):
+        for _ in range(0, r):
+            self._gcore()
+
+    def execute_test(self):
+        for i in range(1, self.repeat + 1):
+            func = lambda: self._run(i)
+            self.measure.measure(func, i)
@@ -0,0 +1,70 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright (C) 2024 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <pthread.h>
+#include <unistd.h>
+
+static void *
+thread_function (void *arg)
+{
+  while (1)
+    usleep (1000);
+
+  return NULL;
+}
+
+/* Start COUNT more threads.  Called by GDB.  Return the number of
+   threads actually started.  */
+
+int
+start_threads (int count)
+{
+  int i;
+
+  for (i = 0; i < count; i++)
+    {
+      pthread_t thread;
+      pthread_attr_t attr;
+      int ret;
+
+      pthread_attr_init (&attr);
+      pthread_attr_setstacksize (&attr, 64 * 1024);
+      ret = pthread_create (&thread, &attr, thread_function, NULL);
+      pthread_attr_destroy (&attr);
+      if (ret != 0)
+	break;
+    }
+
+  return i;
+}
+
+void
+marker (void)
+{
+}
+
+int
+main (void)
+{
+  while (1)
+    {
+      marker ();
+      usleep (100);
+    }
+
+  return 0;
+}
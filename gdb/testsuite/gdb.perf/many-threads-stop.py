@@ -0,0 +1,50 @@
+# Copyright (C) 2024 Free Software Foundation, Inc.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+# This test case is to test the speed of GDB when it stops and resumes
+# all the threads of a process with many threads, each time a
+# breakpoint is hit.
+
+from perftest import perftest
+
+
+class ManyThreadsStop(perftest.TestCaseWithBasicMeasurements):
+    def __init__(self, thread_count, stop_count):
+        super(ManyThreadsStop, self).__init__("many-threads-stop")
+        self.thread_count = thread_count
+        self.stop_count = stop_count
+        self.threads = 0
+
+    def _grow_to(self, count):
+        started = gdb.parse_and_eval("start_threads (%d)" % (count - self.threads))
+        self.threads += int(started)
+
+    def _run(self):
+        for _ in range(0, self.stop_count):
+            gdb.execute("continue", False, True)
+
+    def warm_up(self):
+        gdb.execute("break marker", False, True)
+        self._run()
+
+    def execute_test(self):
+        count = 1
+        while count <= self.thread_count:
+            self._grow_to(count)
+            # Each "continue" resumes all the threads, and stops all of
+            # them again when the breakpoint in marker is hit.
+            func = lambda: self._run()
+            self.measure.measure(func, self.threads)
+            count *= 4
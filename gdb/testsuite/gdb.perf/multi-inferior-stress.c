@@ -0,0 +1,46 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright (C) 2024 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef BUFFER_KB
+#define BUFFER_KB 256
+#endif
+
+/* Read by GDB at each stop.  */
+char *buffer;
+size_t buffer_size = (size_t) BUFFER_KB * 1024;
+
+void
+tick (void)
+{
+}
+
+int
+main (void)
+{
+  buffer = malloc (buffer_size);
+  if (buffer == NULL)
+    return 1;
+  memset (buffer, 0x5a, buffer_size);
+
+  while (1)
+    tick ();
+
+  return 0;
+}
@@ -0,0 +1,61 @@
+# Copyright (C) 2024 Free Software Foundation, Inc.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+from perftest import perftest
+
+
+class MultiInferiorStress(perftest.TestCaseWithBasicMeasurements):
+    def __init__(self, binfile, remote_exec, inferiors, stops):
+        super(MultiInferiorStress, self).__init__("multi-inferior-stress")
+        self.binfile = binfile
+        self.remote_exec = remote_exec
+        self.inferiors = inferiors
+        self.stops = stops
+
+    def _start_inferior(self):
+        # The first inferior exists already, but is not running.
+        if gdb.selected_inferior().pid != 0:
+            gdb.execute("add-inferior -exec %s" % self.binfile, False, True)
+            num = max(inf.num for inf in gdb.inferiors())
+            gdb.execute("inferior %d" % num, False, True)
+        gdb.execute("set remote exec-file %s" % self.remote_exec, False, True)
+        # Runs until the breakpoint in tick.
+        gdb.execute("run", False, True)
+
+    def _stop(self):
+        gdb.execute("continue", False, True)
+        gdb.execute(
+            "dump binary memory /dev/null buffer buffer + buffer_size", False, True
+        )
+
+    def _run(self):
+        for _ in range(0, self.stops):
+            self._stop()
+
+    def warm_up(self):
+        self._start_inferior()
+        self._stop()
+
+    def execute_test(self):
+        running = 1
+        count = 1
+        while count <= self.inferiors:
+            while running < count:
+                self._start_inferior()
+                running += 1
+            self.measure.measure(self._run, "inferiors-%d" % count)
+            count *= 2
+        nums = " ".join(str(inf.num) for inf in gdb.inferiors())
+        gdb.execute("kill inferiors %s" % nums, False, True)
@@ -0,0 +1,67 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright (C) 2024 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef BUFFER_MB
+#define BUFFER_MB 8
+#endif
+
+/* A buffer filled with text-like data, which compresses about as
+   well as typical program data does.  */
+char *buffer;
+size_t buffer_size = (size_t) BUFFER_MB * 1024 * 1024;
+
+void
+stop_here (void)
+{
+}
+
+int
+main (void)
+{
+  static const char *const words[] = {
+    "alpha", "bravo", "charlie", "delta", "echo", "foxtrot", "golf",
+    "hotel", "india", "juliett", "kilo", "lima", "mike", "november",
+  };
+  unsigned int seed = 1;
+  size_t i = 0;
+
+  buffer = malloc (buffer_size);
+  if (buffer == NULL)
+    return 1;
+
+  while (i < buffer_size)
+    {
+      const char *word;
+      size_t len;
+
+      seed = seed * 1103515245 + 12345;
+      word = words[(seed >> 16) % (sizeof (words) / sizeof (words[0]))];
+      len = strlen (word);
+      if (len > buffer_size - i)
+	len = buffer_size - i;
+      memcpy (buffer + i, word, len);
+      i += len;
+      if (i < buffer_size)
+	buffer[i++] = ' ';
+    }
+
+  stop_here ();
+  return 0;
+}
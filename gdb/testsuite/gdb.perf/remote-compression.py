@@ -0,0 +1,111 @@
+# Copyright (C) 2024 Free Software Foundation, Inc.
+
+# This program is free software; you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation; either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+import socket
+import threading
+import time
+
+from perftest import perftest
+
+
+class SlowLink(object):
+    """A proxy forwarding connections to TARGET, a "HOST:PORT" string,
+    and delaying the data like a link with a bandwidth of KBPS kilobytes
+    per second and a latency of LATENCY_MS milliseconds would."""
+
+    def __init__(self, target, kbps, latency_ms):
+        host, port = target.rsplit(":", 1)
+        self.target = (host, int(port))
+        self.bytes_per_second = kbps * 1024.0
+        self.latency = latency_ms / 1000.0
+        self.listener = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        self.listener.bind(("127.0.0.1", 0))
+        self.listener.listen(1)
+        self.port = self.listener.getsockname()[1]
+        threading.Thread(target=self._accept, daemon=True).start()
+
+    def _accept(self):
+        while True:
+            client, _ = self.listener.accept()
+            server = socket.create_connection(self.target)
+            for src, dst in ((client, server), (server, client)):
+                threading.Thread(
+                    target=self._forward, args=(src, dst), daemon=True
+                ).start()
+
+    def _forward(self, src, dst):
+        # When the link is done carrying the data already sent.
+        link_free = time.monotonic()
+        while True:
+            try:
+                data = src.recv(65536)
+            except OSError:
+                data = b""
+            if not data:
+                break
+            now = time.monotonic()
+            link_free = max(link_free, now) + len(data) / self.bytes_per_second
+            delay = link_free + self.latency - now
+            if delay > 0:
+                time.sleep(delay)
+            try:
+                dst.sendall(data)
+            except OSError:
+                break
+        try:
+            dst.shutdown(socket.SHUT_WR)
+        except OSError:
+            pass
+
+
+class RemoteCompression(perftest.TestCaseWithBasicMeasurements):
+    def __init__(self, gdbserver, remote_exec, outfile, kbps, latency_ms, repeat):
+        super(RemoteCompression, self).__init__("remote-compression")
+        self.link = SlowLink(gdbserver, kbps, latency_ms)
+        self.remote_exec = remote_exec
+        self.outfile = outfile
+        self.repeat = repeat
+
+    def _connect(self, compression):
+        gdb.execute("set remote compression-packet %s" % compression)
+        gdb.execute(
+            "target extended-remote 127.0.0.1:%d" % self.link.port, False, True
+        )
+
+    def _transfer(self):
+        # Memory reads, then vFile:pread requests.
+        gdb.execute(
+            "dump binary memory %s buffer buffer + buffer_size" % self.outfile,
+            False,
+            True,
+        )
+        gdb.execute("remote get %s %s" % (self.remote_exec, self.outfile), False, True)
+
+    def _run(self, r):
+        for _ in range(0, r):
+            self._transfer()
+
+    def warm_up(self):
+        self._connect("on")
+        self._transfer()
+        gdb.execute("disconnect", False, True)
+
+    def execute_test(self):
+        for compression in ("off", "on"):
+            self._connect(compression)
+            for i in range(1, self.repeat + 1):
+                func = lambda: self._run(i)
+                self.measure.measure(func, "compression-%s-%d" % (compression, i))
+            gdb.execute("disconnect", False, True)
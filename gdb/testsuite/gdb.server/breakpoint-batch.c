@@ -0,0 +1,58 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2024 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+/* Many functions, for GDB to set many breakpoints in.  */
+
+#define FUNC(N)					\
+  void __attribute__ ((noinline))		\
+  func_ ## N (void)				\
+  {						\
+    counter++;					\
+  }
+
+#define FUNC4(N) FUNC (N ## 0) FUNC (N ## 1) FUNC (N ## 2) FUNC (N ## 3)
+#define FUNC16(N) FUNC4 (N ## 0) FUNC4 (N ## 1) FUNC4 (N ## 2) FUNC4 (N ## 3)
+
+#define CALL(N) func_ ## N ();
+#define CALL4(N) CALL (N ## 0) CALL (N ## 1) CALL (N ## 2) CALL (N ## 3)
+#define CALL16(N) CALL4 (N ## 0) CALL4 (N ## 1) CALL4 (N ## 2) CALL4 (N ## 3)
+
+volatile int counter;
+
+FUNC16 (0)
+FUNC16 (1)
+FUNC16 (2)
+FUNC16 (3)
+
+static void
+all_set (void)
+{
+}
+
+int
+main (void)
+{
+  all_set ();
+
+  CALL16 (0)
+  CALL16 (1)
+  CALL16 (2)
+  CALL16 (3)
+
+  all_set ();
+  return 0;
+}
@@ -0,0 +1,32 @@
+/* This testcase is part of GDB, the GNU debugger.
+
+   Copyright 2024 Free Software Foundation, Inc.
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 3 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program.  If not, see <http://www.gnu.org/licenses/>.  */
+
+#define BUFFER_SIZE (1024 * 1024)
+
+/* Large enough to need many packets to read, and compressible.  */
+unsigned char buffer[BUFFER_SIZE];
+
+int
+main (void)
+{
+  unsigned int i;
+
+  for (i = 0; i < BUFFER_SIZE; i++)
+    buffer[i] = "0123456789abcdef"[(i / 3) % 16] + (i >> 16);
+
+  return 0; /* break here */
+}
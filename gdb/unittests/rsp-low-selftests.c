@@ -57,6 +57,33 @@ static void test_hex2str ()
   SELF_CHECK (hex2str ("") == "");
 }
 
+/* Test that remote_crc32 computes the same checksums as xcrc32.  */
+
+static void test_remote_crc32 ()
+{
+  gdb_byte buf[1031];
+
+  for (size_t i = 0; i < sizeof (buf); i++)
+    buf[i] = (i * 167) ^ (i >> 3);
+
+  SELF_CHECK (remote_crc32 (buf, 0, 0xffffffff) == 0xffffffff);
+
+  /* Cover all the lengths and alignments the eight byte loop may
+     leave a tail for.  */
+  for (size_t start = 0; start < 8; start++)
+    for (size_t len = 0; len < 64; len++)
+      SELF_CHECK (remote_crc32 (buf + start, len, 0xffffffff)
+		  == xcrc32 (buf + start, len, 0xffffffff));
+
+  SELF_CHECK (remote_crc32 (buf, sizeof (buf), 0xffffffff)
+	      == xcrc32 (buf, sizeof (buf), 0xffffffff));
+
+  /* Checksums can be computed piecewise.  */
+  unsigned int crc = remote_crc32 (buf, 13, 0xffffffff);
+  SELF_CHECK (remote_crc32 (buf + 13, sizeof (buf) - 13, crc)
+	      == xcrc32 (buf, sizeof (buf), 0xffffffff));
+}
+
 } /* namespace rsp_low */
 } /* namespace selftests */
 
@@ -68,4 +95,6 @@ _initialize_rsp_low_selftests ()
 			    selftests::rsp_low::test_hex2bin_byte_vector);
   selftests::register_test ("hex2str",
 			    selftests::rsp_low::test_hex2str);
+  selftests::register_test ("remote_crc32",
+			    selftests::rsp_low::test_remote_crc32);
 }
@@ -33,6 +33,9 @@ m4_include(../gdbsupport/ptrace.m4)
 
 m4_include(../gdb/ax_cxx_compile_stdcxx.m4)
 
+dnl For AM_ZLIB.
+m4_include(../config/zlib.m4)
+
 dnl For GDB_AC_SELFTEST.
 m4_include(../gdbsupport/selftest.m4)
 
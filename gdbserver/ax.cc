@@ -804,6 +804,97 @@ compile_bytecodes (struct agent_expr *aexpr)
 
 #endif
 
+/* How much output to collect at most before writing it out.  */
+
+#define AGENT_PRINTF_OUTPUT_MAX 65536
+
+/* Text printed by agent printf bytecodes that was not written out
+   yet.  All the pieces of a printf, and all the printfs run for a
+   breakpoint hit, are collected here so that they go out in a single
+   write, or a single console output packet to GDB.  This is a fixed
+   buffer rather than a std::string so that the in-process agent
+   doesn't allocate from the inferior's heap.  */
+
+static char agent_printf_output[AGENT_PRINTF_OUTPUT_MAX];
+static size_t agent_printf_output_len;
+
+/* See ax.h.  */
+
+void
+flush_agent_printf_output ()
+{
+  if (agent_printf_output_len == 0)
+    return;
+
+#ifndef IN_PROCESS_AGENT
+  /* In all-stop mode, breakpoint commands only run while GDB waits
+     for the stop reply of a resumption, and GDB then prints console
+     output packets as they arrive.  This shows the output of
+     dprintf-style agent in GDB's console without stopping the
+     inferior.  In non-stop mode GDB may be waiting for the reply to
+     any other packet, so print the output ourselves.  */
+  if (!non_stop && gdb_connected ())
+    {
+      const size_t chunk = (PBUFSIZ - 2) / 2;
+
+      for (size_t i = 0; i < agent_printf_output_len; i += chunk)
+	{
+	  std::string piece (agent_printf_output + i,
+			     std::min (chunk, agent_printf_output_len - i));
+
+	  monitor_output (piece.c_str ());
+	}
+    }
+  else
+#endif
+    {
+      fwrite (agent_printf_output, 1, agent_printf_output_len, stdout);
+      fflush (stdout);
+    }
+
+  agent_printf_output_len = 0;
+}
+
+/* Append the result of formatting FORMAT to AGENT_PRINTF_OUTPUT,
+   writing the collected output out first if it doesn't fit.  Output
+   that doesn't fit in an empty buffer either is truncated.  */
+
+static void ATTRIBUTE_PRINTF (1, 2)
+agent_printf_append (const char *format, ...)
+{
+  va_list args;
+  int n;
+
+  for (int attempt = 0; attempt < 2; attempt++)
+    {
+      size_t room = sizeof (agent_printf_output) - agent_printf_output_len;
+
+      va_start (args, format);
+      n = vsnprintf (agent_printf_output + agent_printf_output_len, room,
+		     format, args);
+      va_end (args);
+
+      if (n < 0)
+	return;
+
+      if ((size_t) n < room)
+	{
+	  agent_printf_output_len += n;
+	  return;
+	}
+
+      /* It didn't fit.  Write out what we have, and try again with
+	 the whole buffer.  */
+      if (agent_printf_output_len == 0)
+	break;
+      flush_agent_printf_output ();
+    }
+
+  /* Keep what fits, leaving out the terminating NUL vsnprintf
+     wrote.  */
+  agent_printf_output_len = sizeof (agent_printf_output) - 1;
+}
+
 /* Make printf-type calls using arguments supplied from the host.  We
    need to parse the format string ourselves, and call the formatting
    function with one argument at a time, partly because there is no
@@ -849,7 +940,7 @@ ax_printf (CORE_ADDR fn, CORE_ADDR chan, const char *format,
 	    tem = args[i];
 	    if (tem == 0)
 	      {
-		printf (current_substring, "(null)");
+		agent_printf_append (current_substring, "(null)");
 		break;
 	      }
 
@@ -869,7 +960,7 @@ ax_printf (CORE_ADDR fn, CORE_ADDR chan, const char *format,
 		read_inferior_memory (tem, str, j);
 	      str[j] = 0;
 
-	      printf (current_substring, (char *) str);
+	      agent_printf_append (current_substring, (char *) str);
 	    }
 	    break;
 
@@ -878,7 +969,7 @@ ax_printf (CORE_ADDR fn, CORE_ADDR chan, const char *format,
 	    {
 	      long long val = args[i];
 
-	      printf (current_substring, val);
+	      agent_printf_append (current_substring, val);
 	      break;
 	    }
 #else
@@ -888,7 +979,7 @@ ax_printf (CORE_ADDR fn, CORE_ADDR chan, const char *format,
 	  {
 	    int val = args[i];
 
-	    printf (current_substring, val);
+	    agent_printf_append (current_substring, val);
 	    break;
 	  }
 
@@ -896,7 +987,7 @@ ax_printf (CORE_ADDR fn, CORE_ADDR chan, const char *format,
 	  {
 	    long val = args[i];
 
-	    printf (current_substring, val);
+	    agent_printf_append (current_substring, val);
 	    break;
 	  }
 
@@ -904,7 +995,7 @@ ax_printf (CORE_ADDR fn, CORE_ADDR chan, const char *format,
 	  {
 	    size_t val = args[i];
 
-	    printf (current_substring, val);
+	    agent_printf_append (current_substring, val);
 	    break;
 	  }
 
@@ -917,7 +1008,7 @@ ax_printf (CORE_ADDR fn, CORE_ADDR chan, const char *format,
 	     have modified GCC to include -Wformat-security by
 	     default, which will warn here if there is no
 	     argument.  */
-	  printf (current_substring, 0);
+	  agent_printf_append (current_substring, 0);
 	  break;
 
 	default:
@@ -930,7 +1021,9 @@ ax_printf (CORE_ADDR fn, CORE_ADDR chan, const char *format,
 	++i;
     }
 
-  fflush (stdout);
+#ifdef IN_PROCESS_AGENT
+  flush_agent_printf_output ();
+#endif
 }
 
 /* The agent expression evaluator, as specified by the GDB docs. It
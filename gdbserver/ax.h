@@ -80,6 +80,13 @@ enum eval_result_type
 		       struct agent_expr *aexpr,
 		       ULONGEST *rslt);
 
+/* Write out the output of the printf bytecodes evaluated since the
+   last call.  In all-stop mode, while GDB is connected, the output is
+   sent to GDB as console output; otherwise it goes to standard
+   output.  */
+
+void flush_agent_printf_output ();
+
 /* Bytecode compilation function vector.  */
 
 struct emit_ops
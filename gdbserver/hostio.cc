@@ -407,6 +407,64 @@ handle_pread (char *own_buf, int *new_packet_len)
   free (data);
 }
 
+/* Handle vFile:bulkread:FD,LEN,OFFSET.  The reply is "F<count>",
+   followed by COUNT bytes of the file as is, outside of the packet,
+   which the output code sends with sendfile where possible.  That is
+   only safe in no-ack mode, as there's no way to resend raw data.  */
+
+static void
+handle_bulkread (char *own_buf)
+{
+  client_state &cs = get_client_state ();
+  int fd, len, offset;
+  char *p;
+  struct stat st;
+
+  p = own_buf + strlen ("vFile:bulkread:");
+
+  if (require_int (&p, &fd)
+      || require_comma (&p)
+      || require_valid_fd (fd)
+      || require_int (&p, &len)
+      || require_comma (&p)
+      || require_int (&p, &offset)
+      || require_end (p)
+      || !cs.noack_mode)
+    {
+      hostio_packet_error (own_buf);
+      return;
+    }
+
+  if (fstat (fd, &st) == -1)
+    {
+      hostio_error (own_buf);
+      return;
+    }
+
+  /* The size must be known up front; GDB falls back to vFile:pread
+     for pipes and the like.  */
+  if (!S_ISREG (st.st_mode))
+    {
+      hostio_packet_error (own_buf);
+      return;
+    }
+
+  if (len > HOSTIO_BULK_READ_MAX)
+    len = HOSTIO_BULK_READ_MAX;
+  if (offset >= st.st_size)
+    len = 0;
+  else if (len > st.st_size - offset)
+    len = st.st_size - offset;
+
+  if (len > 0 && !set_reply_trailer_file (fd, offset, len))
+    {
+      hostio_error (own_buf);
+      return;
+    }
+
+  hostio_reply (own_buf, len);
+}
+
 static void
 handle_pwrite (char *own_buf, int packet_len)
 {
@@ -599,6 +657,8 @@ handle_vFile (char *own_buf, int packet_len, int *new_packet_len)
     handle_open (own_buf);
   else if (startswith (own_buf, "vFile:pread:"))
     handle_pread (own_buf, new_packet_len);
+  else if (startswith (own_buf, "vFile:bulkread:"))
+    handle_bulkread (own_buf);
   else if (startswith (own_buf, "vFile:pwrite:"))
     handle_pwrite (own_buf, packet_len);
   else if (startswith (own_buf, "vFile:fstat:"))
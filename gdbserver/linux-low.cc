@@ -5600,6 +5600,23 @@ linux_process_target::low_remove_point (raw_bkpt_type type, CORE_ADDR addr,
   return 1;
 }
 
+/* Software breakpoints are in memory, so we can insert and remove
+   those in the same page with a single access to /proc/PID/mem.  */
+
+int
+linux_process_target::insert_sw_points
+  (gdb::array_view<raw_breakpoint *> bps)
+{
+  return insert_memory_breakpoints (bps);
+}
+
+int
+linux_process_target::remove_sw_points
+  (gdb::array_view<raw_breakpoint *> bps)
+{
+  return remove_memory_breakpoints (bps);
+}
+
 /* Implement the stopped_by_sw_breakpoint target_ops
    method.  */
 
@@ -187,6 +187,10 @@ class linux_process_target : public process_stratum_target
   int remove_point (enum raw_bkpt_type type, CORE_ADDR addr,
 		    int size, raw_breakpoint *bp) override;
 
+  int insert_sw_points (gdb::array_view<raw_breakpoint *> bps) override;
+
+  int remove_sw_points (gdb::array_view<raw_breakpoint *> bps) override;
+
   bool stopped_by_sw_breakpoint () override;
 
   bool supports_stopped_by_sw_breakpoint () override;
@@ -20,9 +20,19 @@
 
 #include "regcache.h"
 #include "ax.h"
+#include "gdbsupport/byte-vector.h"
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
 
 #define MAX_BREAKPOINT_LEN 8
 
+/* insert_memory_breakpoints and remove_memory_breakpoints read and
+   write the memory of the breakpoints that fall in the same block of
+   this many bytes at once.  Programs have their code in pages at
+   least this large.  */
+#define BREAKPOINT_BATCH_BLOCK_SIZE 4096
+
 /* Helper macro used in loops that append multiple items to a singly-linked
    list instead of inserting items at the head of the list, as, say, in the
    breakpoint lists.  LISTPP is a pointer to the pointer that is the head of
@@ -412,6 +422,156 @@ remove_memory_breakpoint (struct raw_breakpoint *bp)
   return err != 0 ? -1 : 0;
 }
 
+/* Account for a new reference to the raw breakpoint BP of PROC.  */
+
+static void
+ref_raw_breakpoint (struct process_info *proc, struct raw_breakpoint *bp)
+{
+  /* Link the breakpoint in, if this is the first reference.  */
+  if (++bp->refcount == 1)
+    {
+      bp->next = proc->raw_breakpoints;
+      proc->raw_breakpoints = bp;
+    }
+}
+
+/* Return the number of memory breakpoints at the start of BPS, sorted
+   by address, that fall in the same block as the first one, and set
+   *START and *LEN to the memory range holding them.  */
+
+static size_t
+memory_breakpoint_group (gdb::array_view<raw_breakpoint *> bps,
+			 CORE_ADDR *start, int *len)
+{
+  const CORE_ADDR block_mask = ~(CORE_ADDR) (BREAKPOINT_BATCH_BLOCK_SIZE - 1);
+  CORE_ADDR block = bps[0]->pc & block_mask;
+  CORE_ADDR end = bps[0]->pc;
+  size_t count;
+
+  for (count = 0; count < bps.size (); count++)
+    {
+      raw_breakpoint *bp = bps[count];
+
+      if ((bp->pc & block_mask) != block)
+	break;
+      end = std::max (end, bp->pc + bp_size (bp));
+    }
+
+  *start = bps[0]->pc;
+  *len = end - *start;
+  return count;
+}
+
+/* See mem-break.h.  */
+
+int
+insert_memory_breakpoints (gdb::array_view<raw_breakpoint *> bps)
+{
+  gdb::byte_vector buf, shadow;
+  size_t done = 0;
+
+  while (done < bps.size ())
+    {
+      CORE_ADDR start;
+      int len;
+      gdb::array_view<raw_breakpoint *> group = bps.slice (done);
+
+      group = group.slice (0, memory_breakpoint_group (group, &start, &len));
+
+      /* Read what's in memory, and work out what would be there
+	 without the breakpoints and fast tracepoint jumps already
+	 inserted in the range, for the shadows.  Then write the
+	 memory back with the new breakpoint instructions, leaving the
+	 existing ones in place.  */
+      buf.resize (len);
+      int err = the_target->read_memory (start, buf.data (), len);
+      if (err == 0)
+	{
+	  shadow = buf;
+	  check_mem_read (start, shadow.data (), len);
+
+	  for (raw_breakpoint *bp : group)
+	    {
+	      memcpy (bp->old_data, shadow.data () + (bp->pc - start),
+		      bp_size (bp));
+	      memcpy (buf.data () + (bp->pc - start), bp_opcode (bp),
+		      bp_size (bp));
+	    }
+
+	  err = the_target->write_memory (start, buf.data (), len);
+	}
+
+      if (err != 0)
+	{
+	  threads_debug_printf ("Failed to insert breakpoints at 0x%s"
+				" to 0x%s (%s).",
+				paddress (start), paddress (start + len),
+				safe_strerror (err));
+
+	  /* Take out the breakpoints inserted so far.  */
+	  for (raw_breakpoint *bp : bps.slice (0, done))
+	    remove_memory_breakpoint (bp);
+	  return -1;
+	}
+
+      done += group.size ();
+    }
+
+  return 0;
+}
+
+/* See mem-break.h.  */
+
+int
+remove_memory_breakpoints (gdb::array_view<raw_breakpoint *> bps)
+{
+  gdb::byte_vector buf;
+  size_t done = 0;
+
+  while (done < bps.size ())
+    {
+      CORE_ADDR start;
+      int len;
+      gdb::array_view<raw_breakpoint *> group = bps.slice (done);
+
+      group = group.slice (0, memory_breakpoint_group (group, &start, &len));
+
+      /* As in remove_memory_breakpoint, write the range through
+	 target_write_memory, so that the other breakpoints and fast
+	 tracepoint jumps in it stay inserted.  Since the caller has
+	 unlinked BPS or marked them uninserted, read_inferior_memory
+	 shows their instructions, which we replace with their
+	 shadows.  */
+      buf.resize (len);
+      int err = read_inferior_memory (start, buf.data (), len);
+      if (err == 0)
+	{
+	  for (raw_breakpoint *bp : group)
+	    memcpy (buf.data () + (bp->pc - start), bp->old_data,
+		    bp_size (bp));
+
+	  err = target_write_memory (start, buf.data (), len);
+	}
+
+      if (err != 0)
+	{
+	  threads_debug_printf ("Failed to remove breakpoints at 0x%s"
+				" to 0x%s (%s).",
+				paddress (start), paddress (start + len),
+				safe_strerror (err));
+
+	  /* Put back the breakpoints removed so far.  */
+	  for (raw_breakpoint *bp : bps.slice (0, done))
+	    insert_memory_breakpoint (bp);
+	  return -1;
+	}
+
+      done += group.size ();
+    }
+
+  return 0;
+}
+
 /* Set a RAW breakpoint of type TYPE and kind KIND at WHERE.  On
    success, a pointer to the new breakpoint is returned.  On failure,
    returns NULL and writes the error code to *ERR.  */
@@ -468,12 +628,7 @@ set_raw_breakpoint_at (enum raw_bkpt_type type, CORE_ADDR where, int kind,
      now.  */
   bp_holder.release ();
 
-  /* Link the breakpoint in, if this is the first reference.  */
-  if (++bp->refcount == 1)
-    {
-      bp->next = proc->raw_breakpoints;
-      proc->raw_breakpoints = bp;
-    }
+  ref_raw_breakpoint (proc, bp);
   return bp;
 }
 
@@ -776,29 +931,16 @@ reinsert_fast_tracepoint_jumps_at (CORE_ADDR where)
     }
 }
 
-/* Set a high-level breakpoint of type TYPE, with low level type
-   RAW_TYPE and kind KIND, at WHERE.  On success, a pointer to the new
-   breakpoint is returned.  On failure, returns NULL and writes the
-   error code to *ERR.  HANDLER is called when the breakpoint is hit.
-   HANDLER should return 1 if the breakpoint should be deleted, 0
-   otherwise.  */
+/* Create a breakpoint of type TYPE for the raw breakpoint RAW, which
+   must already account for the new reference, and link it in.
+   HANDLER is as for set_breakpoint.  */
 
 static struct breakpoint *
-set_breakpoint (enum bkpt_type type, enum raw_bkpt_type raw_type,
-		CORE_ADDR where, int kind,
-		int (*handler) (CORE_ADDR), int *err)
+add_breakpoint (enum bkpt_type type, struct raw_breakpoint *raw,
+		int (*handler) (CORE_ADDR))
 {
   struct process_info *proc = current_process ();
   struct breakpoint *bp;
-  struct raw_breakpoint *raw;
-
-  raw = set_raw_breakpoint_at (raw_type, where, kind, err);
-
-  if (raw == NULL)
-    {
-      /* warn? */
-      return NULL;
-    }
 
   if (is_gdb_breakpoint (type))
     {
@@ -833,6 +975,31 @@ set_breakpoint (enum bkpt_type type, enum raw_bkpt_type raw_type,
   return bp;
 }
 
+/* Set a high-level breakpoint of type TYPE, with low level type
+   RAW_TYPE and kind KIND, at WHERE.  On success, a pointer to the new
+   breakpoint is returned.  On failure, returns NULL and writes the
+   error code to *ERR.  HANDLER is called when the breakpoint is hit.
+   HANDLER should return 1 if the breakpoint should be deleted, 0
+   otherwise.  */
+
+static struct breakpoint *
+set_breakpoint (enum bkpt_type type, enum raw_bkpt_type raw_type,
+		CORE_ADDR where, int kind,
+		int (*handler) (CORE_ADDR), int *err)
+{
+  struct raw_breakpoint *raw;
+
+  raw = set_raw_breakpoint_at (raw_type, where, kind, err);
+
+  if (raw == NULL)
+    {
+      /* warn? */
+      return NULL;
+    }
+
+  return add_breakpoint (type, raw, handler);
+}
+
 /* Set breakpoint of TYPE on address WHERE with handler HANDLER.  */
 
 static struct breakpoint *
@@ -1114,6 +1281,266 @@ delete_gdb_breakpoint (char z_type, CORE_ADDR addr, int kind)
   return 0;
 }
 
+/* Insert the raw software breakpoints BPS, sorted by address, with
+   the target's insert_sw_points method, or one at a time if it
+   doesn't support it.  Returns 0 on success, and -1 on failure, in
+   which case none of them is inserted.  */
+
+static int
+insert_raw_sw_breakpoints (gdb::array_view<raw_breakpoint *> bps)
+{
+  if (bps.empty ())
+    return 0;
+
+  int err = the_target->insert_sw_points (bps);
+  if (err != 1)
+    return err == 0 ? 0 : -1;
+
+  for (size_t i = 0; i < bps.size (); i++)
+    {
+      raw_breakpoint *bp = bps[i];
+
+      if (the_target->insert_point (bp->raw_type, bp->pc, bp->kind, bp) != 0)
+	{
+	  for (raw_breakpoint *done : bps.slice (0, i))
+	    the_target->remove_point (done->raw_type, done->pc, done->kind,
+				      done);
+	  return -1;
+	}
+    }
+
+  return 0;
+}
+
+/* Remove the raw software breakpoints BPS, sorted by address and
+   marked uninserted, like insert_raw_sw_breakpoints.  Returns 0 on
+   success, and -1 on failure, in which case they are all left in
+   memory.  */
+
+static int
+remove_raw_sw_breakpoints (gdb::array_view<raw_breakpoint *> bps)
+{
+  if (bps.empty ())
+    return 0;
+
+  int err = the_target->remove_sw_points (bps);
+  if (err != 1)
+    return err == 0 ? 0 : -1;
+
+  for (size_t i = 0; i < bps.size (); i++)
+    {
+      raw_breakpoint *bp = bps[i];
+
+      if (the_target->remove_point (bp->raw_type, bp->pc, bp->kind, bp) != 0)
+	{
+	  for (raw_breakpoint *done : bps.slice (0, i))
+	    the_target->insert_point (done->raw_type, done->pc, done->kind,
+				      done);
+	  return -1;
+	}
+    }
+
+  return 0;
+}
+
+/* Sort the raw breakpoints BPS by address.  */
+
+static void
+sort_raw_breakpoints (std::vector<raw_breakpoint *> &bps)
+{
+  std::sort (bps.begin (), bps.end (),
+	     [] (const raw_breakpoint *a, const raw_breakpoint *b)
+	     {
+	       return a->pc < b->pc;
+	     });
+}
+
+/* See mem-break.h.  */
+
+int
+set_gdb_breakpoints (gdb::array_view<const gdb_breakpoint_location> locs)
+{
+  struct process_info *proc = current_process ();
+
+  if (!z_type_supported (Z_PACKET_SW_BP))
+    return 1;
+
+  if (proc == nullptr)
+    return -1;
+
+  /* GDB may be inserting again some of the breakpoints it has, e.g.
+     after a shared library unload.  Leave those to set_gdb_breakpoint,
+     which knows how to check they are still there.  */
+  std::unordered_set<CORE_ADDR> known;
+  for (breakpoint *bp = proc->breakpoints; bp != NULL; bp = bp->next)
+    if (bp->type == gdb_breakpoint_Z0)
+      known.insert (bp->raw->pc);
+
+  std::vector<gdb_breakpoint_location> fresh;
+  std::unordered_set<CORE_ADDR> seen;
+  for (const gdb_breakpoint_location &loc : locs)
+    {
+      /* A GDB breakpoint only holds one reference to its raw
+	 breakpoint, however many times it is inserted.  */
+      if (!seen.insert (loc.addr).second)
+	continue;
+
+      if (known.count (loc.addr) == 0)
+	{
+	  fresh.push_back (loc);
+	  continue;
+	}
+
+      int err;
+      gdb_breakpoint *bp = set_gdb_breakpoint (Z_PACKET_SW_BP, loc.addr,
+					       loc.kind, &err);
+      if (bp == nullptr)
+	return -1;
+      clear_breakpoint_conditions_and_commands (bp);
+    }
+
+  /* Then do what set_raw_breakpoint_at does for each of the new
+     breakpoints, looking up the raw breakpoints we have in a table
+     rather than walking the list for each.  */
+  std::unordered_map<CORE_ADDR, raw_breakpoint *> raws;
+  for (raw_breakpoint *raw = proc->raw_breakpoints;
+       raw != NULL;
+       raw = raw->next)
+    if (raw->raw_type == raw_bkpt_type_sw && raw->inserted >= 0)
+      raws.emplace (raw->pc, raw);
+
+  std::vector<gdb::unique_xmalloc_ptr<raw_breakpoint>> created;
+  std::vector<raw_breakpoint *> fresh_raws, to_insert;
+  for (const gdb_breakpoint_location &loc : fresh)
+    {
+      auto it = raws.find (loc.addr);
+      raw_breakpoint *raw = it != raws.end () ? it->second : nullptr;
+
+      if (raw != nullptr && raw->kind != loc.kind)
+	{
+	  /* A different kind than previously seen.  The previous
+	     breakpoint must be gone then.  */
+	  threads_debug_printf
+	    ("Inconsistent breakpoint kind?  Was %d, now %d.",
+	     raw->kind, loc.kind);
+	  raw->inserted = -1;
+	  raw = nullptr;
+	}
+
+      if (raw == nullptr)
+	{
+	  raw = XCNEW (struct raw_breakpoint);
+	  created.emplace_back (raw);
+	  raw->pc = loc.addr;
+	  raw->kind = loc.kind;
+	  raw->raw_type = raw_bkpt_type_sw;
+	}
+
+      if (!raw->inserted)
+	to_insert.push_back (raw);
+      fresh_raws.push_back (raw);
+    }
+
+  sort_raw_breakpoints (to_insert);
+  if (insert_raw_sw_breakpoints (to_insert) != 0)
+    return -1;
+
+  for (raw_breakpoint *raw : to_insert)
+    raw->inserted = 1;
+
+  for (gdb::unique_xmalloc_ptr<raw_breakpoint> &raw : created)
+    raw.release ();
+
+  for (raw_breakpoint *raw : fresh_raws)
+    {
+      ref_raw_breakpoint (proc, raw);
+      add_breakpoint (gdb_breakpoint_Z0, raw, NULL);
+    }
+
+  return 0;
+}
+
+/* See mem-break.h.  */
+
+int
+delete_gdb_breakpoints (gdb::array_view<const gdb_breakpoint_location> locs)
+{
+  struct process_info *proc = current_process ();
+
+  if (!z_type_supported (Z_PACKET_SW_BP))
+    return 1;
+
+  if (proc == nullptr)
+    return -1;
+
+  std::unordered_map<CORE_ADDR, breakpoint *> gdb_bps;
+  for (breakpoint *bp = proc->breakpoints; bp != NULL; bp = bp->next)
+    if (bp->type == gdb_breakpoint_Z0)
+      gdb_bps.emplace (bp->raw->pc, bp);
+
+  /* Find all the breakpoints before deleting any, so as to delete none
+     if one is missing.  */
+  std::unordered_set<breakpoint *> doomed;
+  std::vector<raw_breakpoint *> to_remove;
+  for (const gdb_breakpoint_location &loc : locs)
+    {
+      auto it = gdb_bps.find (loc.addr);
+
+      if (it == gdb_bps.end ()
+	  || it->second->raw->kind != loc.kind
+	  || !doomed.insert (it->second).second)
+	return -1;
+
+      raw_breakpoint *raw = it->second->raw;
+      if (raw->refcount == 1 && raw->inserted > 0)
+	to_remove.push_back (raw);
+    }
+
+  /* Take the raw breakpoints that lose their last reference out of
+     memory.  */
+  sort_raw_breakpoints (to_remove);
+  for (raw_breakpoint *raw : to_remove)
+    raw->inserted = 0;
+  if (remove_raw_sw_breakpoints (to_remove) != 0)
+    {
+      for (raw_breakpoint *raw : to_remove)
+	raw->inserted = 1;
+      return -1;
+    }
+
+  /* Then out of the lists, walking each list once.  */
+  for (breakpoint **bp_link = &proc->breakpoints; *bp_link != NULL;)
+    {
+      breakpoint *bp = *bp_link;
+
+      if (doomed.count (bp) != 0)
+	{
+	  *bp_link = bp->next;
+	  clear_breakpoint_conditions_and_commands ((gdb_breakpoint *) bp);
+	  bp->raw->refcount--;
+	  free (bp);
+	}
+      else
+	bp_link = &bp->next;
+    }
+
+  for (raw_breakpoint **raw_link = &proc->raw_breakpoints;
+       *raw_link != NULL;)
+    {
+      raw_breakpoint *raw = *raw_link;
+
+      if (raw->refcount == 0)
+	{
+	  *raw_link = raw->next;
+	  free (raw);
+	}
+      else
+	raw_link = &raw->next;
+    }
+
+  return 0;
+}
+
 /* Clear all conditions associated with a breakpoint.  */
 
 static void
@@ -1385,6 +1812,8 @@ run_breakpoint_commands (CORE_ADDR where)
      command has a problem, stop digging the hole deeper.  */
   if (run_breakpoint_commands_z_type (Z_PACKET_SW_BP, where))
     run_breakpoint_commands_z_type (Z_PACKET_HW_BP, where);
+
+  flush_agent_printf_output ();
 }
 
 /* See mem-break.h.  */
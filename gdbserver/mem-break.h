@@ -21,6 +21,7 @@
 #ifndef GDBSERVER_MEM_BREAK_H
 #define GDBSERVER_MEM_BREAK_H
 
+#include "gdbsupport/array-view.h"
 #include "gdbsupport/break-common.h"
 
 /* Breakpoints are opaque.  */
@@ -81,6 +82,31 @@ struct gdb_breakpoint *set_gdb_breakpoint (char z_type, CORE_ADDR addr,
 
 int delete_gdb_breakpoint (char z_type, CORE_ADDR addr, int kind);
 
+/* The address and kind of a GDB software breakpoint, as in a Z0
+   packet.  */
+
+struct gdb_breakpoint_location
+{
+  CORE_ADDR addr;
+  int kind;
+};
+
+/* Create GDB software breakpoints (Z0) at each of LOCS, without
+   conditions or commands.  Returns 0 on success, 1 if software
+   breakpoints are not supported on this target, and -1 on error.  On
+   error, none of the breakpoints that weren't set before were
+   inserted.  */
+
+int set_gdb_breakpoints
+  (gdb::array_view<const gdb_breakpoint_location> locs);
+
+/* Delete the GDB software breakpoints at each of LOCS.  Returns 0 on
+   success, 1 if software breakpoints are not supported on this
+   target, and -1 on error, in which case none of them was deleted.  */
+
+int delete_gdb_breakpoints
+  (gdb::array_view<const gdb_breakpoint_location> locs);
+
 /* Returns TRUE if there's a software or hardware (code) breakpoint at
    ADDR in our tables, inserted, or not.  */
 
@@ -271,6 +297,21 @@ int insert_memory_breakpoint (struct raw_breakpoint *bp);
 
 int remove_memory_breakpoint (struct raw_breakpoint *bp);
 
+/* Insert the memory breakpoints BPS, sorted by address, reading and
+   writing the memory of the breakpoints in the same page at once.
+   Returns 0 on success, and -1 on failure, in which case none of them
+   is inserted.  */
+
+int insert_memory_breakpoints (gdb::array_view<raw_breakpoint *> bps);
+
+/* Remove the previously inserted memory breakpoints BPS, sorted by
+   address, like insert_memory_breakpoints.  The caller must have
+   unlinked the breakpoints or marked them uninserted.  Returns 0 on
+   success, and -1 on failure, in which case they are all left in
+   memory.  */
+
+int remove_memory_breakpoints (gdb::array_view<raw_breakpoint *> bps);
+
 /* Create a new breakpoint list in CHILD_THREAD's process that is a
    copy of breakpoint list in PARENT_THREAD's process.  */
 
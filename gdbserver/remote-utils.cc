@@ -25,9 +25,19 @@
 #include "debug.h"
 #include "dll.h"
 #include "gdbsupport/rsp-low.h"
+#include "gdbsupport/byte-vector.h"
 #include "gdbsupport/netstuff.h"
 #include "gdbsupport/filestuff.h"
 #include "gdbsupport/gdb-sigmask.h"
+#include "gdbsupport/block-signals.h"
+#if CXX_STD_THREAD
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#endif
+#include <zlib.h>
 #include <ctype.h>
 #if HAVE_SYS_IOCTL_H
 #include <sys/ioctl.h>
@@ -62,6 +72,9 @@
 #include <arpa/inet.h>
 #endif
 #include <sys/stat.h>
+#if HAVE_SYS_SENDFILE_H
+#include <sys/sendfile.h>
+#endif
 
 #if USE_WIN32API
 #include <ws2tcpip.h>
@@ -86,6 +99,7 @@ static int readchar_callback = NOT_SCHEDULED;
 static int readchar (void);
 static void reset_readchar (void);
 static void reschedule (void);
+static void drain_output_queue (void);
 
 /* A cache entry for a successfully looked-up symbol.  */
 struct sym_cache
@@ -408,6 +422,8 @@ remote_open (const char *name)
 void
 remote_close (void)
 {
+  drain_output_queue ();
+
   delete_file_handler (remote_desc);
 
   disable_async_io ();
@@ -607,6 +623,502 @@ write_prim (const void *buf, int count)
     return write (remote_desc, buf, count);
 }
 
+/* Shut down the connection to the client, without closing its
+   descriptor, so that pending and later writes to it fail, and the
+   client sees it as closed.  Does nothing for a stdio connection.  */
+
+static void
+shutdown_remote_desc ()
+{
+  if (remote_connection_is_stdio ())
+    return;
+
+#ifdef USE_WIN32API
+  shutdown (remote_desc, SD_BOTH);
+#else
+  shutdown (remote_desc, SHUT_RDWR);
+#endif
+}
+
+/* Write the COUNT bytes in BUF to the client, retrying after short
+   writes.  Returns false on error.  */
+
+static bool
+write_all (const char *buf, size_t count)
+{
+  while (count > 0)
+    {
+      int n = write_prim (buf, count);
+
+      if (n < 0 && errno == EINTR)
+	continue;
+      if (n <= 0)
+	return false;
+
+      buf += n;
+      count -= n;
+    }
+
+  return true;
+}
+
+/* Write COUNT bytes of the file open as FD, starting at OFFSET, to the
+   client, with sendfile where possible.  Returns false on error.
+
+   If the file turns out to be shorter, because it was truncated
+   meanwhile, the client can't be told that fewer than the COUNT bytes
+   it expects follow, so shut down the connection instead of leaving
+   it waiting for them.  */
+
+static bool
+write_file_range (int fd, off_t offset, size_t count)
+{
+#ifdef HAVE_SENDFILE
+  int out_fd = (remote_connection_is_stdio ()
+		? fileno (stdout) : remote_desc);
+
+  while (count > 0)
+    {
+      ssize_t n = sendfile (out_fd, fd, &offset,
+			    std::min (count, (size_t) 0x40000000));
+
+      if (n < 0 && errno == EINTR)
+	continue;
+      if (n == 0)
+	{
+	  shutdown_remote_desc ();
+	  return false;
+	}
+      /* Fall back to reading and writing, e.g., if sendfile can't
+	 write to OUT_FD.  */
+      if (n < 0)
+	break;
+
+      count -= n;
+    }
+#endif
+
+  gdb::byte_vector buf (std::min (count, (size_t) 0x10000));
+
+  while (count > 0)
+    {
+      size_t want = std::min (count, buf.size ());
+      ssize_t n;
+
+#ifdef HAVE_PREAD
+      n = pread (fd, buf.data (), want, offset);
+#else
+      n = lseek (fd, offset, SEEK_SET);
+      if (n != -1)
+	n = read (fd, buf.data (), want);
+#endif
+      if (n < 0 && errno == EINTR)
+	continue;
+      if (n <= 0)
+	{
+	  shutdown_remote_desc ();
+	  return false;
+	}
+
+      if (!write_all ((const char *) buf.data (), n))
+	return false;
+
+      offset += n;
+      count -= n;
+    }
+
+  return true;
+}
+
+/* Something to write to the client: a packet, possibly followed by a
+   range of a file, sent as is.  */
+
+struct output_item
+{
+  output_item () = default;
+
+  output_item (output_item &&other) noexcept
+    : data (std::move (other.data)),
+      fd (other.fd),
+      offset (other.offset),
+      count (other.count)
+  {
+    other.fd = -1;
+  }
+
+  ~output_item ()
+  {
+    if (fd != -1)
+      close (fd);
+  }
+
+  DISABLE_COPY_AND_ASSIGN (output_item);
+
+  std::string data;
+
+  /* When not -1, a descriptor, which the item owns, for the file COUNT
+     bytes of which, from OFFSET, follow DATA.  */
+  int fd = -1;
+  off_t offset = 0;
+  size_t count = 0;
+};
+
+/* Write ITEM to the client.  Returns false on error.  */
+
+static bool
+write_output_item (const output_item &item)
+{
+  if (!write_all (item.data.data (), item.data.size ()))
+    return false;
+
+  return item.fd == -1 || write_file_range (item.fd, item.offset, item.count);
+}
+
+/* The range of a file to send right after the next reply, set by
+   set_reply_trailer_file.  */
+
+static struct
+{
+  int fd = -1;
+  off_t offset = 0;
+  size_t count = 0;
+} reply_trailer;
+
+/* See remote-utils.h.  */
+
+bool
+set_reply_trailer_file (int fd, off_t offset, size_t count)
+{
+  gdb_assert (reply_trailer.fd == -1);
+
+  reply_trailer.fd = dup (fd);
+  if (reply_trailer.fd == -1)
+    return false;
+
+  reply_trailer.offset = offset;
+  reply_trailer.count = count;
+  return true;
+}
+
+/* Move the pending reply trailer, if any, to ITEM.  */
+
+static void
+take_reply_trailer (output_item *item)
+{
+  item->fd = reply_trailer.fd;
+  item->offset = reply_trailer.offset;
+  item->count = reply_trailer.count;
+  reply_trailer.fd = -1;
+}
+
+#if CXX_STD_THREAD
+
+/* The most bytes the output queue holds before putpkt waits for the
+   writer thread to catch up.  */
+#define OUTPUT_QUEUE_MAX_BYTES (4 * 1024 * 1024)
+
+/* How long to wait for the writer thread to write out what is queued
+   before closing the connection.  A client that stopped reading must
+   not make gdbserver hang.  */
+static constexpr std::chrono::seconds output_queue_drain_timeout (10);
+
+/* Once the connection is in no-ack mode, packets are handed over to a
+   dedicated thread which writes them to the client.  Callers that
+   need to know whether their packet made it, like putpkt, wait for it
+   to be written.  The replies to GDB's requests and the stop
+   notifications are not waited for, so the thread running the event
+   loop doesn't block on a slow or congested link: as soon as such a
+   packet is queued it goes back to handling target events, of every
+   process being debugged, while the packet, or the file range that
+   follows a vFile:bulkread reply, is still being transmitted.  */
+
+class output_queue
+{
+public:
+  /* Queue ITEM, starting the writer thread on first use, and set
+     *TICKET to a number identifying it for wait_written.  Returns
+     false if ITEM could not be queued, either because the writer
+     thread could not be started -- the caller should then write ITEM
+     itself -- or because an earlier write failed, as reported by
+     failed.  */
+  bool push (output_item &&item, ULONGEST *ticket);
+
+  /* Wait until the item TICKET identifies has been written, or
+     dropped after a failed write.  Returns whether it was written.  */
+  bool wait_written (ULONGEST ticket);
+
+  /* Wait until everything queued has been written, or discarded after
+     a failed write, for at most TIMEOUT.  Returns false if that took
+     longer.  */
+  bool flush (std::chrono::milliseconds timeout);
+
+  /* Wait until the item being written, if any, is done with.  */
+  void wait_idle ();
+
+  /* Drop the items not being written yet.  */
+  void discard ();
+
+  /* Whether a write failed since the last call to reset.  */
+  bool failed ();
+
+  /* Forget about a failed write, for a new connection.  */
+  void reset ();
+
+private:
+  bool start ();
+  void thread_function ();
+
+  std::mutex m_lock;
+
+  /* Notified when packets are queued.  */
+  std::condition_variable m_queued;
+
+  /* Notified when packets have been written.  */
+  std::condition_variable m_written;
+
+  /* The items waiting to be written.  */
+  std::deque<output_item> m_items;
+
+  /* The size of the packets queued or being written, not counting
+     the files that follow them.  */
+  size_t m_pending = 0;
+
+  /* Whether the writer thread is writing an item.  */
+  bool m_writing = false;
+
+  /* The ticket of the last item queued, and of the last one written
+     or dropped.  Items are numbered from 1 in the order they are
+     queued, and written in that order.  */
+  ULONGEST m_last_queued = 0;
+  ULONGEST m_last_done = 0;
+
+  /* The ticket of the first item that failed to be written, or was
+     dropped, since the last call to reset; zero if none did.  */
+  ULONGEST m_first_failed = 0;
+
+  bool m_started = false;
+  bool m_start_failed = false;
+  bool m_failed = false;
+};
+
+bool
+output_queue::start ()
+{
+  if (m_started)
+    return true;
+  if (m_start_failed)
+    return false;
+
+  try
+    {
+      /* The writer thread must not take the signals the event loop
+	 relies on, SIGIO included, which tells about interrupt
+	 requests from the client.  */
+      gdb::block_signals blocker;
+#if defined SIGIO && defined HAVE_SIGPROCMASK
+      sigset_t mask, old_mask;
+      sigemptyset (&mask);
+      sigaddset (&mask, SIGIO);
+      gdb_sigmask (SIG_BLOCK, &mask, &old_mask);
+#endif
+      std::thread thread (&output_queue::thread_function, this);
+      thread.detach ();
+#if defined SIGIO && defined HAVE_SIGPROCMASK
+      gdb_sigmask (SIG_SETMASK, &old_mask, nullptr);
+#endif
+    }
+  catch (const std::system_error &)
+    {
+      m_start_failed = true;
+      return false;
+    }
+
+  m_started = true;
+  return true;
+}
+
+void
+output_queue::thread_function ()
+{
+  std::unique_lock<std::mutex> guard (m_lock);
+
+  while (true)
+    {
+      m_queued.wait (guard, [this] { return !m_items.empty (); });
+
+      output_item item = std::move (m_items.front ());
+      m_items.pop_front ();
+      m_writing = true;
+
+      guard.unlock ();
+      bool ok = write_output_item (item);
+      guard.lock ();
+
+      m_writing = false;
+      m_pending -= item.data.size ();
+      if (!ok)
+	{
+	  /* The client is gone, there is no point in writing the
+	     rest.  */
+	  m_failed = true;
+	  if (m_first_failed == 0)
+	    m_first_failed = m_last_done + 1;
+	  for (const output_item &i : m_items)
+	    m_pending -= i.data.size ();
+	  m_items.clear ();
+	}
+
+      /* Whatever was queued and isn't in M_ITEMS anymore is this item,
+	 or was dropped meanwhile.  */
+      m_last_done = m_items.empty () ? m_last_queued : m_last_done + 1;
+      m_written.notify_all ();
+    }
+}
+
+bool
+output_queue::push (output_item &&item, ULONGEST *ticket)
+{
+  std::unique_lock<std::mutex> guard (m_lock);
+
+  if (m_failed || !start ())
+    return false;
+
+  /* Bound the memory used by the queue.  */
+  m_written.wait (guard, [this] {
+    return m_failed || m_pending < OUTPUT_QUEUE_MAX_BYTES;
+  });
+  if (m_failed)
+    return false;
+
+  m_pending += item.data.size ();
+  m_items.push_back (std::move (item));
+  *ticket = ++m_last_queued;
+  m_queued.notify_one ();
+  return true;
+}
+
+bool
+output_queue::wait_written (ULONGEST ticket)
+{
+  std::unique_lock<std::mutex> guard (m_lock);
+
+  m_written.wait (guard, [=] { return m_last_done >= ticket; });
+  return m_first_failed == 0 || ticket < m_first_failed;
+}
+
+bool
+output_queue::flush (std::chrono::milliseconds timeout)
+{
+  std::unique_lock<std::mutex> guard (m_lock);
+
+  return m_written.wait_for (guard, timeout, [this] {
+    return m_items.empty () && !m_writing;
+  });
+}
+
+void
+output_queue::wait_idle ()
+{
+  std::unique_lock<std::mutex> guard (m_lock);
+
+  m_written.wait (guard, [this] { return !m_writing; });
+}
+
+void
+output_queue::discard ()
+{
+  std::lock_guard<std::mutex> guard (m_lock);
+
+  if (m_items.empty ())
+    return;
+
+  if (m_first_failed == 0)
+    m_first_failed = m_last_done + (m_writing ? 2 : 1);
+  for (const output_item &i : m_items)
+    m_pending -= i.data.size ();
+  m_items.clear ();
+
+  /* If an item is being written, the writer thread updates
+     M_LAST_DONE once it is done with it.  */
+  if (!m_writing)
+    m_last_done = m_last_queued;
+  m_written.notify_all ();
+}
+
+bool
+output_queue::failed ()
+{
+  std::lock_guard<std::mutex> guard (m_lock);
+
+  return m_failed;
+}
+
+void
+output_queue::reset ()
+{
+  std::lock_guard<std::mutex> guard (m_lock);
+
+  m_failed = false;
+  m_first_failed = 0;
+}
+
+/* The output queue.  It is never destroyed, as the writer thread
+   lives as long as gdbserver does.  */
+
+static output_queue *the_output_queue;
+
+/* Write out what is left in the output queue when gdbserver exits.  */
+
+static void
+flush_output_queue_at_exit ()
+{
+  the_output_queue->flush (output_queue_drain_timeout);
+}
+
+static output_queue &
+get_output_queue ()
+{
+  if (the_output_queue == nullptr)
+    {
+      the_output_queue = new output_queue;
+      atexit (flush_output_queue_at_exit);
+    }
+
+  return *the_output_queue;
+}
+
+#endif /* CXX_STD_THREAD */
+
+/* Wait until the packets sent to the client so far have been written
+   out, so that the connection can be closed.  If the client doesn't
+   take them in time, drop them.  */
+
+static void
+drain_output_queue (void)
+{
+#if CXX_STD_THREAD
+  if (the_output_queue != nullptr)
+    {
+      if (!the_output_queue->flush (output_queue_drain_timeout))
+	{
+	  the_output_queue->discard ();
+
+	  /* Make the write the writer thread is blocked in fail, and
+	     wait for it to give up, so that the descriptor isn't
+	     closed, and maybe reused, under its feet.  There's nothing
+	     to unblock it with when writing to stdout, which isn't
+	     closed.  */
+	  if (!remote_connection_is_stdio ())
+	    {
+	      shutdown_remote_desc ();
+	      the_output_queue->wait_idle ();
+	    }
+	}
+      the_output_queue->reset ();
+    }
+#endif
+}
+
 /* Read COUNT bytes from the client and store in BUF.
    The result is the number of bytes read or -1 if error.
    This may return less than COUNT.  */
@@ -622,10 +1134,15 @@ read_prim (void *buf, int count)
 
 /* Send a packet to the remote machine, with error checking.
    The data of the packet is in BUF, and the length of the
-   packet is in CNT.  Returns >= 0 on success, -1 otherwise.  */
+   packet is in CNT.  Returns >= 0 on success, -1 otherwise.
+
+   In no-ack mode, the packet is written by the writer thread.  If
+   WAIT is false, don't wait for that to be done: the packet then only
+   fails if it can't be queued, and a failure to write it shows up as
+   a lost connection later on.  */
 
 static int
-putpkt_binary_1 (char *buf, int cnt, int is_notif)
+putpkt_binary_1 (char *buf, int cnt, int is_notif, bool wait)
 {
   client_state &cs = get_client_state ();
   int i;
@@ -654,6 +1171,43 @@ putpkt_binary_1 (char *buf, int cnt, int is_notif)
 
   *p = '\0';
 
+  /* The range of a file to send right after the packet, if any.  */
+  output_item item;
+  if (!is_notif)
+    take_reply_trailer (&item);
+
+#if CXX_STD_THREAD
+  if (cs.noack_mode)
+    {
+      output_queue &queue = get_output_queue ();
+
+      item.data.assign (buf2, p - buf2);
+      ULONGEST ticket;
+      if (queue.push (std::move (item), &ticket))
+	{
+	  if (is_notif)
+	    remote_debug_printf ("putpkt (\"%s\"); [notif, queued]", buf2);
+	  else
+	    remote_debug_printf ("putpkt (\"%s\"); [noack mode, queued]",
+				 buf2);
+
+	  free (buf2);
+	  if (wait && !queue.wait_written (ticket))
+	    {
+	      fprintf (stderr, "putpkt(write): connection lost\n");
+	      return -1;
+	    }
+	  return 1;
+	}
+      else if (queue.failed ())
+	{
+	  fprintf (stderr, "putpkt(write): connection lost\n");
+	  free (buf2);
+	  return -1;
+	}
+    }
+#endif
+
   /* Send it over and over until we get a positive ack.  */
 
   do
@@ -695,13 +1249,28 @@ putpkt_binary_1 (char *buf, int cnt, int is_notif)
   while (cc != '+');
 
   free (buf2);
+
+  if (item.fd != -1 && !write_file_range (item.fd, item.offset, item.count))
+    {
+      perror ("putpkt(write)");
+      return -1;
+    }
+
   return 1;			/* Success! */
 }
 
 int
 putpkt_binary (char *buf, int cnt)
 {
-  return putpkt_binary_1 (buf, cnt, 0);
+  return putpkt_binary_1 (buf, cnt, 0, true);
+}
+
+/* See remote-utils.h.  */
+
+void
+putpkt_binary_nowait (char *buf, int cnt)
+{
+  putpkt_binary_1 (buf, cnt, 0, false);
 }
 
 /* Send a packet to the remote machine, with error checking.  The data
@@ -717,7 +1286,42 @@ putpkt (char *buf)
 int
 putpkt_notif (char *buf)
 {
-  return putpkt_binary_1 (buf, strlen (buf), 1);
+  return putpkt_binary_1 (buf, strlen (buf), 1, false);
+}
+
+/* See remote-utils.h.  */
+
+int
+compress_reply (char *buf, int len)
+{
+  if (len < COMPRESS_REPLY_MIN_LEN)
+    return len;
+
+  uLongf deflated_len = compressBound (len);
+  gdb::byte_vector deflated (deflated_len);
+
+  /* Favor speed: the point is to spend less time on the wire, not to
+     make GDB wait for us instead.  */
+  if (compress2 (deflated.data (), &deflated_len, (const Bytef *) buf, len,
+		 Z_BEST_SPEED) != Z_OK)
+    return len;
+
+  char header[3 + 2 * sizeof (int)];
+  int header_len = sprintf (header, "z%x;", len);
+
+  /* Escaping the compressed data must leave it shorter than the
+     original reply, or there's no point.  */
+  gdb::byte_vector escaped (len);
+  int escaped_len;
+  if (remote_escape_output (deflated.data (), deflated_len, 1,
+			    escaped.data (), &escaped_len, len - header_len)
+      != deflated_len
+      || header_len + escaped_len >= len)
+    return len;
+
+  memcpy (buf, header, header_len);
+  memcpy (buf + header_len, escaped.data (), escaped_len);
+  return header_len + escaped_len;
 }
 
 /* Come here when we get an input interrupt from the remote side.  This
@@ -907,6 +1511,27 @@ reschedule (void)
     readchar_callback = create_timer (0, process_remaining, NULL);
 }
 
+/* See remote-utils.h.  */
+
+bool
+remote_packet_buffered (void)
+{
+  if (readchar_bufcnt == 0)
+    return false;
+
+  const unsigned char *start
+    = (const unsigned char *) memchr (readchar_bufp, '$', readchar_bufcnt);
+  if (start == nullptr)
+    return false;
+
+  const unsigned char *end = readchar_bufp + readchar_bufcnt;
+  const unsigned char *hash
+    = (const unsigned char *) memchr (start, '#', end - start);
+
+  /* The checksum follows the '#'.  */
+  return hash != nullptr && end - hash > 2;
+}
+
 /* Read a packet from the remote machine, with error checking,
    and store it in BUF.  Returns length of packet, or negative if error. */
 
@@ -1048,6 +1673,55 @@ outreg (struct regcache *regcache, int regno, char *buf)
   return buf;
 }
 
+/* Write the registers of REGCACHE other than the expedited ones, and
+   the window of stack memory GDB asked for with QStopSnapshot, to the
+   stop reply at BUF.  Return the new end of the stop reply.  */
+
+static char *
+write_stop_snapshot (struct regcache *regcache, char *buf)
+{
+  client_state &cs = get_client_state ();
+  const target_desc *tdesc = regcache->tdesc;
+  int num_regs = tdesc->reg_defs.size ();
+
+  if (cs.stop_snapshot_regno >= num_regs)
+    return buf;
+
+  std::vector<bool> expedited (num_regs);
+  for (const std::string &expedited_reg : tdesc->expedite_regs)
+    expedited[find_regno (tdesc, expedited_reg.c_str ())] = true;
+
+  for (int regno = 0; regno < num_regs; regno++)
+    if (!expedited[regno]
+	&& register_size (tdesc, regno) != 0
+	&& regcache->get_register_status (regno) == REG_VALID)
+      buf = outreg (regcache, regno, buf);
+
+  ULONGEST sp;
+  if (cs.stop_snapshot_len == 0
+      || register_size (tdesc, cs.stop_snapshot_regno) > sizeof (sp)
+      || (regcache_raw_read_unsigned (regcache, cs.stop_snapshot_regno, &sp)
+	  != REG_VALID))
+    return buf;
+
+  /* The window may run past the top of the stack.  Shrink it until
+     it's readable.  */
+  gdb::byte_vector stack (cs.stop_snapshot_len);
+  unsigned int len = cs.stop_snapshot_len;
+  while (len > 0 && read_inferior_memory (sp, stack.data (), len) != 0)
+    len /= 2;
+
+  if (len > 0)
+    {
+      sprintf (buf, "stack:%s,", phex_nz (sp, sizeof (sp)));
+      buf += strlen (buf);
+      buf += 2 * bin2hex (stack.data (), buf, len);
+      *buf++ = ';';
+    }
+
+  return buf;
+}
+
 void
 prepare_resume_reply (char *buf, ptid_t ptid, const target_waitstatus &status)
 {
@@ -1207,6 +1881,11 @@ prepare_resume_reply (char *buf, ptid_t ptid, const target_waitstatus &status)
 	     current_target_desc ()->expedite_regs)
 	  buf = outreg (regcache, find_regno (regcache->tdesc,
 					      expedited_reg.c_str ()), buf);
+
+	/* And the rest of the registers and the top of the stack, if
+	   GDB asked for them.  */
+	if (cs.stop_snapshot_regno != -1)
+	  buf = write_stop_snapshot (regcache, buf);
 	*buf = '\0';
 
 	/* Formerly, if the debugger had not used any thread features
@@ -29,8 +29,30 @@ char *write_ptid (char *buf, ptid_t ptid);
 
 int putpkt (char *buf);
 int putpkt_binary (char *buf, int len);
+
+/* Like putpkt_binary, for callers that don't check whether the packet
+   could be sent.  In no-ack mode, don't wait for the packet to be
+   written out: if that fails, the next packets sent fail too.  */
+void putpkt_binary_nowait (char *buf, int len);
+
 int putpkt_notif (char *buf);
+
+/* Arrange for COUNT bytes of the file open as FD, from OFFSET, to be
+   written to the client right after the next reply, as is rather than
+   in a packet.  FD is duplicated, the caller keeps ownership of it.
+   Returns false if that failed.  */
+bool set_reply_trailer_file (int fd, off_t offset, size_t count);
+
 int getpkt (char *buf);
+
+/* Return true if a whole packet from GDB has already been read into
+   the input buffer, so getpkt can return it without blocking.  */
+bool remote_packet_buffered (void);
+
+/* Try to compress the reply of LEN bytes in BUF, replacing it with
+   "z<LEN>;<escaped compressed data>" if that's shorter.  Return the
+   length of the reply to send, which is LEN if BUF was left alone.  */
+int compress_reply (char *buf, int len);
 void remote_prepare (const char *name);
 void remote_open (const char *name);
 void remote_close (void);
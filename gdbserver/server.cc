@@ -647,6 +647,30 @@ handle_general_set (char *own_buf)
       return;
     }
 
+  if (startswith (own_buf, "QStopSnapshot:"))
+    {
+      const char *p = own_buf + strlen ("QStopSnapshot:");
+      ULONGEST regno, len;
+
+      p = unpack_varlen_hex (p, &regno);
+      if (*p != ',' || regno > INT_MAX)
+	{
+	  write_enn (own_buf);
+	  return;
+	}
+      p = unpack_varlen_hex (p + 1, &len);
+      if (*p != '\0' || len > STOP_SNAPSHOT_MAX_LEN)
+	{
+	  write_enn (own_buf);
+	  return;
+	}
+
+      cs.stop_snapshot_regno = regno;
+      cs.stop_snapshot_len = len;
+      write_ok (own_buf);
+      return;
+    }
+
   if (startswith (own_buf, "QProgramSignals:"))
     {
       int numsigs = (int) GDB_SIGNAL_LAST, i;
@@ -2432,28 +2456,157 @@ handle_qxfer (char *own_buf, int packet_len, int *new_packet_len_p)
   return 0;
 }
 
-/* Compute 32 bit CRC from inferior memory.
+/* Compute 32 bit CRC from inferior memory, reading it in blocks of up
+   to CRC_READ_BLOCK_SIZE bytes.
 
    On success, return 32 bit CRC.
    On failure, return (unsigned long long) -1.  */
 
 static unsigned long long
-crc32 (CORE_ADDR base, int len, unsigned int crc)
+crc32 (CORE_ADDR base, ULONGEST len, unsigned int crc)
 {
-  while (len--)
+  static gdb::byte_vector block (CRC_READ_BLOCK_SIZE);
+
+  while (len > 0)
     {
-      unsigned char byte = 0;
+      ULONGEST n = std::min<ULONGEST> (len, block.size ());
 
       /* Return failure if memory read fails.  */
-      if (read_inferior_memory (base, &byte, 1) != 0)
+      if (read_inferior_memory (base, block.data (), n) != 0)
 	return (unsigned long long) -1;
 
-      crc = xcrc32 (&byte, 1, crc);
-      base++;
+      crc = remote_crc32 (block.data (), n, crc);
+      base += n;
+      len -= n;
     }
   return (unsigned long long) crc;
 }
 
+/* Handle a qCRCBlocks:ADDR,LEN,BLOCK_SIZE request in OWN_BUF: reply
+   with the CRC of each BLOCK_SIZE bytes of the LEN bytes at ADDR, the
+   last block possibly shorter, separated by commas.  */
+
+static void
+handle_qcrc_blocks (char *own_buf)
+{
+  ULONGEST base, len, block_size;
+  const char *p;
+
+  p = unpack_varlen_hex (own_buf + strlen ("qCRCBlocks:"), &base);
+  if (*p++ != ',')
+    {
+      write_enn (own_buf);
+      return;
+    }
+  p = unpack_varlen_hex (p, &len);
+  if (*p++ != ',')
+    {
+      write_enn (own_buf);
+      return;
+    }
+  p = unpack_varlen_hex (p, &block_size);
+  if (*p != '\0' || block_size == 0 || len == 0)
+    {
+      write_enn (own_buf);
+      return;
+    }
+
+  /* Each CRC takes at most eight hex digits and a separator.  */
+  ULONGEST count = (len + block_size - 1) / block_size;
+  if (count > (PBUFSIZ - 2) / 9)
+    {
+      write_enn (own_buf);
+      return;
+    }
+
+  std::string reply = "C";
+  for (ULONGEST i = 0; i < count; i++)
+    {
+      ULONGEST n = std::min (block_size, len - i * block_size);
+      unsigned long long crc = crc32 (base + i * block_size, n, 0xffffffff);
+
+      if (crc == (unsigned long long) -1)
+	{
+	  write_enn (own_buf);
+	  return;
+	}
+      if (i > 0)
+	reply += ',';
+      reply += phex_nz (crc, 4);
+    }
+
+  strcpy (own_buf, reply.c_str ());
+}
+
+/* Handle a qRegisters:THREAD-ID[;THREAD-ID]... request in OWN_BUF:
+   reply with THREAD-ID:REGISTERS entries separated by semicolons,
+   REGISTERS being formatted as in a 'g' reply.  Threads that are
+   unknown or not stopped are left out, as are those that would not
+   fit in the reply; the client falls back to 'g' for them.  */
+
+static void
+handle_qregisters (char *own_buf)
+{
+  client_state &cs = get_client_state ();
+
+  if (cs.current_traceframe >= 0)
+    {
+      write_enn (own_buf);
+      return;
+    }
+
+  const char *p = own_buf + strlen ("qRegisters:");
+  std::vector<thread_info *> threads;
+
+  while (*p != '\0')
+    {
+      ptid_t ptid = read_ptid (p, &p);
+      thread_info *thread = find_thread_ptid (ptid);
+
+      if (thread != nullptr
+	  && (!non_stop || (the_target->supports_thread_stopped ()
+			    && the_target->thread_stopped (thread))))
+	threads.push_back (thread);
+
+      if (*p == ';')
+	p++;
+      else if (*p != '\0')
+	{
+	  write_enn (own_buf);
+	  return;
+	}
+    }
+
+  std::string reply;
+  char ptid_buf[64];
+
+  for (thread_info *thread : threads)
+    {
+      regcache *regcache = get_thread_regcache (thread, 1);
+      size_t regs_len = regcache->tdesc->registers_size * 2;
+      char *end = write_ptid (ptid_buf, thread->id);
+
+      /* Leave room for the separators and the terminating NUL.  */
+      if (reply.size () + (end - ptid_buf) + regs_len + 3 > PBUFSIZ)
+	break;
+
+      if (!reply.empty ())
+	reply += ';';
+      reply.append (ptid_buf, end - ptid_buf);
+      reply += ':';
+
+      size_t start = reply.size ();
+      reply.resize (start + regs_len + 1);
+      registers_to_string (regcache, &reply[start]);
+      reply.resize (start + regs_len);
+    }
+
+  if (reply.empty ())
+    write_enn (own_buf);
+  else
+    strcpy (own_buf, reply.c_str ());
+}
+
 /* Parse the qMemTags packet request into ADDR and LEN.  */
 
 static void
@@ -2701,6 +2854,17 @@ handle_query (char *own_buf, int packet_len, int *new_packet_len_p)
 		}
 	      else if (feature == "error-message+")
 		cs.error_message_supported = true;
+	      else if (startswith (feature, "compression="))
+		{
+		  /* GDB lists the compression algorithms it can
+		     uncompress replies with.  */
+		  std::string algos
+		    = "," + feature.substr (strlen ("compression=")) + ",";
+
+		  cs.compress_replies = false;
+		  if (algos.find (",zlib,") != std::string::npos)
+		    cs.compress_replies = true;
+		}
 	      else
 		{
 		  /* Move the unknown features all together.  */
@@ -2717,8 +2881,13 @@ handle_query (char *own_buf, int packet_len, int *new_packet_len_p)
 	       "PacketSize=%x;QPassSignals+;QProgramSignals+;"
 	       "QStartupWithShell+;QEnvironmentHexEncoded+;"
 	       "QEnvironmentReset+;QEnvironmentUnset+;"
-	       "QSetWorkingDir+",
-	       PBUFSIZ - 1);
+	       "QSetWorkingDir+;QStopSnapshot+;qCRCBlocks+;qRegisters+;"
+	       "vFile:bulkread+;vZ0+;"
+	       "PacketPipeline=%x",
+	       PBUFSIZ - 1, PACKET_PIPELINE_DEPTH);
+
+      if (cs.compress_replies)
+	strcat (own_buf, ";compression=zlib");
 
       if (target_supports_catch_syscall ())
 	strcat (own_buf, ";QCatchSyscalls+");
@@ -2994,7 +3163,7 @@ handle_query (char *own_buf, int packet_len, int *new_packet_len_p)
       /* CRC check (compare-section).  */
       const char *comma;
       ULONGEST base;
-      int len;
+      ULONGEST len;
       unsigned long long crc;
 
       require_running_or_return (own_buf);
@@ -3004,7 +3173,7 @@ handle_query (char *own_buf, int packet_len, int *new_packet_len_p)
 	  write_enn (own_buf);
 	  return;
 	}
-      len = strtoul (comma, NULL, 16);
+      unpack_varlen_hex (comma, &len);
       crc = crc32 (base, len, 0xffffffff);
       /* Check for memory failure.  */
       if (crc == (unsigned long long) -1)
@@ -3016,6 +3185,20 @@ handle_query (char *own_buf, int packet_len, int *new_packet_len_p)
       return;
     }
 
+  if (startswith (own_buf, "qCRCBlocks:"))
+    {
+      require_running_or_return (own_buf);
+      handle_qcrc_blocks (own_buf);
+      return;
+    }
+
+  if (startswith (own_buf, "qRegisters:"))
+    {
+      require_running_or_return (own_buf);
+      handle_qregisters (own_buf);
+      return;
+    }
+
   if (handle_qxfer (own_buf, packet_len, new_packet_len_p))
     return;
 
@@ -3477,6 +3660,57 @@ handle_v_kill (char *own_buf)
     write_enn (own_buf);
 }
 
+/* Insert or remove several software breakpoints: "vZ0:ADDR,KIND;..."
+   or "vz0:ADDR,KIND;...".  */
+static void
+handle_v_breakpoints (char *own_buf)
+{
+  const bool insert = own_buf[1] == 'Z';
+  std::vector<gdb_breakpoint_location> locs;
+  const char *p = own_buf + strlen ("vZ0:");
+
+  require_running_or_return (own_buf);
+
+  while (*p != '\0')
+    {
+      ULONGEST addr;
+      char *end;
+
+      p = unpack_varlen_hex (p, &addr);
+      if (*p != ',')
+	{
+	  write_enn (own_buf);
+	  return;
+	}
+
+      long kind = strtol (p + 1, &end, 16);
+      if (end == p + 1 || (*end != ';' && *end != '\0'))
+	{
+	  write_enn (own_buf);
+	  return;
+	}
+
+      locs.push_back ({ addr, (int) kind });
+      p = *end == ';' ? end + 1 : end;
+    }
+
+  int res;
+  if (locs.empty ())
+    res = -1;
+  else if (insert)
+    res = set_gdb_breakpoints (locs);
+  else
+    res = delete_gdb_breakpoints (locs);
+
+  if (res == 0)
+    write_ok (own_buf);
+  else if (res == 1)
+    /* Unsupported.  */
+    own_buf[0] = '\0';
+  else
+    write_enn (own_buf);
+}
+
 /* Handle all of the extended 'v' packets.  */
 void
 handle_v_requests (char *own_buf, int packet_len, int *new_packet_len)
@@ -3563,6 +3797,12 @@ handle_v_requests (char *own_buf, int packet_len, int *new_packet_len)
       return;
     }
 
+  if (startswith (own_buf, "vZ0:") || startswith (own_buf, "vz0:"))
+    {
+      handle_v_breakpoints (own_buf);
+      return;
+    }
+
   if (handle_notif_ack (own_buf, packet_len))
     return;
 
@@ -4367,6 +4607,9 @@ captured_main (int argc, char *argv[])
       cs.vCont_supported = 0;
       cs.memory_tagging_feature = false;
       cs.error_message_supported = false;
+      cs.stop_snapshot_regno = -1;
+      cs.stop_snapshot_len = 0;
+      cs.compress_replies = false;
 
       remote_open (port);
 
@@ -4532,6 +4775,18 @@ process_point_options (struct gdb_breakpoint *bp, const char **packet)
    a brisk pace, so we read the rest of the packet with a blocking
    getpkt call.  */
 
+/* Return true if the reply to request BUF, if long, may be sent
+   compressed.  These are the requests that can bring back a packet's
+   worth of data.  */
+
+static bool
+reply_compressible (const char *buf)
+{
+  return (buf[0] == 'm'
+	  || (startswith (buf, "qXfer:") && strstr (buf, ":read:") != nullptr)
+	  || startswith (buf, "vFile:pread:"));
+}
+
 static int
 process_serial_event (void)
 {
@@ -4555,6 +4810,8 @@ process_serial_event (void)
     }
   response_needed = true;
 
+  bool compressible = cs.compress_replies && reply_compressible (cs.own_buf);
+
   char ch = cs.own_buf[0];
   switch (ch)
     {
@@ -4876,10 +5133,16 @@ process_serial_event (void)
       break;
     }
 
-  if (new_packet_len != -1)
-    putpkt_binary (cs.own_buf, new_packet_len);
-  else
-    putpkt (cs.own_buf);
+  if (compressible)
+    {
+      if (new_packet_len == -1)
+	new_packet_len = strlen (cs.own_buf);
+      new_packet_len = compress_reply (cs.own_buf, new_packet_len);
+    }
+
+  if (new_packet_len == -1)
+    new_packet_len = strlen (cs.own_buf);
+  putpkt_binary_nowait (cs.own_buf, new_packet_len);
 
   response_needed = false;
 
@@ -4896,16 +5159,23 @@ handle_serial_event (int err, gdb_client_data client_data)
 {
   threads_debug_printf ("handling possible serial event");
 
-  /* Really handle it.  */
-  if (process_serial_event () < 0)
+  /* GDB may send several packets without waiting for our replies
+     (see PacketPipeline in qSupported).  Handle all those already
+     read, rather than going back to the event loop for each one.  */
+  do
     {
-      keep_processing_events = false;
-      return;
-    }
+      /* Really handle it.  */
+      if (process_serial_event () < 0)
+	{
+	  keep_processing_events = false;
+	  return;
+	}
 
-  /* Be sure to not change the selected thread behind GDB's back.
-     Important in the non-stop mode asynchronous protocol.  */
-  set_desired_thread ();
+      /* Be sure to not change the selected thread behind GDB's back.
+	 Important in the non-stop mode asynchronous protocol.  */
+      set_desired_thread ();
+    }
+  while (remote_packet_buffered ());
 }
 
 /* Push a stop notification on the notification queue.  */
@@ -106,6 +106,25 @@ extern int in_queued_stop_replies (ptid_t ptid);
    as large as the largest register set supported by gdbserver.  */
 #define PBUFSIZ 131104
 
+/* The largest window of stack memory a stop reply can carry.  Together
+   with the registers, this must fit in a packet.  */
+#define STOP_SNAPSHOT_MAX_LEN 0x4000
+
+/* The number of packets GDB may send without waiting for our replies.
+   Packets are read and answered in order, so there's no hard limit;
+   this keeps GDB's requests well within the socket buffers.  */
+#define PACKET_PIPELINE_DEPTH 0x40
+
+/* The most inferior memory qCRC and qCRCBlocks read at once.  */
+#define CRC_READ_BLOCK_SIZE 0x10000
+
+/* Replies shorter than this aren't worth compressing, even when GDB
+   asked for compressed replies.  */
+#define COMPRESS_REPLY_MIN_LEN 0x100
+
+/* The most file data a vFile:bulkread reply carries.  */
+#define HOSTIO_BULK_READ_MAX (16 * 1024 * 1024)
+
 /* Definition for an unknown syscall, used basically in error-cases.  */
 #define UNKNOWN_SYSCALL (-1)
 
@@ -197,6 +216,18 @@ struct client_state
      are not supported with qRcmd and m packets, but are still supported
      everywhere else.  This is for backward compatibility reasons.  */
   bool error_message_supported = false;
+
+  /* The number of the register holding the stack pointer, and the
+     number of bytes of stack above it, that GDB asked stop replies to
+     carry with QStopSnapshot, along with all the registers.  A
+     register number of -1 means stop replies only carry the
+     expedited registers.  */
+  int stop_snapshot_regno = -1;
+  unsigned int stop_snapshot_len = 0;
+
+  /* If true, GDB agreed in qSupported to compressed replies to memory
+     reads, qXfer reads and vFile:pread requests.  */
+  bool compress_replies = false;
 };
 
 client_state &get_client_state ();
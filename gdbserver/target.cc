@@ -373,6 +373,20 @@ process_stratum_target::remove_point (enum raw_bkpt_type type,
   return 1;
 }
 
+int
+process_stratum_target::insert_sw_points
+  (gdb::array_view<raw_breakpoint *> bps)
+{
+  return 1;
+}
+
+int
+process_stratum_target::remove_sw_points
+  (gdb::array_view<raw_breakpoint *> bps)
+{
+  return 1;
+}
+
 bool
 process_stratum_target::stopped_by_sw_breakpoint ()
 {
@@ -195,6 +195,15 @@ class process_stratum_target
   virtual int remove_point (enum raw_bkpt_type type, CORE_ADDR addr,
 			    int size, raw_breakpoint *bp);
 
+  /* Insert and remove the software breakpoints BPS, sorted by address,
+     all at once.  Returns 0 on success, -1 on failure, in which case
+     none of them was inserted or removed, and 1 on unsupported, in
+     which case the caller uses insert_point and remove_point for each
+     of them.  */
+  virtual int insert_sw_points (gdb::array_view<raw_breakpoint *> bps);
+
+  virtual int remove_sw_points (gdb::array_view<raw_breakpoint *> bps);
+
   /* Returns true if the target stopped because it executed a software
      breakpoint instruction, false otherwise.  */
   virtual bool stopped_by_sw_breakpoint ();
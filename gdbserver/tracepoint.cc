@@ -2181,6 +2181,48 @@ set_trace_state_variable_getter (int num, LONGEST (*getter) (void))
   tsv->getter = getter;
 }
 
+#ifdef IN_PROCESS_AGENT
+
+/* The in-process agent builds each traceframe in this staging
+   buffer, and copies it to the trace buffer at once when it is
+   finished.  Each trace_buffer_alloc call goes through the commit
+   protocol with GDBserver described above, all while the thread
+   holds the jump pads' collect lock, so doing one per traceframe
+   instead of one per block shortens the time other threads hitting
+   fast tracepoints wait for the lock.  It also means GDBserver never
+   sees a partly written traceframe if it flushes the buffer during a
+   collection.  Only the thread holding the collect lock uses the
+   buffer, so one is enough.  */
+
+#define TRACEFRAME_STAGING_SIZE 0x4000
+
+static unsigned char traceframe_staging[TRACEFRAME_STAGING_SIZE];
+
+/* If the traceframe being collected outgrew the staging buffer, the
+   copy of it in the trace buffer, which its next blocks are allocated
+   after.  NULL otherwise.  */
+
+static struct traceframe *spilled_traceframe;
+
+/* Copy the traceframe built so far in the staging buffer to the trace
+   buffer.  Return the copy, or NULL if there's no room for it.  */
+
+static struct traceframe *
+commit_staged_traceframe (void)
+{
+  struct traceframe *staged = (struct traceframe *) traceframe_staging;
+  size_t amt = sizeof (struct traceframe) + staged->data_size;
+  struct traceframe *tframe
+    = (struct traceframe *) trace_buffer_alloc (amt);
+
+  if (tframe != NULL)
+    memcpy (tframe, staged, amt);
+
+  return tframe;
+}
+
+#endif
+
 /* Add a raw traceframe for the given tracepoint.  */
 
 static struct traceframe *
@@ -2188,11 +2230,16 @@ add_traceframe (struct tracepoint *tpoint)
 {
   struct traceframe *tframe;
 
+#ifdef IN_PROCESS_AGENT
+  tframe = (struct traceframe *) traceframe_staging;
+  spilled_traceframe = NULL;
+#else
   tframe
     = (struct traceframe *) trace_buffer_alloc (sizeof (struct traceframe));
 
   if (tframe == NULL)
     return NULL;
+#endif
 
   tframe->tpnum = tpoint->number;
   tframe->data_size = 0;
@@ -2211,7 +2258,27 @@ add_traceframe_block (struct traceframe *tframe,
   if (!tframe)
     return NULL;
 
+#ifdef IN_PROCESS_AGENT
+  if (spilled_traceframe == NULL
+      && (sizeof (struct traceframe) + tframe->data_size + amt
+	  <= TRACEFRAME_STAGING_SIZE))
+    block = tframe->data + tframe->data_size;
+  else
+    {
+      /* Continue the traceframe in the trace buffer.  */
+      if (spilled_traceframe == NULL)
+	{
+	  spilled_traceframe = commit_staged_traceframe ();
+	  if (spilled_traceframe == NULL)
+	    return NULL;
+	}
+
+      block = (unsigned char *) trace_buffer_alloc (amt);
+      tframe = spilled_traceframe;
+    }
+#else
   block = (unsigned char *) trace_buffer_alloc (amt);
+#endif
 
   if (!block)
     return NULL;
@@ -2229,6 +2296,16 @@ add_traceframe_block (struct traceframe *tframe,
 static void
 finish_traceframe (struct traceframe *tframe)
 {
+#ifdef IN_PROCESS_AGENT
+  if (spilled_traceframe == NULL
+      && commit_staged_traceframe () == NULL)
+    {
+      if (tracing)
+	trace_buffer_is_full = 1;
+      return;
+    }
+#endif
+
   ++traceframe_write_count;
   ++traceframes_created;
 }
@@ -263,3 +263,57 @@ remote_unescape_input (const gdb_byte *buffer, int len,
   return output_index;
 }
 
+/* The tables remote_crc32 uses.  Table 0 is the usual byte at a time
+   table for the CRC-32 polynomial 0x04c11db7, processing bits most
+   significant first, like xcrc32.  Table K gives the contribution of
+   a byte followed by K zero bytes, which lets remote_crc32 fold eight
+   bytes into the checksum with independent lookups.  */
+
+struct remote_crc32_tables
+{
+  constexpr remote_crc32_tables ()
+  {
+    for (uint32_t i = 0; i < 256; i++)
+      {
+	uint32_t c = i << 24;
+
+	for (int bit = 0; bit < 8; bit++)
+	  c = (c & 0x80000000) ? (c << 1) ^ 0x04c11db7 : c << 1;
+	table[0][i] = c;
+      }
+
+    for (int k = 1; k < 8; k++)
+      for (int i = 0; i < 256; i++)
+	table[k][i] = ((table[k - 1][i] << 8)
+		       ^ table[0][table[k - 1][i] >> 24]);
+  }
+
+  uint32_t table[8][256] {};
+};
+
+static constexpr remote_crc32_tables crc32_tables;
+
+/* See rsp-low.h.  */
+
+unsigned int
+remote_crc32 (const gdb_byte *buf, size_t len, unsigned int crc)
+{
+  const auto &t = crc32_tables.table;
+  uint32_t c = crc;
+
+  while (len >= 8)
+    {
+      c ^= ((uint32_t) buf[0] << 24 | (uint32_t) buf[1] << 16
+	    | (uint32_t) buf[2] << 8 | buf[3]);
+      c = (t[7][c >> 24] ^ t[6][(c >> 16) & 0xff]
+	   ^ t[5][(c >> 8) & 0xff] ^ t[4][c & 0xff]
+	   ^ t[3][buf[4]] ^ t[2][buf[5]] ^ t[1][buf[6]] ^ t[0][buf[7]]);
+      buf += 8;
+      len -= 8;
+    }
+
+  while (len-- > 0)
+    c = (c << 8) ^ t[0][((c >> 24) ^ *buf++) & 0xff];
+
+  return c;
+}
@@ -81,4 +81,11 @@ extern int remote_escape_output (const gdb_byte *buffer, int len_units,
 extern int remote_unescape_input (const gdb_byte *buffer, int len,
 				  gdb_byte *out_buf, int out_maxlen);
 
+/* Update CRC, the CRC-32 checksum used by the qCRC packet, with the
+   LEN bytes in BUF, and return the result.  This computes the same
+   checksum as libiberty's xcrc32, but eight bytes at a time.  */
+
+extern unsigned int remote_crc32 (const gdb_byte *buf, size_t len,
+				  unsigned int crc);
+
 #endif /* COMMON_RSP_LOW_H */